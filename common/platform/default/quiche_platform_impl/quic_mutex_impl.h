@@ -42,9 +42,29 @@ class ABSL_LOCKABLE QUIC_EXPORT_PRIVATE QuicLockImpl {
   void AssertReaderHeld() const ABSL_ASSERT_SHARED_LOCK();
 
  private:
+  friend class QuicCondVarImpl;
+
   absl::Mutex mu_;
 };
 
+// A condition variable to be used with a QuicLockImpl held exclusively.
+class QUIC_EXPORT_PRIVATE QuicCondVarImpl {
+ public:
+  QuicCondVarImpl() = default;
+  QuicCondVarImpl(const QuicCondVarImpl&) = delete;
+  QuicCondVarImpl& operator=(const QuicCondVarImpl&) = delete;
+
+  // Atomically release |lock| and block until signaled, then reacquire |lock|.
+  void Wait(QuicLockImpl* lock) { cv_.Wait(&lock->mu_); }
+
+  void Signal() { cv_.Signal(); }
+
+  void SignalAll() { cv_.SignalAll(); }
+
+ private:
+  absl::CondVar cv_;
+};
+
 // A Notification allows threads to receive notification of a single occurrence
 // of a single event.
 class QUIC_EXPORT_PRIVATE QuicNotificationImpl {
@@ -22,7 +22,7 @@
 #include <type_traits>
 #include <utility>
 
-#include "absl/container/node_hash_map.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
 #include "common/platform/api/quiche_export.h"
 #include "common/platform/api/quiche_logging.h"
@@ -34,7 +34,9 @@ namespace quiche {
 // begin/end/find.
 //
 // We also keep a set<list::iterator> for find.  Since std::list is a
-// doubly-linked list, the iterators should remain stable.
+// doubly-linked list, the iterators should remain stable.  Only list iterators
+// are handed out, so the map does not need pointer stability, and its entries
+// are stored inline rather than allocated one by one.
 
 // QUICHE_NO_EXPORT comments suppress erroneous presubmit failures.
 template <class Key,                      // QUICHE_NO_EXPORT
@@ -44,7 +46,7 @@ template <class Key,                      // QUICHE_NO_EXPORT
 class QuicheLinkedHashMap {               // QUICHE_NO_EXPORT
  private:
   typedef std::list<std::pair<Key, Value>> ListType;
-  typedef absl::node_hash_map<Key, typename ListType::iterator, Hash, Eq>
+  typedef absl::flat_hash_map<Key, typename ListType::iterator, Hash, Eq>
       MapType;
 
  public:
@@ -187,6 +189,9 @@ class QuicheLinkedHashMap {               // QUICHE_NO_EXPORT
   // Derive size_ from map_, as list::size might be O(N).
   size_type size() const { return map_.size(); }
 
+  // Makes room for at least |count| elements without rehashing.
+  void reserve(size_type count) { map_.reserve(count); }
+
   template <typename... Args>
   std::pair<iterator, bool> emplace(Args&&... args) {
     ListType node_donor;
@@ -25,7 +25,10 @@ class QUICHE_EXPORT_PRIVATE DataFrameSource {
 
   // This method is called with a frame header and a payload length to send. The
   // source should send or buffer the entire frame and return true, or return
-  // false without sending or buffering anything.
+  // false without sending or buffering anything. |frame_header| is only valid
+  // for the duration of the call; the payload is not copied by the caller, so
+  // sources can write the header and payload together, for example with
+  // writev().
   virtual bool Send(absl::string_view frame_header, size_t payload_length) = 0;
 
   // If true, the end of this data source indicates the end of the stream.
@@ -1,5 +1,7 @@
 #include "http2/adapter/header_validator.h"
 
+#include <cstring>
+
 #include "absl/strings/escaping.h"
 #include "common/platform/api/quiche_logging.h"
 
@@ -8,50 +10,147 @@ namespace adapter {
 
 namespace {
 
-const absl::string_view kHttp2HeaderNameAllowedChars =
+constexpr absl::string_view kHttp2HeaderNameAllowedChars =
     "!#$%&\'*+-.0123456789"
     "^_`abcdefghijklmnopqrstuvwxyz|~";
 
-const absl::string_view kHttp2HeaderValueAllowedChars =
-    "\t "
-    "!\"#$%&'()*+,-./"
-    "0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`"
-    "abcdefghijklmnopqrstuvwxyz{|}~";
+constexpr absl::string_view kHttp2StatusValueAllowedChars = "0123456789";
+
+// Pseudo-headers recognized by FinishHeaderBlock(), one bit each.
+enum PseudoHeaderBit : uint8_t {
+  kAuthority = 1 << 0,
+  kMethod = 1 << 1,
+  kPath = 1 << 2,
+  kProtocol = 1 << 3,
+  kScheme = 1 << 4,
+  kStatus = 1 << 5,
+};
+
+// Lookup table with one entry per byte value, true for characters allowed in
+// header names.  Upper-case characters are not allowed.
+class HeaderNameCharTable {
+ public:
+  constexpr HeaderNameCharTable() : allowed_{} {
+    for (char c : kHttp2HeaderNameAllowedChars) {
+      allowed_[static_cast<uint8_t>(c)] = true;
+    }
+  }
+
+  constexpr bool operator[](char c) const {
+    return allowed_[static_cast<uint8_t>(c)];
+  }
+
+ private:
+  bool allowed_[256];
+};
+
+constexpr HeaderNameCharTable kHeaderNameChars;
+static_assert(kHeaderNameChars['a'] && kHeaderNameChars['~'],
+              "Lower-case letters and '~' are allowed in header names");
+static_assert(!kHeaderNameChars['A'] && !kHeaderNameChars['\0'],
+              "Upper-case letters and NUL are not allowed in header names");
+
+bool IsValidHeaderName(absl::string_view name) {
+  // Avoid an early exit so that the loop has no data dependent branches.
+  bool valid = true;
+  for (char c : name) {
+    valid &= kHeaderNameChars[c];
+  }
+  return valid;
+}
+
+// Allowed characters in header values are horizontal tab and printable ASCII,
+// that is, 0x20 through 0x7E.  CR, LF, NUL and bytes with the high bit set are
+// not allowed.
+bool IsValidHeaderValueChar(uint8_t c) {
+  return (c >= 0x20 && c <= 0x7E) || c == '\t';
+}
 
-const absl::string_view kHttp2StatusValueAllowedChars = "0123456789";
+// Checks eight bytes at a time, see
+// https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord.  Every
+// intermediate result is computed independently for each byte, without carries
+// crossing byte boundaries.
+bool IsValidHeaderValue(absl::string_view value) {
+  constexpr uint64_t kOnes = 0x0101010101010101ull;
+  constexpr uint64_t kHighBits = 0x80 * kOnes;
+  constexpr uint64_t kLowBits = 0x7F * kOnes;
 
-bool ValidateRequestHeaders(const std::vector<std::string>& pseudo_headers,
-                            absl::string_view method, bool allow_connect) {
+  const char* data = value.data();
+  size_t size = value.size();
+  uint64_t invalid = 0;
+  for (; size >= sizeof(uint64_t);
+       data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    const uint64_t low = word & kLowBits;
+    // High bit set for bytes of 0x80 or more, 0x7F, and less than 0x20.
+    const uint64_t out_of_range =
+        word | (low + 0x01 * kOnes) | ~(low + (0x80 - 0x20) * kOnes);
+    // High bit set for bytes equal to horizontal tab.
+    const uint64_t tab = word ^ ('\t' * kOnes);
+    const uint64_t is_tab = ~(((tab & kLowBits) + kLowBits) | tab);
+    invalid |= out_of_range & ~is_tab;
+  }
+  if ((invalid & kHighBits) != 0) {
+    return false;
+  }
+  for (; size > 0; ++data, --size) {
+    if (!IsValidHeaderValueChar(static_cast<uint8_t>(*data))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the bit corresponding to |key|, which starts with a colon, or zero
+// if |key| is not a recognized pseudo-header.
+uint8_t GetPseudoHeaderBit(absl::string_view key) {
+  switch (key.size()) {
+    case 5:
+      return key == ":path" ? kPath : 0;
+    case 7:
+      if (key == ":method") {
+        return kMethod;
+      }
+      if (key == ":scheme") {
+        return kScheme;
+      }
+      return key == ":status" ? kStatus : 0;
+    case 9:
+      return key == ":protocol" ? kProtocol : 0;
+    case 10:
+      return key == ":authority" ? kAuthority : 0;
+    default:
+      return 0;
+  }
+}
+
+bool ValidateRequestHeaders(uint8_t pseudo_headers, absl::string_view method,
+                            bool allow_connect) {
   if (allow_connect && method == "CONNECT") {
-    static const std::vector<std::string>* kConnectHeaders =
-        new std::vector<std::string>(
-            {":authority", ":method", ":path", ":protocol", ":scheme"});
-    return pseudo_headers == *kConnectHeaders;
+    return pseudo_headers ==
+           (kAuthority | kMethod | kPath | kProtocol | kScheme);
   }
-  static const std::vector<std::string>* kRequiredHeaders =
-      new std::vector<std::string>(
-          {":authority", ":method", ":path", ":scheme"});
-  return pseudo_headers == *kRequiredHeaders;
+  return pseudo_headers == (kAuthority | kMethod | kPath | kScheme);
 }
 
-bool ValidateRequestTrailers(const std::vector<std::string>& pseudo_headers) {
-  return pseudo_headers.empty();
+bool ValidateRequestTrailers(uint8_t pseudo_headers) {
+  return pseudo_headers == 0;
 }
 
-bool ValidateResponseHeaders(const std::vector<std::string>& pseudo_headers) {
-  static const std::vector<std::string>* kRequiredHeaders =
-      new std::vector<std::string>({":status"});
-  return pseudo_headers == *kRequiredHeaders;
+bool ValidateResponseHeaders(uint8_t pseudo_headers) {
+  return pseudo_headers == kStatus;
 }
 
-bool ValidateResponseTrailers(const std::vector<std::string>& pseudo_headers) {
-  return pseudo_headers.empty();
+bool ValidateResponseTrailers(uint8_t pseudo_headers) {
+  return pseudo_headers == 0;
 }
 
 }  // namespace
 
 void HeaderValidator::StartHeaderBlock() {
-  pseudo_headers_.clear();
+  pseudo_headers_ = 0;
+  has_extra_pseudo_headers_ = false;
   status_.clear();
   method_.clear();
 }
@@ -68,20 +167,19 @@ HeaderValidator::HeaderStatus HeaderValidator::ValidateSingleHeader(
     return HEADER_FIELD_INVALID;
   }
   const absl::string_view validated_key = key[0] == ':' ? key.substr(1) : key;
-  if (validated_key.find_first_not_of(kHttp2HeaderNameAllowedChars) !=
-      absl::string_view::npos) {
+  if (!IsValidHeaderName(validated_key)) {
     QUICHE_VLOG(2) << "invalid chars in header name: ["
                    << absl::CEscape(validated_key) << "]";
     return HEADER_FIELD_INVALID;
   }
-  if (value.find_first_not_of(kHttp2HeaderValueAllowedChars) !=
-      absl::string_view::npos) {
+  if (!IsValidHeaderValue(value)) {
     QUICHE_VLOG(2) << "invalid chars in header value: [" << absl::CEscape(value)
                    << "]";
     return HEADER_FIELD_INVALID;
   }
   if (key[0] == ':') {
-    if (key == ":status") {
+    const uint8_t pseudo_header_bit = GetPseudoHeaderBit(key);
+    if (pseudo_header_bit == kStatus) {
       if (value.size() != 3 ||
           value.find_first_not_of(kHttp2StatusValueAllowedChars) !=
               absl::string_view::npos) {
@@ -94,10 +192,14 @@ HeaderValidator::HeaderStatus HeaderValidator::ValidateSingleHeader(
         return HEADER_FIELD_INVALID;
       }
       status_ = std::string(value);
-    } else if (key == ":method") {
+    } else if (pseudo_header_bit == kMethod) {
       method_ = std::string(value);
     }
-    pseudo_headers_.push_back(std::string(key));
+    if (pseudo_header_bit == 0 || (pseudo_headers_ & pseudo_header_bit) != 0) {
+      // Unrecognized and repeated pseudo-headers fail FinishHeaderBlock().
+      has_extra_pseudo_headers_ = true;
+    }
+    pseudo_headers_ |= pseudo_header_bit;
   } else if (key == "content-length" && status_ == "204" && value != "0") {
     // There should be no body in a "204 No Content" response.
     return HEADER_FIELD_INVALID;
@@ -108,7 +210,9 @@ HeaderValidator::HeaderStatus HeaderValidator::ValidateSingleHeader(
 // Returns true if all required pseudoheaders and no extra pseudoheaders are
 // present for the given header type.
 bool HeaderValidator::FinishHeaderBlock(HeaderType type) {
-  std::sort(pseudo_headers_.begin(), pseudo_headers_.end());
+  if (has_extra_pseudo_headers_) {
+    return false;
+  }
   switch (type) {
     case HeaderType::REQUEST:
       return ValidateRequestHeaders(pseudo_headers_, method_, allow_connect_);
@@ -1,8 +1,8 @@
 #ifndef QUICHE_HTTP2_ADAPTER_HEADER_VALIDATOR_H_
 #define QUICHE_HTTP2_ADAPTER_HEADER_VALIDATOR_H_
 
+#include <cstdint>
 #include <string>
-#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -46,7 +46,11 @@ class QUICHE_EXPORT_PRIVATE HeaderValidator {
   absl::string_view status_header() const { return status_; }
 
  private:
-  std::vector<std::string> pseudo_headers_;
+  // One bit for each recognized pseudo-header in the current header block.
+  uint8_t pseudo_headers_ = 0;
+  // True if the current header block has an unrecognized or repeated
+  // pseudo-header.
+  bool has_extra_pseudo_headers_ = false;
   std::string status_;
   std::string method_;
   absl::optional<size_t> max_field_size_;
@@ -76,6 +76,46 @@ TEST(HeaderValidatorTest, ValueHasInvalidChar) {
   }
 }
 
+TEST(HeaderValidatorTest, LongValueHasInvalidChar) {
+  HeaderValidator v;
+  // Long values such as cookies and authorization tokens are valid if all
+  // characters are allowed.
+  std::string value;
+  for (int i = 0; i < 100; ++i) {
+    absl::StrAppend(&value, "k", i, "=Va_lue+/", i, "; ");
+  }
+  EXPECT_EQ(HeaderValidator::HEADER_OK,
+            v.ValidateSingleHeader("cookie", value));
+
+  // A single invalid character anywhere in the value is detected.
+  for (const char c : {'\0', '\r', '\n', '\x7F', '\x80', '\xFF'}) {
+    for (size_t i = 0; i < 70; ++i) {
+      std::string invalid_value(70, 'a');
+      invalid_value[i] = c;
+      EXPECT_EQ(HeaderValidator::HEADER_FIELD_INVALID,
+                v.ValidateSingleHeader("authorization", invalid_value));
+    }
+  }
+}
+
+TEST(HeaderValidatorTest, ValueAllByteValues) {
+  HeaderValidator v;
+  for (int i = 0; i < 256; ++i) {
+    const char c = static_cast<char>(i);
+    const bool allowed = c == '\t' || (i >= 0x20 && i <= 0x7E);
+    // Place the character both where it is checked as part of a larger chunk
+    // and where it is checked individually.
+    for (size_t position : {0, 5, 8, 12}) {
+      std::string value(13, 'a');
+      value[position] = c;
+      EXPECT_EQ(allowed ? HeaderValidator::HEADER_OK
+                        : HeaderValidator::HEADER_FIELD_INVALID,
+                v.ValidateSingleHeader("name", value))
+          << i << " at " << position;
+    }
+  }
+}
+
 TEST(HeaderValidatorTest, StatusHasInvalidChar) {
   HeaderValidator v;
 
@@ -270,6 +310,21 @@ TEST(HeaderValidatorTest, Response204WithContentLength) {
             v.ValidateSingleHeader("content-length", "1"));
 }
 
+TEST(HeaderValidatorTest, RequestTrailerPseudoHeaders) {
+  HeaderValidator v;
+
+  // When no pseudo-headers are present, validation will succeed.
+  v.StartHeaderBlock();
+  EXPECT_EQ(HeaderValidator::HEADER_OK, v.ValidateSingleHeader("foo", "bar"));
+  EXPECT_TRUE(v.FinishHeaderBlock(HeaderType::REQUEST_TRAILER));
+
+  // When an unrecognized pseudo-header is present, validation will fail.
+  v.StartHeaderBlock();
+  EXPECT_EQ(HeaderValidator::HEADER_OK,
+            v.ValidateSingleHeader(":extra", "blah"));
+  EXPECT_FALSE(v.FinishHeaderBlock(HeaderType::REQUEST_TRAILER));
+}
+
 TEST(HeaderValidatorTest, ResponseTrailerPseudoHeaders) {
   HeaderValidator v;
 
@@ -10,6 +10,7 @@
 #include "http2/adapter/http2_util.h"
 #include "http2/adapter/http2_visitor_interface.h"
 #include "http2/adapter/oghttp2_util.h"
+#include "spdy/core/array_output_buffer.h"
 #include "spdy/core/spdy_protocol.h"
 
 namespace http2 {
@@ -748,12 +749,18 @@ OgHttp2Session::SendResult OgHttp2Session::WriteForStream(
       spdy::SpdyDataIR data(stream_id);
       data.set_fin(fin);
       data.SetDataShallow(length);
-      spdy::SpdySerializedFrame header =
-          spdy::SpdyFramer::SerializeDataFrameHeaderWithPaddingLengthField(
-              data);
+      // The frame header is serialized on the stack, and the payload is sent
+      // directly by the DataFrameSource, so DATA frames are neither copied
+      // nor allocated.
+      char header[spdy::kDataFrameMinimumSize];
+      spdy::ArrayOutputBuffer header_buffer(header, sizeof(header));
+      const bool serialized =
+          framer_.SerializeDataFrameHeaderWithPaddingLengthField(
+              data, &header_buffer);
+      QUICHE_DCHECK(serialized);
       QUICHE_DCHECK(buffered_data_.empty() && frames_.empty());
-      const bool success =
-          state.outbound_body->Send(absl::string_view(header), length);
+      const bool success = state.outbound_body->Send(
+          absl::string_view(header, header_buffer.Size()), length);
       if (!success) {
         connection_can_write = SendResult::SEND_BLOCKED;
         break;
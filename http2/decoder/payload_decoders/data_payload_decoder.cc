@@ -69,6 +69,29 @@ DecodeStatus DataPayloadDecoder::StartDecodingPayload(FrameDecoderState* state,
     }
     payload_state_ = PayloadState::kReadPayload;
   } else {
+    // Padded frames that fit fully into the decode buffer, and with a valid
+    // Pad Length field, are also decoded without going through the state
+    // machine below.
+    if (db->Remaining() == total_length && total_length > 0) {
+      const uint32_t pad_length = static_cast<uint8_t>(db->cursor()[0]);
+      if (pad_length < total_length) {
+        HTTP2_DVLOG(2) << "StartDecodingPayload padded, all present";
+        const uint32_t data_length = total_length - 1 - pad_length;
+        db->AdvanceCursor(1);
+        state->listener()->OnDataStart(frame_header);
+        state->listener()->OnPadLength(pad_length);
+        if (data_length > 0) {
+          state->listener()->OnDataPayload(db->cursor(), data_length);
+          db->AdvanceCursor(data_length);
+        }
+        if (pad_length > 0) {
+          state->listener()->OnPadding(db->cursor(), pad_length);
+          db->AdvanceCursor(pad_length);
+        }
+        state->listener()->OnDataEnd();
+        return DecodeStatus::kDecodeDone;
+      }
+    }
     payload_state_ = PayloadState::kReadPadLength;
   }
   state->InitializeRemainders();
@@ -109,6 +109,12 @@ TEST_P(DataPayloadDecoderTest, VariousDataPayloadSizes) {
   }
 }
 
+// Confirm we get an error if the PADDED flag is set but the payload is not
+// long enough to hold even the Pad Length amount of padding.
+TEST_P(DataPayloadDecoderTest, PaddingTooLong) {
+  EXPECT_TRUE(VerifyDetectsPaddingTooLong());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace http2
@@ -11,19 +11,6 @@
 #include "http2/platform/api/http2_macros.h"
 
 namespace http2 {
-namespace {
-
-std::string ExtractString(HpackDecoderStringBuffer* string_buffer) {
-  if (string_buffer->IsBuffered()) {
-    return string_buffer->ReleaseString();
-  } else {
-    auto result = std::string(string_buffer->str());
-    string_buffer->Reset();
-    return result;
-  }
-}
-
-}  // namespace
 
 HpackDecoderState::HpackDecoderState(HpackDecoderListener* listener)
     : listener_(HTTP2_DIE_IF_NULL(listener)),
@@ -110,11 +97,11 @@ void HpackDecoderState::OnNameIndexAndLiteralValue(
   allow_dynamic_table_size_update_ = false;
   const HpackStringPair* entry = decoder_tables_.Lookup(name_index);
   if (entry != nullptr) {
-    std::string value(ExtractString(value_buffer));
-    listener_->OnHeader(entry->name, value);
+    listener_->OnHeader(entry->name, value_buffer->str());
     if (entry_type == HpackEntryType::kIndexedLiteralHeader) {
-      decoder_tables_.Insert(entry->name, std::move(value));
+      decoder_tables_.Insert(entry->name, value_buffer->str());
     }
+    value_buffer->Reset();
   } else {
     ReportError(HpackDecodingError::kInvalidNameIndex, "");
   }
@@ -134,12 +121,12 @@ void HpackDecoderState::OnLiteralNameAndValue(
     return;
   }
   allow_dynamic_table_size_update_ = false;
-  std::string name(ExtractString(name_buffer));
-  std::string value(ExtractString(value_buffer));
-  listener_->OnHeader(name, value);
+  listener_->OnHeader(name_buffer->str(), value_buffer->str());
   if (entry_type == HpackEntryType::kIndexedLiteralHeader) {
-    decoder_tables_.Insert(std::move(name), std::move(value));
+    decoder_tables_.Insert(name_buffer->str(), value_buffer->str());
   }
+  name_buffer->Reset();
+  value_buffer->Reset();
 }
 
 void HpackDecoderState::OnDynamicTableSizeUpdate(size_t size_limit) {
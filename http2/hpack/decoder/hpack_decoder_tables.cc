@@ -4,6 +4,8 @@
 
 #include "http2/hpack/decoder/hpack_decoder_tables.h"
 
+#include <cstring>
+
 #include "absl/strings/str_cat.h"
 #include "http2/hpack/http2_hpack_constants.h"
 #include "http2/platform/api/http2_logging.h"
@@ -35,14 +37,9 @@ const std::vector<HpackStringPair>* GetStaticTable() {
 
 }  // namespace
 
-HpackStringPair::HpackStringPair(std::string name, std::string value)
-    : name(std::move(name)), value(std::move(value)) {
-  HTTP2_DVLOG(3) << DebugString() << " ctor";
-}
-
-HpackStringPair::~HpackStringPair() {
-  HTTP2_DVLOG(3) << DebugString() << " dtor";
-}
+HpackStringPair::HpackStringPair(absl::string_view name,
+                                 absl::string_view value)
+    : name(name), value(value) {}
 
 std::string HpackStringPair::DebugString() const {
   return absl::StrCat("HpackStringPair(name=", name, ", value=", value, ")");
@@ -80,24 +77,44 @@ void HpackDecoderDynamicTable::DynamicTableSizeUpdate(size_t size_limit) {
 
 // TODO(jamessynge): Check somewhere before here that names received from the
 // peer are valid (e.g. are lower-case, no whitespace, etc.).
-void HpackDecoderDynamicTable::Insert(std::string name, std::string value) {
-  HpackStringPair entry(std::move(name), std::move(value));
-  size_t entry_size = entry.size();
+void HpackDecoderDynamicTable::Insert(absl::string_view name,
+                                      absl::string_view value) {
+  size_t entry_size = HpackStringPair(name, value).size();
   HTTP2_DVLOG(2) << "InsertEntry of size=" << entry_size
-                 << "\n     name: " << entry.name
-                 << "\n    value: " << entry.value;
+                 << "\n     name: " << name << "\n    value: " << value;
   if (entry_size > size_limit_) {
     HTTP2_DVLOG(2) << "InsertEntry: entry larger than table, removing "
                    << table_.size() << " entries, of total size "
                    << current_size_ << " bytes.";
     table_.clear();
     current_size_ = 0;
+    buffer_end_ = 0;
     return;
   }
   ++insert_count_;
   size_t insert_limit = size_limit_ - entry_size;
   EnsureSizeNoMoreThan(insert_limit);
-  table_.push_front(entry);
+
+  // Evicted entries keep their bytes until the buffer is compacted, and the
+  // new entry is written after all of them, so |name| and |value| can only be
+  // overwritten by MakeRoom.
+  const size_t data_size = name.size() + value.size();
+  if (buffer_.size() - buffer_end_ < data_size) {
+    if (IsInBuffer(name) || IsInBuffer(value)) {
+      scratch_.assign(name.data(), name.size());
+      scratch_.append(value.data(), value.size());
+      name = absl::string_view(scratch_.data(), name.size());
+      value = absl::string_view(scratch_.data() + name.size(), value.size());
+    }
+    MakeRoom(data_size);
+  }
+  char* const data = &buffer_[buffer_end_];
+  name.copy(data, name.size());
+  value.copy(data + name.size(), value.size());
+  buffer_end_ += data_size;
+  table_.push_front(
+      HpackStringPair(absl::string_view(data, name.size()),
+                      absl::string_view(data + name.size(), value.size())));
   current_size_ += entry_size;
   HTTP2_DVLOG(2) << "InsertEntry: current_size_=" << current_size_;
   QUICHE_DCHECK_GE(current_size_, entry_size);
@@ -134,6 +151,43 @@ void HpackDecoderDynamicTable::RemoveLastEntry() {
   }
 }
 
+void HpackDecoderDynamicTable::MakeRoom(size_t data_size) {
+  if (buffer_.size() < 2 * size_limit_) {
+    HTTP2_DVLOG(2) << "MakeRoom: growing buffer to " << 2 * size_limit_;
+    std::string buffer(2 * size_limit_, '\0');
+    MoveEntriesTo(&buffer[0]);
+    buffer_.swap(buffer);
+  } else {
+    HTTP2_DVLOG(2) << "MakeRoom: compacting buffer";
+    MoveEntriesTo(&buffer_[0]);
+  }
+  // The entries left after evictions take up less than the size limit, along
+  // with the new entry.
+  QUICHE_DCHECK_LE(buffer_end_ + data_size, buffer_.size());
+}
+
+void HpackDecoderDynamicTable::MoveEntriesTo(char* destination) {
+  if (table_.empty()) {
+    buffer_end_ = 0;
+    return;
+  }
+  const char* const begin = table_.back().name.data();
+  const size_t size = buffer_.data() + buffer_end_ - begin;
+  memmove(destination, begin, size);
+  for (HpackStringPair& entry : table_) {
+    char* const name = destination + (entry.name.data() - begin);
+    entry.name = absl::string_view(name, entry.name.size());
+    entry.value =
+        absl::string_view(name + entry.name.size(), entry.value.size());
+  }
+  buffer_end_ = size;
+}
+
+bool HpackDecoderDynamicTable::IsInBuffer(absl::string_view s) const {
+  return !s.empty() && s.data() >= buffer_.data() &&
+         s.data() < buffer_.data() + buffer_.size();
+}
+
 HpackDecoderTables::HpackDecoderTables() = default;
 HpackDecoderTables::~HpackDecoderTables() = default;
 
@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "http2/http2_constants.h"
 #include "common/platform/api/quiche_export.h"
 #include "common/quiche_circular_deque.h"
@@ -33,9 +34,10 @@ namespace test {
 class HpackDecoderTablesPeer;
 }  // namespace test
 
+// A name and value in one of the tables. The strings are owned by the table,
+// and remain valid until the next change to the dynamic table.
 struct QUICHE_EXPORT_PRIVATE HpackStringPair {
-  HpackStringPair(std::string name, std::string value);
-  ~HpackStringPair();
+  HpackStringPair(absl::string_view name, absl::string_view value);
 
   // Returns the size of a header entry with this name and value, per the RFC:
   // http://httpwg.org/specs/rfc7541.html#calculating.table.size
@@ -43,8 +45,8 @@ struct QUICHE_EXPORT_PRIVATE HpackStringPair {
 
   std::string DebugString() const;
 
-  const std::string name;
-  const std::string value;
+  absl::string_view name;
+  absl::string_view value;
 };
 
 QUICHE_EXPORT_PRIVATE std::ostream& operator<<(std::ostream& os,
@@ -73,6 +75,10 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderStaticTable {
 // in the dynamic table. See these sections of the RFC:
 //   http://httpwg.org/specs/rfc7541.html#dynamic.table
 //   http://httpwg.org/specs/rfc7541.html#dynamic.table.management
+//
+// The names and values of the entries are copied, oldest first, into a single
+// buffer of twice the size limit, which is compacted when its end is reached,
+// so inserting and evicting entries does not allocate memory.
 class QUICHE_EXPORT_PRIVATE HpackDecoderDynamicTable {
  public:
   HpackDecoderDynamicTable();
@@ -89,7 +95,8 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderDynamicTable {
 
   // Insert entry if possible.
   // If entry is too large to insert, then dynamic table will be empty.
-  void Insert(std::string name, std::string value);
+  // |name| and |value| may refer to an entry of this table.
+  void Insert(absl::string_view name, absl::string_view value);
 
   // If index is valid, returns a pointer to the entry, otherwise returns
   // nullptr.
@@ -107,8 +114,31 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderDynamicTable {
   // Removes the oldest dynamic table entry.
   void RemoveLastEntry();
 
+  // Makes room for |data_size| more bytes at the end of |buffer_|, growing it
+  // to twice the size limit, or else moving the entries to its start.
+  void MakeRoom(size_t data_size);
+
+  // Copies the names and values of the entries to |destination|, which may
+  // be the start of |buffer_|, and points the entries at the copies.
+  void MoveEntriesTo(char* destination);
+
+  // Returns true if |s| points into |buffer_|.
+  bool IsInBuffer(absl::string_view s) const;
+
+  // Entries point into |buffer_|, newest first.
   quiche::QuicheCircularDeque<HpackStringPair> table_;
 
+  // Names and values of the entries, each name followed by its value, oldest
+  // first. Bytes of evicted entries before the oldest entry are reclaimed when
+  // the buffer is compacted.
+  std::string buffer_;
+
+  // Offset in |buffer_| right after the value of the newest entry.
+  size_t buffer_end_ = 0;
+
+  // Holds a name and value from |buffer_| while it is compacted.
+  std::string scratch_;
+
   // The last received DynamicTableSizeUpdate value, initialized to
   // SETTINGS_HEADER_TABLE_SIZE.
   size_t size_limit_ = Http2SettingsInfo::DefaultHeaderTableSize();
@@ -138,8 +168,8 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderTables {
 
   // Insert entry if possible.
   // If entry is too large to insert, then dynamic table will be empty.
-  void Insert(std::string name, std::string value) {
-    dynamic_table_.Insert(std::move(name), std::move(value));
+  void Insert(absl::string_view name, absl::string_view value) {
+    dynamic_table_.Insert(name, value);
   }
 
   // If index is valid, returns a pointer to the entry, otherwise returns
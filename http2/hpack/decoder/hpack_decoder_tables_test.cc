@@ -214,6 +214,18 @@ class HpackDecoderTablesTest : public HpackDecoderStaticTableTest {
     return VerifyDynamicTableContents();
   }
 
+  // Like Insert, but with the name of the dynamic table entry at |ndx|, which
+  // the insertion may evict.
+  AssertionResult InsertWithNameOf(size_t ndx, const std::string& value) {
+    const HpackStringPair* entry = Lookup(ndx + kFirstDynamicTableIndex);
+    VERIFY_NE(entry, nullptr);
+    const std::string name(entry->name);
+    tables_.Insert(entry->name, value);
+    FakeInsert(name, value);
+    FakeTrim(dynamic_size_limit());
+    return VerifyDynamicTableContents();
+  }
+
  private:
   HpackDecoderTables tables_;
 
@@ -254,6 +266,19 @@ TEST_F(HpackDecoderTablesTest, RandomDynamicTable) {
   }
 }
 
+// Insert entries named after the oldest entry, which each insertion evicts,
+// many times over the size of the table, so that the storage of the entries
+// is reused.
+TEST_F(HpackDecoderTablesTest, InsertNameOfEvictedEntry) {
+  ASSERT_TRUE(Insert("name", std::string(1000, 'v')));
+  for (int insert_count = 0; insert_count < 100; ++insert_count) {
+    const std::string value = GenerateWebSafeString(
+        random_.UniformInRange(500, 1500), RandomPtr());
+    ASSERT_TRUE(InsertWithNameOf(num_dynamic_entries() - 1, value));
+  }
+  EXPECT_TRUE(VerifyStaticTableContents());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace http2
@@ -7,6 +7,8 @@
 #include <bitset>
 #include <limits>
 
+#include "http2/platform/api/http2_flag_utils.h"
+#include "http2/platform/api/http2_flags.h"
 #include "http2/platform/api/http2_logging.h"
 
 // Terminology:
@@ -412,8 +414,21 @@ HpackHuffmanDecoder::HpackHuffmanDecoder() = default;
 
 HpackHuffmanDecoder::~HpackHuffmanDecoder() = default;
 
+void HpackHuffmanDecoder::Reset() {
+  use_fsm_decoder_ =
+      GetQuicheReloadableFlag(quic, quic_hpack_huffman_fsm_decoder);
+  if (use_fsm_decoder_) {
+    HTTP2_RELOADABLE_FLAG_COUNT(quic_hpack_huffman_fsm_decoder);
+    fsm_decoder_.Reset();
+  }
+  bit_buffer_.Reset();
+}
+
 bool HpackHuffmanDecoder::Decode(absl::string_view input, std::string* output) {
   HTTP2_DVLOG(1) << "HpackHuffmanDecoder::Decode";
+  if (use_fsm_decoder_) {
+    return fsm_decoder_.Decode(input, output);
+  }
 
   // Fill bit_buffer_ from input.
   input.remove_prefix(bit_buffer_.AppendBytes(input));
@@ -479,6 +494,9 @@ bool HpackHuffmanDecoder::Decode(absl::string_view input, std::string* output) {
 }
 
 std::string HpackHuffmanDecoder::DebugString() const {
+  if (use_fsm_decoder_) {
+    return fsm_decoder_.DebugString();
+  }
   return bit_buffer_.DebugString();
 }
 
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "http2/hpack/huffman/hpack_huffman_fsm_decoder.h"
 #include "common/platform/api/quiche_export.h"
 
 namespace http2 {
@@ -91,7 +92,7 @@ class QUICHE_EXPORT_PRIVATE HpackHuffmanDecoder {
   ~HpackHuffmanDecoder();
 
   // Prepare for decoding a new Huffman encoded string.
-  void Reset() { bit_buffer_.Reset(); }
+  void Reset();
 
   // Decode the portion of a HPACK Huffman encoded string that is in |input|,
   // appending the decoded symbols into |*output|, stopping when more bits are
@@ -115,6 +116,9 @@ class QUICHE_EXPORT_PRIVATE HpackHuffmanDecoder {
   // Call after passing the the final portion of a Huffman string to Decode,
   // and getting true as the result.
   bool InputProperlyTerminated() const {
+    if (use_fsm_decoder_) {
+      return fsm_decoder_.InputProperlyTerminated();
+    }
     return bit_buffer_.InputProperlyTerminated();
   }
 
@@ -122,6 +126,10 @@ class QUICHE_EXPORT_PRIVATE HpackHuffmanDecoder {
 
  private:
   HuffmanBitBuffer bit_buffer_;
+  HpackHuffmanFsmDecoder fsm_decoder_;
+  // Latched from quic_hpack_huffman_fsm_decoder by Reset, so that a string is
+  // decoded by the same decoder from start to end.
+  bool use_fsm_decoder_ = false;
 };
 
 inline std::ostream& operator<<(std::ostream& out,
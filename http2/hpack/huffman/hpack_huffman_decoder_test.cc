@@ -12,6 +12,7 @@
 #include "absl/strings/escaping.h"
 #include "http2/decoder/decode_buffer.h"
 #include "http2/decoder/decode_status.h"
+#include "http2/platform/api/http2_flags.h"
 #include "http2/platform/api/http2_test_helpers.h"
 #include "http2/tools/random_decoder_test.h"
 #include "common/platform/api/quiche_test.h"
@@ -239,6 +240,21 @@ TEST_F(HpackHuffmanDecoderTest, SpecResponseExamples) {
   }
 }
 
+TEST_F(HpackHuffmanDecoderTest, FsmDecoder) {
+  SetQuicheReloadableFlag(quic, quic_hpack_huffman_fsm_decoder, true);
+  HpackHuffmanDecoder decoder;
+  const std::string huffman_encoded =
+      absl::HexStringToBytes("f1e3c2e5f23a6ba0ab90f4ff");
+  std::string buffer;
+  decoder.Reset();
+  EXPECT_TRUE(decoder.Decode(huffman_encoded.substr(0, 5), &buffer))
+      << decoder;
+  EXPECT_FALSE(decoder.InputProperlyTerminated()) << decoder;
+  EXPECT_TRUE(decoder.Decode(huffman_encoded.substr(5), &buffer)) << decoder;
+  EXPECT_TRUE(decoder.InputProperlyTerminated()) << decoder;
+  EXPECT_EQ(buffer, "www.example.com");
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace http2
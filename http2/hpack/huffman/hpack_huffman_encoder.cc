@@ -4,17 +4,87 @@
 
 #include "http2/hpack/huffman/hpack_huffman_encoder.h"
 
+#include <cstring>
+
 #include "http2/hpack/huffman/huffman_spec_tables.h"
 #include "http2/platform/api/http2_logging.h"
+#include "common/quiche_endian.h"
 
 namespace http2 {
 
+namespace {
+
+// Writes the Huffman encoding of |input|, including the EOS padding, to
+// |output|, and returns its size in bytes. Codes are gathered in a 64-bit
+// accumulator and written out 32 bits at a time, so |output| is only ever
+// written with whole bytes of the encoding.
+// Gives up and returns a value greater than |max_encoded_size| as soon as the
+// encoding is known to be longer than that, in which case the contents of
+// |output| are unspecified. At most |max_encoded_size| bytes are written.
+size_t EncodeToBuffer(absl::string_view input,
+                      size_t max_encoded_size,
+                      char* output) {
+  // Pending bits are the |pending_bit_count| low bits of |accumulator|; higher
+  // bits have already been written. As codes are at most 30 bits long and
+  // fewer than 32 bits are pending before appending one, they always fit.
+  uint64_t accumulator = 0;
+  size_t pending_bit_count = 0;
+  size_t written = 0;
+  for (const uint8_t c : input) {
+    const size_t code_length = HuffmanSpecTables::kCodeLengths[c];
+    accumulator =
+        (accumulator << code_length) | HuffmanSpecTables::kRightCodes[c];
+    pending_bit_count += code_length;
+    if (pending_bit_count < 32) {
+      continue;
+    }
+    if (written + 4 > max_encoded_size) {
+      return max_encoded_size + 1;
+    }
+    pending_bit_count -= 32;
+    const uint32_t word = quiche::QuicheEndian::HostToNet32(
+        static_cast<uint32_t>(accumulator >> pending_bit_count));
+    memcpy(output + written, &word, sizeof(word));
+    written += 4;
+  }
+
+  // Pad the last partial byte with the leading bits of the EOS symbol (30
+  // 1-bits), as the spec requires, then write the remaining whole bytes.
+  const size_t padding_bit_count = (8 - pending_bit_count % 8) % 8;
+  accumulator = (accumulator << padding_bit_count) |
+                ((uint64_t{1} << padding_bit_count) - 1);
+  pending_bit_count += padding_bit_count;
+  if (written + pending_bit_count / 8 > max_encoded_size) {
+    return max_encoded_size + 1;
+  }
+  while (pending_bit_count > 0) {
+    pending_bit_count -= 8;
+    output[written++] = static_cast<char>(accumulator >> pending_bit_count);
+  }
+  return written;
+}
+
+}  // namespace
+
 size_t HuffmanSize(absl::string_view plain) {
-  size_t bits = 0;
-  for (const uint8_t c : plain) {
-    bits += HuffmanSpecTables::kCodeLengths[c];
+  // Four independent sums, so that the table lookups of consecutive
+  // characters do not wait on each other's additions.
+  size_t bits0 = 0;
+  size_t bits1 = 0;
+  size_t bits2 = 0;
+  size_t bits3 = 0;
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(plain.data());
+  const uint8_t* const end = data + plain.size();
+  for (; end - data >= 4; data += 4) {
+    bits0 += HuffmanSpecTables::kCodeLengths[data[0]];
+    bits1 += HuffmanSpecTables::kCodeLengths[data[1]];
+    bits2 += HuffmanSpecTables::kCodeLengths[data[2]];
+    bits3 += HuffmanSpecTables::kCodeLengths[data[3]];
   }
-  return (bits + 7) / 8;
+  for (; data != end; ++data) {
+    bits0 += HuffmanSpecTables::kCodeLengths[*data];
+  }
+  return (bits0 + bits1 + bits2 + bits3 + 7) / 8;
 }
 
 void HuffmanEncode(absl::string_view plain,
@@ -69,61 +139,27 @@ void HuffmanEncodeFast(absl::string_view input,
                        size_t encoded_size,
                        std::string* output) {
   const size_t original_size = output->size();
-  const size_t final_size = original_size + encoded_size;
-  // Reserve an extra four bytes to avoid accessing unallocated memory (even
-  // though it would only be OR'd with zeros and thus not modified).
-  output->resize(final_size + 4, 0);
-
-  // Pointer to first appended byte.
-  char* const first = &*output->begin() + original_size;
-  size_t bit_counter = 0;
-  for (uint8_t c : input) {
-    // Align the Huffman code to byte boundaries as it needs to be written.
-    // The longest Huffman code is 30 bits long, and it can be shifted by up to
-    // 7 bits, requiring 37 bits in total.  The most significant 25 bits and
-    // least significant 2 bits of |code| are always zero.
-    uint64_t code = static_cast<uint64_t>(HuffmanSpecTables::kLeftCodes[c])
-                    << (8 - (bit_counter % 8));
-    // The byte where the first bit of |code| needs to be written.
-    char* const current = first + (bit_counter / 8);
-
-    bit_counter += HuffmanSpecTables::kCodeLengths[c];
-
-    *current |= code >> 32;
-
-    // Do not check if this write is zero before executing it, because with
-    // uniformly random shifts and an ideal random input distribution
-    // corresponding to the Huffman tree it would only be zero in 29% of the
-    // cases.
-    *(current + 1) |= (code >> 24) & 0xff;
-
-    // Continue to next input character if there is nothing else to write.
-    // (If next byte is zero, then rest must also be zero.)
-    if ((code & 0xff0000) == 0) {
-      continue;
-    }
-    *(current + 2) |= (code >> 16) & 0xff;
-
-    // Continue to next input character if there is nothing else to write.
-    // (If next byte is zero, then rest must also be zero.)
-    if ((code & 0xff00) == 0) {
-      continue;
-    }
-    *(current + 3) |= (code >> 8) & 0xff;
+  output->resize(original_size + encoded_size);
+  const size_t written =
+      EncodeToBuffer(input, encoded_size, &*output->begin() + original_size);
+  QUICHE_DCHECK_EQ(encoded_size, written);
+}
 
-    // Do not check if this write is zero, because the check would probably be
-    // as expensive as the write.
-    *(current + 4) |= code & 0xff;
+bool HuffmanEncodeIfShorter(absl::string_view input, std::string* output) {
+  if (input.empty()) {
+    return false;
   }
-
-  QUICHE_DCHECK_EQ(encoded_size, (bit_counter + 7) / 8);
-
-  // EOF
-  if (bit_counter % 8 != 0) {
-    *(first + encoded_size - 1) |= 0xff >> (bit_counter & 7);
+  const size_t original_size = output->size();
+  const size_t max_encoded_size = input.size() - 1;
+  output->resize(original_size + max_encoded_size);
+  const size_t written = EncodeToBuffer(input, max_encoded_size,
+                                        &*output->begin() + original_size);
+  if (written > max_encoded_size) {
+    output->resize(original_size);
+    return false;
   }
-
-  output->resize(final_size);
+  output->resize(original_size + written);
+  return true;
 }
 
 }  // namespace http2
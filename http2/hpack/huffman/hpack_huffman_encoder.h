@@ -35,6 +35,14 @@ QUICHE_EXPORT_PRIVATE void HuffmanEncodeFast(absl::string_view input,
                                              size_t encoded_size,
                                              std::string* output);
 
+// Encode |input| as HuffmanEncodeFast() does and append the result to
+// |*output| if it is shorter than |input|, returning true. Otherwise leave
+// |*output| unchanged and return false, stopping as soon as the encoding is
+// known not to be shorter. This replaces calling HuffmanSize() to decide
+// whether Huffman encoding is worthwhile followed by HuffmanEncodeFast().
+QUICHE_EXPORT_PRIVATE bool HuffmanEncodeIfShorter(absl::string_view input,
+                                                  std::string* output);
+
 }  // namespace http2
 
 #endif  // QUICHE_HTTP2_HPACK_HUFFMAN_HPACK_HUFFMAN_ENCODER_H_
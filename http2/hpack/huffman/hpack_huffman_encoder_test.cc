@@ -6,6 +6,7 @@
 
 #include "absl/base/macros.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "common/platform/api/quiche_test.h"
 
 namespace http2 {
@@ -127,5 +128,45 @@ TEST_P(HuffmanEncoderTest, AppendToOutput) {
   EXPECT_EQ(absl::HexStringToBytes("94e78c767f"), buffer);
 }
 
+TEST(HuffmanEncodeIfShorterTest, Shorter) {
+  std::string buffer = "foo";
+  EXPECT_TRUE(HuffmanEncodeIfShorter("www.example.com", &buffer));
+  EXPECT_EQ(absl::StrCat("foo",
+                         absl::HexStringToBytes("f1e3c2e5f23a6ba0ab90f4ff")),
+            buffer);
+}
+
+TEST(HuffmanEncodeIfShorterTest, NotShorter) {
+  std::string buffer = "foo";
+  EXPECT_FALSE(HuffmanEncodeIfShorter("", &buffer));
+  EXPECT_FALSE(HuffmanEncodeIfShorter("x", &buffer));
+  // Encodes to three bytes.
+  EXPECT_FALSE(HuffmanEncodeIfShorter("##", &buffer));
+  EXPECT_FALSE(HuffmanEncodeIfShorter(std::string(100, '\xff'), &buffer));
+  EXPECT_EQ("foo", buffer);
+}
+
+// HuffmanEncodeIfShorter() must produce the same encoding as HuffmanEncode()
+// whenever that is shorter than the input.
+TEST(HuffmanEncodeIfShorterTest, AgreesWithHuffmanEncode) {
+  std::string plain_string;
+  for (int i = 0; i < 512; ++i) {
+    // Alternate between short and long codes.
+    plain_string.push_back(static_cast<char>(i % 3 == 0 ? 255 - i % 256 : 'a'));
+    const size_t encoded_size = HuffmanSize(plain_string);
+    std::string expected;
+    HuffmanEncode(plain_string, encoded_size, &expected);
+    std::string buffer;
+    EXPECT_EQ(encoded_size < plain_string.size(),
+              HuffmanEncodeIfShorter(plain_string, &buffer))
+        << i;
+    if (encoded_size < plain_string.size()) {
+      EXPECT_EQ(expected, buffer) << i;
+    } else {
+      EXPECT_TRUE(buffer.empty()) << i;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace http2
@@ -0,0 +1,169 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "http2/hpack/huffman/hpack_huffman_fsm_decoder.h"
+
+#include <sstream>
+
+#include "http2/hpack/huffman/huffman_spec_tables.h"
+#include "http2/platform/api/http2_logging.h"
+
+namespace http2 {
+namespace {
+
+// A Huffman code for 257 symbols has 256 internal nodes.
+constexpr int kNumStates = 256;
+constexpr int kEosSymbol = 256;
+// Longest padding allowed at the end of a string, see RFC 7541 section 5.2.
+constexpr int kMaxPaddingBitCount = 7;
+
+// Flags of an FsmTransition.
+constexpr uint8_t kEmitSymbol = 1;
+constexpr uint8_t kFail = 2;
+constexpr uint8_t kAccepting = 4;
+
+struct FsmTransition {
+  uint8_t next_state;
+  uint8_t flags;
+  uint8_t symbol;
+};
+
+class FsmTable {
+ public:
+  static const FsmTable& Get() {
+    static const FsmTable* table = new FsmTable();
+    return *table;
+  }
+
+  const FsmTransition& Lookup(uint8_t state, uint8_t nibble) const {
+    return transitions_[state][nibble];
+  }
+
+ private:
+  FsmTable();
+
+  FsmTransition transitions_[kNumStates][16];
+};
+
+FsmTable::FsmTable() {
+  // Build the code tree. Non-negative children are internal nodes, the root
+  // being node 0, and negative ones are leaves holding (-1 - symbol).
+  int children[kNumStates][2] = {};
+  int depth[kNumStates] = {};
+  bool all_ones[kNumStates] = {true};
+  int num_nodes = 1;
+  for (int symbol = 0; symbol <= kEosSymbol; ++symbol) {
+    const uint32_t code = HuffmanSpecTables::kLeftCodes[symbol];
+    const int length = HuffmanSpecTables::kCodeLengths[symbol];
+    int node = 0;
+    for (int i = 0; i < length; ++i) {
+      const int bit = (code >> (31 - i)) & 1;
+      int& child = children[node][bit];
+      if (i + 1 == length) {
+        QUICHE_DCHECK_EQ(child, 0);
+        child = -1 - symbol;
+        break;
+      }
+      if (child == 0) {
+        QUICHE_CHECK_LT(num_nodes, kNumStates);
+        child = num_nodes++;
+        depth[child] = i + 1;
+        all_ones[child] = all_ones[node] && bit == 1;
+      }
+      node = child;
+    }
+  }
+  QUICHE_DCHECK_EQ(num_nodes, kNumStates);
+
+  for (int state = 0; state < kNumStates; ++state) {
+    for (int nibble = 0; nibble < 16; ++nibble) {
+      FsmTransition& transition = transitions_[state][nibble];
+      transition = {0, 0, 0};
+      int node = state;
+      for (int i = 3; i >= 0; --i) {
+        const int child = children[node][(nibble >> i) & 1];
+        if (child >= 0) {
+          node = child;
+          continue;
+        }
+        const int symbol = -1 - child;
+        if (symbol == kEosSymbol) {
+          transition.flags = kFail;
+          break;
+        }
+        transition.flags |= kEmitSymbol;
+        transition.symbol = symbol;
+        node = 0;
+      }
+      if (transition.flags & kFail) {
+        continue;
+      }
+      transition.next_state = node;
+      if (all_ones[node] && depth[node] <= kMaxPaddingBitCount) {
+        transition.flags |= kAccepting;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+HpackHuffmanFsmDecoder::HpackHuffmanFsmDecoder() {
+  Reset();
+}
+
+HpackHuffmanFsmDecoder::~HpackHuffmanFsmDecoder() = default;
+
+void HpackHuffmanFsmDecoder::Reset() {
+  state_ = 0;
+  accepting_ = true;
+}
+
+bool HpackHuffmanFsmDecoder::Decode(absl::string_view input,
+                                    std::string* output) {
+  const FsmTable& table = FsmTable::Get();
+
+  // Every input byte completes at most two symbols, so write into space
+  // reserved for that many and trim afterwards. Symbols are stored
+  // unconditionally and the write position only advances when one was
+  // completed, which keeps the loop free of data dependent branches other
+  // than for failures.
+  const size_t initial_size = output->size();
+  output->resize(initial_size + 2 * input.size());
+  char* const begin = &(*output)[0];
+  char* out = begin + initial_size;
+
+  uint8_t state = state_;
+  uint8_t flags = accepting_ ? kAccepting : 0;
+  for (char c : input) {
+    const uint8_t byte = static_cast<uint8_t>(c);
+    const FsmTransition& high = table.Lookup(state, byte >> 4);
+    *out = high.symbol;
+    out += high.flags & kEmitSymbol;
+    const FsmTransition& low = table.Lookup(high.next_state, byte & 0x0f);
+    if (((high.flags | low.flags) & kFail) != 0) {
+      // Encoder is not supposed to explicity encode the EOS symbol.
+      HTTP2_DLOG(ERROR) << "EOS explicitly encoded!";
+      output->resize(out - begin);
+      return false;
+    }
+    *out = low.symbol;
+    out += low.flags & kEmitSymbol;
+    state = low.next_state;
+    flags = low.flags;
+  }
+  output->resize(out - begin);
+  state_ = state;
+  accepting_ = (flags & kAccepting) != 0;
+  return true;
+}
+
+std::string HpackHuffmanFsmDecoder::DebugString() const {
+  std::stringstream ss;
+  ss << "{state: " << static_cast<int>(state_)
+     << "; accepting: " << (accepting_ ? "true" : "false") << "}";
+  return ss.str();
+}
+
+}  // namespace http2
@@ -0,0 +1,65 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_HTTP2_HPACK_HUFFMAN_HPACK_HUFFMAN_FSM_DECODER_H_
+#define QUICHE_HTTP2_HPACK_HUFFMAN_HPACK_HUFFMAN_FSM_DECODER_H_
+
+// HpackHuffmanFsmDecoder is an incremental decoder of HPACK Huffman encoded
+// strings, with the same contract as HpackHuffmanDecoder, that walks a finite
+// state machine four bits of input at a time instead of accumulating bits and
+// matching code prefixes.
+//
+// The states are the 256 internal nodes of the Huffman code tree, so the whole
+// decoder state between calls to Decode is a single byte. Each table entry
+// gives, for a state and the next four bits, the resulting state and the
+// symbol (if any) completed along the way; as the shortest code is five bits
+// long, at most one symbol is completed per entry, and at most two per input
+// byte.
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "common/platform/api/quiche_export.h"
+
+namespace http2 {
+
+class QUICHE_EXPORT_PRIVATE HpackHuffmanFsmDecoder {
+ public:
+  HpackHuffmanFsmDecoder();
+  ~HpackHuffmanFsmDecoder();
+
+  // Prepare for decoding a new Huffman encoded string.
+  void Reset();
+
+  // Decode the portion of a HPACK Huffman encoded string that is in |input|,
+  // appending the decoded symbols into |*output|. Returns false if the
+  // encoding contains the EOS symbol, true otherwise, in which case all of
+  // |input| has been consumed; the bits of a trailing partial code are kept
+  // in the state for the next call.
+  // If |input| is the start of a string, the caller must first call Reset.
+  bool Decode(absl::string_view input, std::string* output);
+
+  // Is the current state valid at the end of an encoded string? That is the
+  // case if no bits of a partial code are pending, or if the pending bits are
+  // at most 7 bits of the EOS prefix (all ones).
+  bool InputProperlyTerminated() const { return accepting_; }
+
+  std::string DebugString() const;
+
+ private:
+  // Index of the Huffman tree node reached by the bits consumed so far.
+  uint8_t state_;
+  bool accepting_;
+};
+
+inline std::ostream& operator<<(std::ostream& out,
+                                const HpackHuffmanFsmDecoder& v) {
+  return out << v.DebugString();
+}
+
+}  // namespace http2
+
+#endif  // QUICHE_HTTP2_HPACK_HUFFMAN_HPACK_HUFFMAN_FSM_DECODER_H_
@@ -0,0 +1,43 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares HpackHuffmanFsmDecoder with HpackHuffmanDecoder. The first byte of
+// the input gives the size of the pieces the rest is passed to Decode in.
+
+#include <algorithm>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "http2/hpack/huffman/hpack_huffman_decoder.h"
+#include "http2/hpack/huffman/hpack_huffman_fsm_decoder.h"
+#include "common/platform/api/quiche_logging.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  const size_t piece_size = 1 + data[0];
+  absl::string_view input(reinterpret_cast<const char*>(data) + 1, size - 1);
+
+  http2::HpackHuffmanDecoder reference_decoder;
+  reference_decoder.Reset();
+  std::string expected;
+  const bool expected_result = reference_decoder.Decode(input, &expected);
+
+  http2::HpackHuffmanFsmDecoder decoder;
+  std::string output;
+  bool result = true;
+  while (result && !input.empty()) {
+    result = decoder.Decode(input.substr(0, piece_size), &output);
+    input.remove_prefix(std::min(piece_size, input.size()));
+  }
+
+  QUICHE_CHECK_EQ(expected_result, result);
+  if (result) {
+    QUICHE_CHECK_EQ(expected, output);
+    QUICHE_CHECK_EQ(reference_decoder.InputProperlyTerminated(),
+                    decoder.InputProperlyTerminated());
+  }
+  return 0;
+}
@@ -0,0 +1,150 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "http2/hpack/huffman/hpack_huffman_fsm_decoder.h"
+
+#include <string>
+
+#include "absl/base/macros.h"
+#include "absl/strings/escaping.h"
+#include "http2/hpack/huffman/hpack_huffman_decoder.h"
+#include "http2/hpack/huffman/hpack_huffman_encoder.h"
+#include "http2/test_tools/http2_random.h"
+#include "common/platform/api/quiche_test.h"
+
+namespace http2 {
+namespace test {
+namespace {
+
+std::string Encode(absl::string_view plain) {
+  std::string encoded;
+  HuffmanEncodeFast(plain, HuffmanSize(plain), &encoded);
+  return encoded;
+}
+
+TEST(HpackHuffmanFsmDecoderTest, SpecExamples) {
+  // clang-format off
+  std::string test_table[] = {
+    absl::HexStringToBytes("f1e3c2e5f23a6ba0ab90f4ff"),
+    "www.example.com",
+    absl::HexStringToBytes("a8eb10649cbf"),
+    "no-cache",
+    absl::HexStringToBytes("25a849e95bb8e8b4bf"),
+    "custom-value",
+    absl::HexStringToBytes("6402"),
+    "302",
+    absl::HexStringToBytes("d07abe941054d444a8200595040b8166"
+            "e082a62d1bff"),
+    "Mon, 21 Oct 2013 20:13:21 GMT",
+    absl::HexStringToBytes("94e7821dd7f2e6c7b335dfdfcd5b3960"
+            "d5af27087f3672c1ab270fb5291f9587"
+            "316065c003ed4ee5b1063d5007"),
+    "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1",
+  };
+  // clang-format on
+  HpackHuffmanFsmDecoder decoder;
+  for (size_t i = 0; i != ABSL_ARRAYSIZE(test_table); i += 2) {
+    const std::string& huffman_encoded(test_table[i]);
+    const std::string& plain_string(test_table[i + 1]);
+    std::string buffer;
+    decoder.Reset();
+    EXPECT_TRUE(decoder.Decode(huffman_encoded, &buffer)) << decoder;
+    EXPECT_TRUE(decoder.InputProperlyTerminated()) << decoder;
+    EXPECT_EQ(buffer, plain_string);
+  }
+}
+
+TEST(HpackHuffmanFsmDecoderTest, AllSymbols) {
+  std::string plain;
+  for (int c = 0; c < 256; ++c) {
+    plain.push_back(static_cast<char>(c));
+  }
+  HpackHuffmanFsmDecoder decoder;
+  std::string buffer;
+  EXPECT_TRUE(decoder.Decode(Encode(plain), &buffer)) << decoder;
+  EXPECT_TRUE(decoder.InputProperlyTerminated()) << decoder;
+  EXPECT_EQ(buffer, plain);
+}
+
+TEST(HpackHuffmanFsmDecoderTest, OneByteAtATime) {
+  const std::string plain = "custom-value\x01\xfe";
+  const std::string encoded = Encode(plain);
+  HpackHuffmanFsmDecoder decoder;
+  std::string buffer;
+  for (char c : encoded) {
+    EXPECT_TRUE(decoder.Decode(absl::string_view(&c, 1), &buffer)) << decoder;
+  }
+  EXPECT_TRUE(decoder.InputProperlyTerminated()) << decoder;
+  EXPECT_EQ(buffer, plain);
+}
+
+TEST(HpackHuffmanFsmDecoderTest, Padding) {
+  HpackHuffmanFsmDecoder decoder;
+  std::string buffer;
+  // '0' is 00000, padded with three ones.
+  EXPECT_TRUE(decoder.Decode(absl::HexStringToBytes("07"), &buffer));
+  EXPECT_TRUE(decoder.InputProperlyTerminated());
+  EXPECT_EQ("0", buffer);
+
+  // Padding with zeros is not a prefix of EOS.
+  decoder.Reset();
+  buffer.clear();
+  EXPECT_TRUE(decoder.Decode(absl::HexStringToBytes("00"), &buffer));
+  EXPECT_FALSE(decoder.InputProperlyTerminated());
+
+  // Eight bits of padding are too many.
+  decoder.Reset();
+  buffer.clear();
+  EXPECT_TRUE(decoder.Decode(absl::HexStringToBytes("ff"), &buffer));
+  EXPECT_FALSE(decoder.InputProperlyTerminated());
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(HpackHuffmanFsmDecoderTest, ExplicitEos) {
+  HpackHuffmanFsmDecoder decoder;
+  std::string buffer;
+  // '0' followed by the 30 bits of EOS.
+  EXPECT_FALSE(decoder.Decode(absl::HexStringToBytes("07ffffffff"), &buffer));
+  EXPECT_EQ("0", buffer);
+}
+
+// Decodes random strings, valid and not, split into random pieces, with both
+// decoders, which must agree on the output and on the validity of the input.
+TEST(HpackHuffmanFsmDecoderTest, MatchesHpackHuffmanDecoder) {
+  Http2Random random;
+  for (int i = 0; i < 2000; ++i) {
+    std::string encoded;
+    if (random.OneIn(2)) {
+      encoded = Encode(random.RandString(random.Uniform(64)));
+    } else {
+      encoded = random.RandString(random.Uniform(32));
+    }
+
+    HpackHuffmanDecoder reference_decoder;
+    reference_decoder.Reset();
+    std::string expected;
+    const bool expected_result = reference_decoder.Decode(encoded, &expected);
+
+    HpackHuffmanFsmDecoder decoder;
+    std::string buffer;
+    bool result = true;
+    absl::string_view input(encoded);
+    while (result && !input.empty()) {
+      const size_t length = 1 + random.Uniform(input.size());
+      result = decoder.Decode(input.substr(0, length), &buffer);
+      input.remove_prefix(length);
+    }
+    ASSERT_EQ(expected_result, result) << absl::BytesToHexString(encoded);
+    if (result) {
+      EXPECT_EQ(expected, buffer) << absl::BytesToHexString(encoded);
+      EXPECT_EQ(reference_decoder.InputProperlyTerminated(),
+                decoder.InputProperlyTerminated())
+          << absl::BytesToHexString(encoded);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace http2
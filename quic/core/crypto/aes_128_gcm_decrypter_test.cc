@@ -285,6 +285,14 @@ TEST_F(Aes128GcmDecrypterTest, GenerateHeaderProtectionMask) {
   quiche::test::CompareCharArraysWithHexError(
       "header protection mask", mask.data(), mask.size(), expected_mask.data(),
       expected_mask.size());
+
+  QuicDataReader fixed_sample_reader(sample.data(), sample.size());
+  QuicHeaderProtectionMask fixed_mask;
+  ASSERT_TRUE(decrypter.GenerateHeaderProtectionMaskInto(&fixed_sample_reader,
+                                                         &fixed_mask));
+  quiche::test::CompareCharArraysWithHexError(
+      "header protection mask", fixed_mask.data(), fixed_mask.size(),
+      expected_mask.data(), fixed_mask.size());
 }
 
 }  // namespace test
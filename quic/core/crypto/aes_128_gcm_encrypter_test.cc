@@ -267,6 +267,14 @@ TEST_F(Aes128GcmEncrypterTest, GenerateHeaderProtectionMask) {
   quiche::test::CompareCharArraysWithHexError(
       "header protection mask", mask.data(), mask.size(), expected_mask.data(),
       expected_mask.size());
+
+  QuicHeaderProtectionMask fixed_mask;
+  ASSERT_TRUE(encrypter.GenerateHeaderProtectionMaskInto(sample, &fixed_mask));
+  quiche::test::CompareCharArraysWithHexError(
+      "header protection mask", fixed_mask.data(), fixed_mask.size(),
+      expected_mask.data(), fixed_mask.size());
+  EXPECT_FALSE(encrypter.GenerateHeaderProtectionMaskInto(
+      absl::string_view(sample).substr(1), &fixed_mask));
 }
 
 }  // namespace test
@@ -4,6 +4,8 @@
 
 #include "quic/core/crypto/aes_base_decrypter.h"
 
+#include <cstring>
+
 #include "absl/strings/string_view.h"
 #include "third_party/boringssl/src/include/openssl/aes.h"
 #include "quic/platform/api/quic_bug_tracker.h"
@@ -36,6 +38,20 @@ std::string AesBaseDecrypter::GenerateHeaderProtectionMask(
   return out;
 }
 
+bool AesBaseDecrypter::GenerateHeaderProtectionMaskInto(
+    QuicDataReader* sample_reader,
+    QuicHeaderProtectionMask* mask) {
+  absl::string_view sample;
+  if (!sample_reader->ReadStringPiece(&sample, AES_BLOCK_SIZE)) {
+    return false;
+  }
+  uint8_t block[AES_BLOCK_SIZE];
+  AES_encrypt(reinterpret_cast<const uint8_t*>(sample.data()), block,
+              &pne_key_);
+  memcpy(mask->data(), block, mask->size());
+  return true;
+}
+
 QuicPacketCount AesBaseDecrypter::GetIntegrityLimit() const {
   // For AEAD_AES_128_GCM ... endpoints that do not attempt to remove
   // protection from packets larger than 2^11 bytes can attempt to remove
@@ -21,6 +21,9 @@ class QUIC_EXPORT_PRIVATE AesBaseDecrypter : public AeadBaseDecrypter {
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) override;
+  bool GenerateHeaderProtectionMaskInto(
+      QuicDataReader* sample_reader,
+      QuicHeaderProtectionMask* mask) override;
   QuicPacketCount GetIntegrityLimit() const override;
 
  private:
@@ -4,6 +4,8 @@
 
 #include "quic/core/crypto/aes_base_encrypter.h"
 
+#include <cstring>
+
 #include "absl/strings/string_view.h"
 #include "third_party/boringssl/src/include/openssl/aes.h"
 #include "quic/platform/api/quic_bug_tracker.h"
@@ -36,6 +38,19 @@ std::string AesBaseEncrypter::GenerateHeaderProtectionMask(
   return out;
 }
 
+bool AesBaseEncrypter::GenerateHeaderProtectionMaskInto(
+    absl::string_view sample,
+    QuicHeaderProtectionMask* mask) {
+  if (sample.size() != AES_BLOCK_SIZE) {
+    return false;
+  }
+  uint8_t block[AES_BLOCK_SIZE];
+  AES_encrypt(reinterpret_cast<const uint8_t*>(sample.data()), block,
+              &pne_key_);
+  memcpy(mask->data(), block, mask->size());
+  return true;
+}
+
 QuicPacketCount AesBaseEncrypter::GetConfidentialityLimit() const {
   // For AEAD_AES_128_GCM and AEAD_AES_256_GCM ... endpoints that do not send
   // packets larger than 2^11 bytes cannot protect more than 2^28 packets.
@@ -20,6 +20,9 @@ class QUIC_EXPORT_PRIVATE AesBaseEncrypter : public AeadBaseEncrypter {
 
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(absl::string_view sample) override;
+  bool GenerateHeaderProtectionMaskInto(
+      absl::string_view sample,
+      QuicHeaderProtectionMask* mask) override;
   QuicPacketCount GetConfidentialityLimit() const override;
 
  private:
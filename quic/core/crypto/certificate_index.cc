@@ -0,0 +1,266 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/certificate_index.h"
+
+#include <memory>
+
+#include "absl/strings/str_cat.h"
+#include "third_party/boringssl/src/include/openssl/bytestring.h"
+#include "third_party/boringssl/src/include/openssl/evp.h"
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/quic_data_writer.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+constexpr uint32_t kIndexMagic = 0x51434958;  // "QCIX"
+constexpr uint32_t kIndexVersion = 1;
+
+constexpr size_t kHeaderSize = 4 * sizeof(uint32_t);
+constexpr size_t kHostnameEntrySize = 3 * sizeof(uint32_t);
+constexpr size_t kChainEntrySize = sizeof(uint64_t);
+
+bool ReadStringPiece32(QuicDataReader* reader, absl::string_view* result) {
+  uint32_t length;
+  return reader->ReadUInt32(&length) && reader->ReadStringPiece(result, length);
+}
+
+bool WriteStringPiece32(QuicDataWriter* writer, absl::string_view value) {
+  return writer->WriteUInt32(value.size()) && writer->WriteStringPiece(value);
+}
+
+}  // namespace
+
+CertificateIndex::ChainEntry::ChainEntry() = default;
+CertificateIndex::ChainEntry::ChainEntry(const ChainEntry&) = default;
+CertificateIndex::ChainEntry::~ChainEntry() = default;
+
+// static
+absl::optional<CertificateIndex> CertificateIndex::Parse(
+    absl::string_view data) {
+  QuicDataReader reader(data);
+  uint32_t magic, version, num_hostnames, num_chains;
+  if (!reader.ReadUInt32(&magic) || !reader.ReadUInt32(&version) ||
+      !reader.ReadUInt32(&num_hostnames) || !reader.ReadUInt32(&num_chains)) {
+    QUIC_DLOG(ERROR) << "Certificate index is truncated";
+    return absl::nullopt;
+  }
+  if (magic != kIndexMagic || version != kIndexVersion) {
+    QUIC_DLOG(ERROR) << "Unsupported certificate index, magic " << magic
+                     << ", version " << version;
+    return absl::nullopt;
+  }
+  // Entries are bounds-checked when they are used, which keeps opening an
+  // index independent of its size.
+  const uint64_t tables_size =
+      static_cast<uint64_t>(num_hostnames) * kHostnameEntrySize +
+      static_cast<uint64_t>(num_chains) * kChainEntrySize;
+  if (num_chains == 0 || reader.BytesRemaining() < tables_size) {
+    QUIC_DLOG(ERROR) << "Certificate index has invalid tables";
+    return absl::nullopt;
+  }
+  return CertificateIndex(data, num_hostnames, num_chains);
+}
+
+CertificateIndex::CertificateIndex(absl::string_view data,
+                                   uint32_t num_hostnames,
+                                   uint32_t num_chains)
+    : data_(data), num_hostnames_(num_hostnames), num_chains_(num_chains) {}
+
+absl::optional<uint32_t> CertificateIndex::FindChain(
+    absl::string_view hostname) const {
+  absl::optional<uint32_t> chain_id = FindExactChain(hostname);
+  if (chain_id.has_value()) {
+    return chain_id;
+  }
+  auto dot_pos = hostname.find('.');
+  if (dot_pos == absl::string_view::npos) {
+    return absl::nullopt;
+  }
+  return FindExactChain(absl::StrCat("*", hostname.substr(dot_pos)));
+}
+
+absl::optional<uint32_t> CertificateIndex::FindExactChain(
+    absl::string_view hostname) const {
+  // Binary search over the sorted hostname table.
+  uint32_t low = 0;
+  uint32_t high = num_hostnames_;
+  while (low < high) {
+    const uint32_t mid = low + (high - low) / 2;
+    QuicDataReader reader(data_.substr(kHeaderSize + mid * kHostnameEntrySize,
+                                       kHostnameEntrySize));
+    uint32_t name_offset, name_length, chain_id;
+    if (!reader.ReadUInt32(&name_offset) || !reader.ReadUInt32(&name_length) ||
+        !reader.ReadUInt32(&chain_id) || name_offset > data_.size() ||
+        name_length > data_.size() - name_offset) {
+      QUIC_LOG_FIRST_N(ERROR, 1) << "Malformed certificate index entry " << mid;
+      return absl::nullopt;
+    }
+    const int comparison =
+        data_.substr(name_offset, name_length).compare(hostname);
+    if (comparison == 0) {
+      return chain_id;
+    }
+    if (comparison < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return absl::nullopt;
+}
+
+absl::optional<CertificateIndex::ChainEntry> CertificateIndex::GetChain(
+    uint32_t chain_id) const {
+  if (chain_id >= num_chains_) {
+    return absl::nullopt;
+  }
+  QuicDataReader table_reader(
+      data_.substr(kHeaderSize + num_hostnames_ * kHostnameEntrySize +
+                       chain_id * kChainEntrySize,
+                   kChainEntrySize));
+  uint64_t chain_offset;
+  if (!table_reader.ReadUInt64(&chain_offset) ||
+      chain_offset >= data_.size()) {
+    return absl::nullopt;
+  }
+
+  QuicDataReader reader(data_.substr(chain_offset));
+  ChainEntry entry;
+  uint32_t num_certs;
+  if (!ReadStringPiece32(&reader, &entry.private_key) ||
+      !ReadStringPiece32(&reader, &entry.ocsp_response) ||
+      !ReadStringPiece32(&reader, &entry.signed_certificate_timestamps) ||
+      !reader.ReadUInt32(&num_certs) || num_certs == 0) {
+    return absl::nullopt;
+  }
+  for (uint32_t i = 0; i < num_certs; ++i) {
+    absl::string_view cert;
+    if (!ReadStringPiece32(&reader, &cert)) {
+      return absl::nullopt;
+    }
+    entry.certs.push_back(cert);
+  }
+  return entry;
+}
+
+CertificateIndexBuilder::CertificateIndexBuilder() = default;
+CertificateIndexBuilder::~CertificateIndexBuilder() = default;
+
+bool CertificateIndexBuilder::AddChain(
+    const std::vector<std::string>& certs,
+    const CertificatePrivateKey& key,
+    absl::string_view ocsp_response,
+    absl::string_view signed_certificate_timestamps) {
+  if (certs.empty()) {
+    QUIC_LOG(ERROR) << "Empty certificate chain supplied.";
+    return false;
+  }
+  std::unique_ptr<CertificateView> leaf =
+      CertificateView::ParseSingleCertificate(certs[0]);
+  if (leaf == nullptr) {
+    QUIC_LOG(ERROR)
+        << "Unable to parse X.509 leaf certificate in the supplied chain.";
+    return false;
+  }
+  if (!key.MatchesPublicKey(*leaf)) {
+    QUIC_LOG(ERROR) << "Private key does not match the leaf certificate.";
+    return false;
+  }
+
+  bssl::ScopedCBB cbb;
+  uint8_t* key_der;
+  size_t key_der_length;
+  if (!CBB_init(cbb.get(), 0) ||
+      !EVP_marshal_private_key(cbb.get(), key.private_key()) ||
+      !CBB_finish(cbb.get(), &key_der, &key_der_length)) {
+    QUIC_LOG(ERROR) << "Unable to serialize the private key.";
+    return false;
+  }
+  bssl::UniquePtr<uint8_t> delete_key_der(key_der);
+
+  const uint32_t chain_id = chains_.size();
+  chains_.push_back(Chain{
+      certs,
+      std::string(reinterpret_cast<const char*>(key_der), key_der_length),
+      std::string(ocsp_response), std::string(signed_certificate_timestamps)});
+  for (absl::string_view host : leaf->subject_alt_name_domains()) {
+    hostnames_[std::string(host)] = chain_id;
+  }
+  return true;
+}
+
+bool CertificateIndexBuilder::AddHostname(absl::string_view hostname,
+                                          uint32_t chain_id) {
+  if (chain_id >= chains_.size()) {
+    return false;
+  }
+  hostnames_[std::string(hostname)] = chain_id;
+  return true;
+}
+
+std::string CertificateIndexBuilder::Serialize() const {
+  if (chains_.empty()) {
+    return std::string();
+  }
+  const size_t tables_size = kHeaderSize +
+                             hostnames_.size() * kHostnameEntrySize +
+                             chains_.size() * kChainEntrySize;
+  size_t total_size = tables_size;
+  for (const auto& hostname : hostnames_) {
+    total_size += hostname.first.size();
+  }
+  std::vector<uint64_t> chain_offsets;
+  for (const Chain& chain : chains_) {
+    chain_offsets.push_back(total_size);
+    total_size += 4 * sizeof(uint32_t) + chain.private_key.size() +
+                  chain.ocsp_response.size() +
+                  chain.signed_certificate_timestamps.size();
+    for (const std::string& cert : chain.certs) {
+      total_size += sizeof(uint32_t) + cert.size();
+    }
+  }
+
+  std::string result(total_size, '\0');
+  QuicDataWriter writer(result.size(), &result[0]);
+  bool success = writer.WriteUInt32(kIndexMagic) &&
+                 writer.WriteUInt32(kIndexVersion) &&
+                 writer.WriteUInt32(hostnames_.size()) &&
+                 writer.WriteUInt32(chains_.size());
+  size_t name_offset = tables_size;
+  for (const auto& hostname : hostnames_) {
+    success = success && writer.WriteUInt32(name_offset) &&
+              writer.WriteUInt32(hostname.first.size()) &&
+              writer.WriteUInt32(hostname.second);
+    name_offset += hostname.first.size();
+  }
+  for (uint64_t chain_offset : chain_offsets) {
+    success = success && writer.WriteUInt64(chain_offset);
+  }
+  for (const auto& hostname : hostnames_) {
+    success = success && writer.WriteStringPiece(hostname.first);
+  }
+  for (const Chain& chain : chains_) {
+    success =
+        success && WriteStringPiece32(&writer, chain.private_key) &&
+        WriteStringPiece32(&writer, chain.ocsp_response) &&
+        WriteStringPiece32(&writer, chain.signed_certificate_timestamps) &&
+        writer.WriteUInt32(chain.certs.size());
+    for (const std::string& cert : chain.certs) {
+      success = success && WriteStringPiece32(&writer, cert);
+    }
+  }
+  if (!success || writer.remaining() != 0) {
+    QUIC_BUG(quic_bug_certificate_index_size_mismatch)
+        << "Failed to serialize certificate index";
+    return std::string();
+  }
+  return result;
+}
+
+}  // namespace quic
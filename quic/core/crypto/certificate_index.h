@@ -0,0 +1,122 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_CERTIFICATE_INDEX_H_
+#define QUICHE_QUIC_CORE_CRYPTO_CERTIFICATE_INDEX_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "quic/core/crypto/certificate_view.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// CertificateIndex is a read-only view of a serialized set of certificate
+// chains, each with its private key, OCSP response and SCT list, indexed by the
+// DNS names of the leaf certificates. The serialized form is meant to be
+// memory-mapped: hostnames are binary-searched in place and nothing is parsed
+// until a chain is used, so the cost of loading it does not grow with the
+// number of certificates.
+//
+// All integers are in network byte order. The layout is:
+//   header:         magic, version, num_hostnames, num_chains (uint32 each)
+//   hostname table: num_hostnames x {name_offset, name_length, chain_id}
+//                   (uint32 each), sorted by name
+//   chain table:    num_chains x chain_offset (uint64)
+//   data:           hostnames, then chain records
+// A chain record is the private key, OCSP response and SCT list, each prefixed
+// by its uint32 length, followed by a uint32 number of certificates and the
+// certificates, each prefixed by its uint32 length. Offsets are from the start
+// of the index.
+class QUIC_EXPORT_PRIVATE CertificateIndex {
+ public:
+  // Chain |kDefaultChainId| is used for hostnames with no match.
+  static constexpr uint32_t kDefaultChainId = 0;
+
+  struct QUIC_EXPORT_PRIVATE ChainEntry {
+    ChainEntry();
+    ChainEntry(const ChainEntry&);
+    ~ChainEntry();
+
+    std::vector<absl::string_view> certs;
+    // DER-encoded PrivateKeyInfo.
+    absl::string_view private_key;
+    absl::string_view ocsp_response;
+    absl::string_view signed_certificate_timestamps;
+  };
+
+  // Returns nullopt if |data| is not a valid index. |data| must outlive the
+  // returned index.
+  static absl::optional<CertificateIndex> Parse(absl::string_view data);
+
+  // Returns the ID of the chain for |hostname|, trying an exact match and then
+  // a wildcard match of its first label. Returns nullopt if neither matches.
+  absl::optional<uint32_t> FindChain(absl::string_view hostname) const;
+
+  // Returns nullopt if |chain_id| is out of range or the record is malformed.
+  absl::optional<ChainEntry> GetChain(uint32_t chain_id) const;
+
+  uint32_t num_hostnames() const { return num_hostnames_; }
+  uint32_t num_chains() const { return num_chains_; }
+
+ private:
+  CertificateIndex(absl::string_view data,
+                   uint32_t num_hostnames,
+                   uint32_t num_chains);
+
+  absl::optional<uint32_t> FindExactChain(absl::string_view hostname) const;
+
+  absl::string_view data_;
+  uint32_t num_hostnames_;
+  uint32_t num_chains_;
+};
+
+// CertificateIndexBuilder collects certificate chains and serializes them into
+// the format read by CertificateIndex. The first chain added is the default
+// chain. A chain added later replaces earlier ones for the names they share.
+class QUIC_EXPORT_PRIVATE CertificateIndexBuilder {
+ public:
+  CertificateIndexBuilder();
+  CertificateIndexBuilder(const CertificateIndexBuilder&) = delete;
+  CertificateIndexBuilder& operator=(const CertificateIndexBuilder&) = delete;
+  ~CertificateIndexBuilder();
+
+  // Adds a chain of DER certificates, leaf first. |ocsp_response| and
+  // |signed_certificate_timestamps| may be empty. Returns false if the leaf
+  // cannot be parsed or does not match |key|.
+  bool AddChain(const std::vector<std::string>& certs,
+                const CertificatePrivateKey& key,
+                absl::string_view ocsp_response,
+                absl::string_view signed_certificate_timestamps);
+
+  // Also serves chain |chain_id| for |hostname|, which need not be a name of
+  // its leaf. Returns false if no such chain was added.
+  bool AddHostname(absl::string_view hostname, uint32_t chain_id);
+
+  // Returns an empty string if no chain was added.
+  std::string Serialize() const;
+
+  size_t num_chains() const { return chains_.size(); }
+
+ private:
+  struct Chain {
+    std::vector<std::string> certs;
+    std::string private_key;
+    std::string ocsp_response;
+    std::string signed_certificate_timestamps;
+  };
+
+  std::vector<Chain> chains_;
+  // Sorted, as required by the hostname table.
+  std::map<std::string, uint32_t> hostnames_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_CERTIFICATE_INDEX_H_
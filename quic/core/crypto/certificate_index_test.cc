@@ -0,0 +1,175 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/certificate_index.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "quic/core/crypto/certificate_view.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/test_certificates.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class CertificateIndexTest : public QuicTest {
+ public:
+  CertificateIndexTest()
+      : test_key_(
+            CertificatePrivateKey::LoadFromDer(kTestCertificatePrivateKey)),
+        wildcard_key_(CertificatePrivateKey::LoadFromDer(
+            kWildcardCertificatePrivateKey)) {
+    QUICHE_CHECK(test_key_ != nullptr);
+    QUICHE_CHECK(wildcard_key_ != nullptr);
+  }
+
+ protected:
+  std::string BuildIndex() {
+    CertificateIndexBuilder builder;
+    EXPECT_TRUE(builder.AddChain({std::string(kTestCertificate)}, *test_key_,
+                                 "ocsp", "scts"));
+    EXPECT_TRUE(builder.AddChain({std::string(kWildcardCertificate)},
+                                 *wildcard_key_, "", ""));
+    return builder.Serialize();
+  }
+
+  std::unique_ptr<CertificatePrivateKey> test_key_, wildcard_key_;
+};
+
+TEST_F(CertificateIndexTest, KeyMismatch) {
+  CertificateIndexBuilder builder;
+  EXPECT_FALSE(builder.AddChain({std::string(kTestCertificate)},
+                                *wildcard_key_, "", ""));
+  EXPECT_FALSE(builder.AddChain({}, *test_key_, "", ""));
+  EXPECT_EQ(0u, builder.num_chains());
+  EXPECT_EQ("", builder.Serialize());
+}
+
+TEST_F(CertificateIndexTest, FindChain) {
+  std::string data = BuildIndex();
+  absl::optional<CertificateIndex> index = CertificateIndex::Parse(data);
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(2u, index->num_chains());
+
+  // mail.example.org is explicitly a SubjectAltName in kTestCertificate.
+  EXPECT_EQ(0u, index->FindChain("mail.example.org"));
+  // *.wildcard.test is in kWildcardCertificate.
+  EXPECT_EQ(1u, index->FindChain("www.wildcard.test"));
+  EXPECT_EQ(1u, index->FindChain("etc.wildcard.test"));
+  // wildcard.test itself is not in kWildcardCertificate.
+  EXPECT_FALSE(index->FindChain("wildcard.test").has_value());
+  EXPECT_FALSE(index->FindChain("foo.bar.wildcard.test").has_value());
+  EXPECT_FALSE(index->FindChain("").has_value());
+}
+
+TEST_F(CertificateIndexTest, GetChain) {
+  std::string data = BuildIndex();
+  absl::optional<CertificateIndex> index = CertificateIndex::Parse(data);
+  ASSERT_TRUE(index.has_value());
+
+  absl::optional<CertificateIndex::ChainEntry> chain = index->GetChain(0);
+  ASSERT_TRUE(chain.has_value());
+  ASSERT_EQ(1u, chain->certs.size());
+  EXPECT_EQ(kTestCertificate, chain->certs[0]);
+  EXPECT_EQ("ocsp", chain->ocsp_response);
+  EXPECT_EQ("scts", chain->signed_certificate_timestamps);
+  std::unique_ptr<CertificatePrivateKey> key =
+      CertificatePrivateKey::LoadFromDer(chain->private_key);
+  ASSERT_TRUE(key != nullptr);
+  std::unique_ptr<CertificateView> leaf =
+      CertificateView::ParseSingleCertificate(chain->certs[0]);
+  ASSERT_TRUE(leaf != nullptr);
+  EXPECT_TRUE(key->MatchesPublicKey(*leaf));
+
+  chain = index->GetChain(1);
+  ASSERT_TRUE(chain.has_value());
+  EXPECT_EQ(kWildcardCertificate, chain->certs[0]);
+  EXPECT_EQ("", chain->ocsp_response);
+
+  EXPECT_FALSE(index->GetChain(2).has_value());
+}
+
+TEST_F(CertificateIndexTest, LaterChainOverridesNames) {
+  CertificateIndexBuilder builder;
+  ASSERT_TRUE(builder.AddChain({std::string(kTestCertificate)}, *test_key_,
+                               "first", ""));
+  ASSERT_TRUE(builder.AddChain({std::string(kTestCertificate)}, *test_key_,
+                               "second", ""));
+  std::string data = builder.Serialize();
+  absl::optional<CertificateIndex> index = CertificateIndex::Parse(data);
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(1u, index->FindChain("mail.example.org"));
+}
+
+TEST_F(CertificateIndexTest, InvalidIndex) {
+  std::string data = BuildIndex();
+  EXPECT_FALSE(CertificateIndex::Parse("").has_value());
+  EXPECT_FALSE(CertificateIndex::Parse(data.substr(0, 15)).has_value());
+  // Tables cut short.
+  EXPECT_FALSE(CertificateIndex::Parse(data.substr(0, 20)).has_value());
+
+  std::string bad_magic = data;
+  bad_magic[0] ^= 1;
+  EXPECT_FALSE(CertificateIndex::Parse(bad_magic).has_value());
+
+  // A truncated chain record is caught when the chain is used.
+  absl::optional<CertificateIndex> index =
+      CertificateIndex::Parse(data.substr(0, data.size() - 1));
+  ASSERT_TRUE(index.has_value());
+  EXPECT_TRUE(index->GetChain(0).has_value());
+  EXPECT_FALSE(index->GetChain(1).has_value());
+}
+
+// Opening an index does not depend on the number of chains in it.
+TEST_F(CertificateIndexTest, ManyChains) {
+  const uint32_t kNumChains = 5000;
+  CertificateIndexBuilder builder;
+  for (uint32_t i = 0; i < kNumChains; ++i) {
+    ASSERT_TRUE(builder.AddChain({std::string(kWildcardCertificate)},
+                                 *wildcard_key_, "", ""));
+    ASSERT_TRUE(
+        builder.AddHostname(absl::StrFormat("host-%05d.example", i), i));
+  }
+  EXPECT_FALSE(builder.AddHostname("host.example", kNumChains));
+  std::string data = builder.Serialize();
+  absl::optional<CertificateIndex> index = CertificateIndex::Parse(data);
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(kNumChains, index->num_chains());
+  // The hostnames added above, and *.wildcard.test.
+  EXPECT_EQ(kNumChains + 1, index->num_hostnames());
+
+  // First, last and inner entries of the hostname table.
+  EXPECT_EQ(kNumChains - 1, index->FindChain("www.wildcard.test"));
+  EXPECT_EQ(0u, index->FindChain("host-00000.example"));
+  EXPECT_EQ(1u, index->FindChain("host-00001.example"));
+  EXPECT_EQ(2500u, index->FindChain("host-02500.example"));
+  EXPECT_EQ(kNumChains - 2, index->FindChain("host-04998.example"));
+  EXPECT_EQ(kNumChains - 1, index->FindChain("host-04999.example"));
+  for (uint32_t i = 0; i < kNumChains; i += 97) {
+    EXPECT_EQ(i, index->FindChain(absl::StrFormat("host-%05d.example", i)));
+  }
+
+  // Names sorting before, after and between entries.
+  EXPECT_FALSE(index->FindChain("a.example").has_value());
+  EXPECT_FALSE(index->FindChain("host-.example").has_value());
+  EXPECT_FALSE(index->FindChain("host-00000.exampl").has_value());
+  EXPECT_FALSE(index->FindChain("host-00000.examplea").has_value());
+  EXPECT_FALSE(index->FindChain("host-02500.examplf").has_value());
+  EXPECT_FALSE(index->FindChain("host-05000.example").has_value());
+  EXPECT_FALSE(index->FindChain("zzz.example").has_value());
+
+  absl::optional<CertificateIndex::ChainEntry> chain =
+      index->GetChain(kNumChains - 1);
+  ASSERT_TRUE(chain.has_value());
+  EXPECT_EQ(kWildcardCertificate, chain->certs[0]);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
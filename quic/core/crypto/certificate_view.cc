@@ -603,14 +603,10 @@ std::string CertificatePrivateKey::Sign(absl::string_view input,
     }
   }
 
-  std::string output;
-  size_t output_size;
-  if (!EVP_DigestSign(md_ctx.get(), /*out_sig=*/nullptr, &output_size,
-                      reinterpret_cast<const uint8_t*>(input.data()),
-                      input.size())) {
-    return "";
-  }
-  output.resize(output_size);
+  // EVP_PKEY_size() is an upper bound of the signature size, which saves a
+  // separate call to find out the exact size.
+  std::string output(EVP_PKEY_size(private_key_.get()), '\0');
+  size_t output_size = output.size();
   if (!EVP_DigestSign(
           md_ctx.get(), reinterpret_cast<uint8_t*>(&output[0]), &output_size,
           reinterpret_cast<const uint8_t*>(input.data()), input.size())) {
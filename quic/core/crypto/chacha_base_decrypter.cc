@@ -26,19 +26,28 @@ bool ChaChaBaseDecrypter::SetHeaderProtectionKey(absl::string_view key) {
 
 std::string ChaChaBaseDecrypter::GenerateHeaderProtectionMask(
     QuicDataReader* sample_reader) {
+  QuicHeaderProtectionMask mask;
+  if (!GenerateHeaderProtectionMaskInto(sample_reader, &mask)) {
+    return std::string();
+  }
+  return std::string(mask.data(), mask.size());
+}
+
+bool ChaChaBaseDecrypter::GenerateHeaderProtectionMaskInto(
+    QuicDataReader* sample_reader,
+    QuicHeaderProtectionMask* mask) {
   absl::string_view sample;
   if (!sample_reader->ReadStringPiece(&sample, 16)) {
-    return std::string();
+    return false;
   }
   const uint8_t* nonce = reinterpret_cast<const uint8_t*>(sample.data()) + 4;
   uint32_t counter;
   QuicDataReader(sample.data(), 4, quiche::HOST_BYTE_ORDER)
       .ReadUInt32(&counter);
-  const uint8_t zeroes[] = {0, 0, 0, 0, 0};
-  std::string out(ABSL_ARRAYSIZE(zeroes), 0);
-  CRYPTO_chacha_20(reinterpret_cast<uint8_t*>(const_cast<char*>(out.data())),
-                   zeroes, ABSL_ARRAYSIZE(zeroes), pne_key_, nonce, counter);
-  return out;
+  const uint8_t zeroes[kHeaderProtectionMaskLength] = {};
+  CRYPTO_chacha_20(reinterpret_cast<uint8_t*>(mask->data()), zeroes,
+                   ABSL_ARRAYSIZE(zeroes), pne_key_, nonce, counter);
+  return true;
 }
 
 }  // namespace quic
@@ -20,6 +20,9 @@ class QUIC_EXPORT_PRIVATE ChaChaBaseDecrypter : public AeadBaseDecrypter {
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) override;
+  bool GenerateHeaderProtectionMaskInto(
+      QuicDataReader* sample_reader,
+      QuicHeaderProtectionMask* mask) override;
 
  private:
   // The key used for packet number encryption.
@@ -24,18 +24,27 @@ bool ChaChaBaseEncrypter::SetHeaderProtectionKey(absl::string_view key) {
 
 std::string ChaChaBaseEncrypter::GenerateHeaderProtectionMask(
     absl::string_view sample) {
-  if (sample.size() != 16) {
+  QuicHeaderProtectionMask mask;
+  if (!GenerateHeaderProtectionMaskInto(sample, &mask)) {
     return std::string();
   }
+  return std::string(mask.data(), mask.size());
+}
+
+bool ChaChaBaseEncrypter::GenerateHeaderProtectionMaskInto(
+    absl::string_view sample,
+    QuicHeaderProtectionMask* mask) {
+  if (sample.size() != 16) {
+    return false;
+  }
   const uint8_t* nonce = reinterpret_cast<const uint8_t*>(sample.data()) + 4;
   uint32_t counter;
   QuicDataReader(sample.data(), 4, quiche::HOST_BYTE_ORDER)
       .ReadUInt32(&counter);
-  const uint8_t zeroes[] = {0, 0, 0, 0, 0};
-  std::string out(ABSL_ARRAYSIZE(zeroes), 0);
-  CRYPTO_chacha_20(reinterpret_cast<uint8_t*>(const_cast<char*>(out.data())),
-                   zeroes, ABSL_ARRAYSIZE(zeroes), pne_key_, nonce, counter);
-  return out;
+  const uint8_t zeroes[kHeaderProtectionMaskLength] = {};
+  CRYPTO_chacha_20(reinterpret_cast<uint8_t*>(mask->data()), zeroes,
+                   ABSL_ARRAYSIZE(zeroes), pne_key_, nonce, counter);
+  return true;
 }
 
 }  // namespace quic
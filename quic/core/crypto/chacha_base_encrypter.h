@@ -19,6 +19,9 @@ class QUIC_EXPORT_PRIVATE ChaChaBaseEncrypter : public AeadBaseEncrypter {
 
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(absl::string_view sample) override;
+  bool GenerateHeaderProtectionMaskInto(
+      absl::string_view sample,
+      QuicHeaderProtectionMask* mask) override;
 
  private:
   // The key used for packet number encryption.
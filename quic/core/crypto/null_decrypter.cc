@@ -79,6 +79,13 @@ std::string NullDecrypter::GenerateHeaderProtectionMask(
   return std::string(5, 0);
 }
 
+bool NullDecrypter::GenerateHeaderProtectionMaskInto(
+    QuicDataReader* /*sample_reader*/,
+    QuicHeaderProtectionMask* mask) {
+  mask->fill(0);
+  return true;
+}
+
 size_t NullDecrypter::GetKeySize() const {
   return 0;
 }
@@ -43,6 +43,9 @@ class QUIC_EXPORT_PRIVATE NullDecrypter : public QuicDecrypter {
                      size_t max_output_length) override;
   std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) override;
+  bool GenerateHeaderProtectionMaskInto(
+      QuicDataReader* sample_reader,
+      QuicHeaderProtectionMask* mask) override;
   size_t GetKeySize() const override;
   size_t GetNoncePrefixSize() const override;
   size_t GetIVSize() const override;
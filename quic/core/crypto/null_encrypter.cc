@@ -64,6 +64,13 @@ std::string NullEncrypter::GenerateHeaderProtectionMask(
   return std::string(5, 0);
 }
 
+bool NullEncrypter::GenerateHeaderProtectionMaskInto(
+    absl::string_view /*sample*/,
+    QuicHeaderProtectionMask* mask) {
+  mask->fill(0);
+  return true;
+}
+
 size_t NullEncrypter::GetKeySize() const {
   return 0;
 }
@@ -36,6 +36,9 @@ class QUIC_EXPORT_PRIVATE NullEncrypter : public QuicEncrypter {
                      size_t* output_length,
                      size_t max_output_length) override;
   std::string GenerateHeaderProtectionMask(absl::string_view sample) override;
+  bool GenerateHeaderProtectionMaskInto(
+      absl::string_view sample,
+      QuicHeaderProtectionMask* mask) override;
   size_t GetKeySize() const override;
   size_t GetNoncePrefixSize() const override;
   size_t GetIVSize() const override;
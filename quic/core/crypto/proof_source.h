@@ -186,6 +186,13 @@ class QUIC_EXPORT_PRIVATE ProofSource {
 
     virtual void Run(std::vector<uint8_t> plaintext) = 0;
 
+    // Like Run(), but the session resumed from |plaintext| must not accept
+    // early data, e.g. because the ticket may have been replayed. Callbacks
+    // which cannot disable early data ignore the ticket instead.
+    virtual void RunWithoutEarlyData(std::vector<uint8_t> /*plaintext*/) {
+      Run(std::vector<uint8_t>());
+    }
+
    private:
     DecryptCallback(const Callback&) = delete;
     DecryptCallback& operator=(const Callback&) = delete;
@@ -220,7 +227,8 @@ class QUIC_EXPORT_PRIVATE ProofSource {
     // Decrypt takes an encrypted ticket |in|, decrypts it, and calls
     // |callback->Run| with the decrypted ticket, which must not be larger than
     // |in|. If decryption fails, the callback is invoked with an empty
-    // vector.
+    // vector. If the ticket is valid but must not be used for early data,
+    // |callback->RunWithoutEarlyData| is called instead.
     virtual void Decrypt(absl::string_view in,
                          std::unique_ptr<DecryptCallback> callback) = 0;
   };
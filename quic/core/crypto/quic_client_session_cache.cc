@@ -11,6 +11,7 @@ namespace quic {
 namespace {
 
 const size_t kDefaultMaxEntries = 1024;
+const size_t kDefaultMaxSessionsPerEntry = 2;
 // Returns false if the SSL |session| doesn't exist or it is expired at |now|.
 bool IsValid(SSL_SESSION* session, uint64_t now) {
   if (!session) return false;
@@ -36,7 +37,13 @@ QuicClientSessionCache::QuicClientSessionCache()
     : QuicClientSessionCache(kDefaultMaxEntries) {}
 
 QuicClientSessionCache::QuicClientSessionCache(size_t max_entries)
-    : cache_(max_entries) {}
+    : QuicClientSessionCache(max_entries, kDefaultMaxSessionsPerEntry) {}
+
+QuicClientSessionCache::QuicClientSessionCache(size_t max_entries,
+                                               size_t max_sessions_per_entry)
+    : max_sessions_per_entry_(max_sessions_per_entry), cache_(max_entries) {
+  QUICHE_DCHECK_GT(max_sessions_per_entry_, 0u);
+}
 
 QuicClientSessionCache::~QuicClientSessionCache() { Clear(); }
 
@@ -57,7 +64,7 @@ void QuicClientSessionCache::Insert(const QuicServerId& server_id,
   if (params == *iter->second->params &&
       DoApplicationStatesMatch(application_state,
                                iter->second->application_state.get())) {
-    iter->second->PushSession(std::move(session));
+    iter->second->PushSession(std::move(session), max_sessions_per_entry_);
     return;
   }
   // Erase the existing entry because this Insert call must come from a
@@ -138,7 +145,7 @@ void QuicClientSessionCache::CreateAndInsertEntry(
     const TransportParameters& params,
     const ApplicationState* application_state) {
   auto entry = std::make_unique<Entry>();
-  entry->PushSession(std::move(session));
+  entry->PushSession(std::move(session), max_sessions_per_entry_);
   entry->params = std::make_unique<TransportParameters>(params);
   if (application_state) {
     entry->application_state =
@@ -152,23 +159,22 @@ QuicClientSessionCache::Entry::Entry(Entry&&) = default;
 QuicClientSessionCache::Entry::~Entry() = default;
 
 void QuicClientSessionCache::Entry::PushSession(
-    bssl::UniquePtr<SSL_SESSION> session) {
-  if (sessions[0] != nullptr) {
-    sessions[1] = std::move(sessions[0]);
+    bssl::UniquePtr<SSL_SESSION> session, size_t max_sessions) {
+  sessions.push_front(std::move(session));
+  while (sessions.size() > max_sessions) {
+    sessions.pop_back();
   }
-  sessions[0] = std::move(session);
 }
 
 bssl::UniquePtr<SSL_SESSION> QuicClientSessionCache::Entry::PopSession() {
-  if (sessions[0] == nullptr) return nullptr;
-  bssl::UniquePtr<SSL_SESSION> session = std::move(sessions[0]);
-  sessions[0] = std::move(sessions[1]);
-  sessions[1] = nullptr;
+  if (sessions.empty()) return nullptr;
+  bssl::UniquePtr<SSL_SESSION> session = std::move(sessions.front());
+  sessions.pop_front();
   return session;
 }
 
 SSL_SESSION* QuicClientSessionCache::Entry::PeekSession() {
-  return sessions[0].get();
+  return sessions.empty() ? nullptr : sessions.front().get();
 }
 
 }  // namespace quic
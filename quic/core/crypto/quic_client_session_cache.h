@@ -7,6 +7,7 @@
 
 #include <memory>
 
+#include "common/quiche_circular_deque.h"
 #include "quic/core/crypto/quic_crypto_client_config.h"
 #include "quic/core/quic_lru_cache.h"
 #include "quic/core/quic_server_id.h"
@@ -18,11 +19,14 @@ class QuicClientSessionCachePeer;
 }  // namespace test
 
 // QuicClientSessionCache maps from QuicServerId to information used to resume
-// TLS sessions for that server.
+// TLS sessions for that server. Up to |max_sessions_per_entry| single-use
+// sessions are kept for each server. This class is not thread-safe, see
+// QuicConcurrentClientSessionCache for a version which is.
 class QUIC_EXPORT_PRIVATE QuicClientSessionCache : public SessionCache {
  public:
   QuicClientSessionCache();
   explicit QuicClientSessionCache(size_t max_entries);
+  QuicClientSessionCache(size_t max_entries, size_t max_sessions_per_entry);
   ~QuicClientSessionCache() override;
 
   void Insert(const QuicServerId& server_id,
@@ -53,16 +57,17 @@ class QUIC_EXPORT_PRIVATE QuicClientSessionCache : public SessionCache {
     Entry(Entry&&);
     ~Entry();
 
-    // Adds a new |session| onto sessions, dropping the oldest one if two are
-    // already stored.
-    void PushSession(bssl::UniquePtr<SSL_SESSION> session);
+    // Adds a new |session| onto sessions, dropping the oldest one if
+    // |max_sessions| are already stored.
+    void PushSession(bssl::UniquePtr<SSL_SESSION> session, size_t max_sessions);
 
     // Retrieves the latest session from the entry, meanwhile removing it.
     bssl::UniquePtr<SSL_SESSION> PopSession();
 
     SSL_SESSION* PeekSession();
 
-    bssl::UniquePtr<SSL_SESSION> sessions[2];
+    // Latest session first.
+    quiche::QuicheCircularDeque<bssl::UniquePtr<SSL_SESSION>> sessions;
     std::unique_ptr<TransportParameters> params;
     std::unique_ptr<ApplicationState> application_state;
     std::string token;  // An opaque string received in NEW_TOKEN frame.
@@ -74,6 +79,7 @@ class QUIC_EXPORT_PRIVATE QuicClientSessionCache : public SessionCache {
                             const TransportParameters& params,
                             const ApplicationState* application_state);
 
+  const size_t max_sessions_per_entry_;
   QuicLRUCache<QuicServerId, Entry, QuicServerIdHash> cache_;
 };
 
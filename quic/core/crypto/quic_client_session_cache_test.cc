@@ -253,6 +253,27 @@ TEST_F(QuicClientSessionCacheTest, MultipleSessions) {
   EXPECT_EQ(nullptr, cache.Lookup(id1, clock_.WallNow(), ssl_ctx_.get()));
 }
 
+TEST_F(QuicClientSessionCacheTest, MaxSessionsPerEntry) {
+  QuicClientSessionCache cache(/*max_entries=*/1024,
+                               /*max_sessions_per_entry=*/3);
+
+  auto params = MakeFakeTransportParams();
+  QuicServerId id1("a.com", 443);
+  std::vector<SSL_SESSION*> unowned_sessions;
+  for (int i = 0; i < 4; ++i) {
+    auto session = MakeTestSession();
+    unowned_sessions.push_back(session.get());
+    cache.Insert(id1, std::move(session), *params, nullptr);
+  }
+  // The three latest sessions are popped, latest first.
+  for (int i = 3; i > 0; --i) {
+    EXPECT_EQ(
+        unowned_sessions[i],
+        cache.Lookup(id1, clock_.WallNow(), ssl_ctx_.get())->tls_session.get());
+  }
+  EXPECT_EQ(nullptr, cache.Lookup(id1, clock_.WallNow(), ssl_ctx_.get()));
+}
+
 // Test that when a different TransportParameter is inserted for
 // the same server id, the existing entry is removed.
 TEST_F(QuicClientSessionCacheTest, DifferentTransportParams) {
@@ -0,0 +1,108 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/quic_concurrent_client_session_cache.h"
+
+#include <utility>
+
+namespace quic {
+
+namespace {
+
+const size_t kDefaultMaxEntries = 1024;
+const size_t kDefaultNumShards = 16;
+const size_t kDefaultMaxSessionsPerEntry = 4;
+
+}  // namespace
+
+QuicConcurrentClientSessionCache::Shard::Shard(size_t max_entries,
+                                               size_t max_sessions_per_entry)
+    : cache(max_entries, max_sessions_per_entry) {}
+
+QuicConcurrentClientSessionCache::QuicConcurrentClientSessionCache()
+    : QuicConcurrentClientSessionCache(kDefaultMaxEntries, kDefaultNumShards,
+                                       kDefaultMaxSessionsPerEntry) {}
+
+QuicConcurrentClientSessionCache::QuicConcurrentClientSessionCache(
+    size_t max_entries,
+    size_t num_shards,
+    size_t max_sessions_per_entry) {
+  QUICHE_DCHECK_GT(num_shards, 0u);
+  // Round up, so that the cache holds at least |max_entries| servers when they
+  // are evenly spread.
+  const size_t max_entries_per_shard =
+      (max_entries + num_shards - 1) / num_shards;
+  shards_.reserve(num_shards);
+  for (size_t i = 0; i < num_shards; ++i) {
+    shards_.push_back(
+        std::make_unique<Shard>(max_entries_per_shard, max_sessions_per_entry));
+  }
+}
+
+QuicConcurrentClientSessionCache::~QuicConcurrentClientSessionCache() = default;
+
+void QuicConcurrentClientSessionCache::Insert(
+    const QuicServerId& server_id,
+    bssl::UniquePtr<SSL_SESSION> session,
+    const TransportParameters& params,
+    const ApplicationState* application_state) {
+  Shard& shard = GetShard(server_id);
+  QuicWriterMutexLock lock(&shard.mutex);
+  shard.cache.Insert(server_id, std::move(session), params, application_state);
+}
+
+std::unique_ptr<QuicResumptionState> QuicConcurrentClientSessionCache::Lookup(
+    const QuicServerId& server_id, QuicWallTime now, const SSL_CTX* ctx) {
+  Shard& shard = GetShard(server_id);
+  // Sessions are single use, so even lookups modify the shard.
+  QuicWriterMutexLock lock(&shard.mutex);
+  return shard.cache.Lookup(server_id, now, ctx);
+}
+
+void QuicConcurrentClientSessionCache::ClearEarlyData(
+    const QuicServerId& server_id) {
+  Shard& shard = GetShard(server_id);
+  QuicWriterMutexLock lock(&shard.mutex);
+  shard.cache.ClearEarlyData(server_id);
+}
+
+void QuicConcurrentClientSessionCache::OnNewTokenReceived(
+    const QuicServerId& server_id, absl::string_view token) {
+  if (token.empty()) {
+    return;
+  }
+  Shard& shard = GetShard(server_id);
+  QuicWriterMutexLock lock(&shard.mutex);
+  shard.cache.OnNewTokenReceived(server_id, token);
+}
+
+void QuicConcurrentClientSessionCache::RemoveExpiredEntries(QuicWallTime now) {
+  for (const auto& shard : shards_) {
+    QuicWriterMutexLock lock(&shard->mutex);
+    shard->cache.RemoveExpiredEntries(now);
+  }
+}
+
+void QuicConcurrentClientSessionCache::Clear() {
+  for (const auto& shard : shards_) {
+    QuicWriterMutexLock lock(&shard->mutex);
+    shard->cache.Clear();
+  }
+}
+
+size_t QuicConcurrentClientSessionCache::size() const {
+  size_t size = 0;
+  for (const auto& shard : shards_) {
+    QuicReaderMutexLock lock(&shard->mutex);
+    size += shard->cache.size();
+  }
+  return size;
+}
+
+QuicConcurrentClientSessionCache::Shard&
+QuicConcurrentClientSessionCache::GetShard(const QuicServerId& server_id) {
+  return *shards_[QuicServerIdHash()(server_id) % shards_.size()];
+}
+
+}  // namespace quic
@@ -0,0 +1,71 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_QUIC_CONCURRENT_CLIENT_SESSION_CACHE_H_
+#define QUICHE_QUIC_CORE_CRYPTO_QUIC_CONCURRENT_CLIENT_SESSION_CACHE_H_
+
+#include <memory>
+#include <vector>
+
+#include "quic/core/crypto/quic_client_session_cache.h"
+#include "quic/core/crypto/quic_crypto_client_config.h"
+#include "quic/core/quic_server_id.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+// QuicConcurrentClientSessionCache is a thread-safe SessionCache which can be
+// shared by many client threads. Server IDs are spread over |num_shards|
+// independent QuicClientSessionCaches, each with its own lock and LRU list of
+// at most max_entries / num_shards servers, so that threads connecting to
+// different servers rarely contend. Up to |max_sessions_per_entry| single-use
+// sessions are kept per server, so that several threads can resume sessions
+// to the same server at once.
+class QUIC_EXPORT_PRIVATE QuicConcurrentClientSessionCache
+    : public SessionCache {
+ public:
+  QuicConcurrentClientSessionCache();
+  QuicConcurrentClientSessionCache(size_t max_entries,
+                                   size_t num_shards,
+                                   size_t max_sessions_per_entry);
+  QuicConcurrentClientSessionCache(const QuicConcurrentClientSessionCache&) =
+      delete;
+  QuicConcurrentClientSessionCache& operator=(
+      const QuicConcurrentClientSessionCache&) = delete;
+  ~QuicConcurrentClientSessionCache() override;
+
+  // SessionCache implementation.
+  void Insert(const QuicServerId& server_id,
+              bssl::UniquePtr<SSL_SESSION> session,
+              const TransportParameters& params,
+              const ApplicationState* application_state) override;
+  std::unique_ptr<QuicResumptionState> Lookup(const QuicServerId& server_id,
+                                              QuicWallTime now,
+                                              const SSL_CTX* ctx) override;
+  void ClearEarlyData(const QuicServerId& server_id) override;
+  void OnNewTokenReceived(const QuicServerId& server_id,
+                          absl::string_view token) override;
+  void RemoveExpiredEntries(QuicWallTime now) override;
+  void Clear() override;
+
+  // Number of servers with cached sessions.
+  size_t size() const;
+
+ private:
+  struct QUIC_EXPORT_PRIVATE Shard {
+    Shard(size_t max_entries, size_t max_sessions_per_entry);
+
+    mutable QuicMutex mutex;
+    QuicClientSessionCache cache QUIC_GUARDED_BY(mutex);
+  };
+
+  Shard& GetShard(const QuicServerId& server_id);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_QUIC_CONCURRENT_CLIENT_SESSION_CACHE_H_
@@ -0,0 +1,158 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/quic_concurrent_client_session_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/platform/api/quic_thread.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const QuicTime::Delta kTimeout = QuicTime::Delta::FromSeconds(1000);
+
+class QuicConcurrentClientSessionCacheTest : public QuicTest {
+ public:
+  QuicConcurrentClientSessionCacheTest()
+      : ssl_ctx_(SSL_CTX_new(TLS_method())) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  }
+
+ protected:
+  bssl::UniquePtr<SSL_SESSION> MakeTestSession() {
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ssl_ctx_.get()));
+    SSL_SESSION_set_time(session.get(), clock_.WallNow().ToUNIXSeconds());
+    SSL_SESSION_set_timeout(session.get(), kTimeout.ToSeconds());
+    return session;
+  }
+
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  MockClock clock_;
+  TransportParameters params_;
+};
+
+TEST_F(QuicConcurrentClientSessionCacheTest, SingleUseSessions) {
+  QuicConcurrentClientSessionCache cache(/*max_entries=*/16, /*num_shards=*/4,
+                                         /*max_sessions_per_entry=*/4);
+  QuicServerId id("a.com", 443);
+  EXPECT_EQ(nullptr, cache.Lookup(id, clock_.WallNow(), ssl_ctx_.get()));
+
+  std::vector<SSL_SESSION*> unowned_sessions;
+  for (int i = 0; i < 4; ++i) {
+    bssl::UniquePtr<SSL_SESSION> session = MakeTestSession();
+    unowned_sessions.push_back(session.get());
+    cache.Insert(id, std::move(session), params_, nullptr);
+  }
+  EXPECT_EQ(1u, cache.size());
+
+  for (int i = 3; i >= 0; --i) {
+    std::unique_ptr<QuicResumptionState> state =
+        cache.Lookup(id, clock_.WallNow(), ssl_ctx_.get());
+    ASSERT_TRUE(state != nullptr);
+    EXPECT_EQ(unowned_sessions[i], state->tls_session.get());
+  }
+  EXPECT_EQ(nullptr, cache.Lookup(id, clock_.WallNow(), ssl_ctx_.get()));
+}
+
+TEST_F(QuicConcurrentClientSessionCacheTest, SizeLimit) {
+  QuicConcurrentClientSessionCache cache(/*max_entries=*/8, /*num_shards=*/4,
+                                         /*max_sessions_per_entry=*/1);
+  for (int i = 0; i < 100; ++i) {
+    cache.Insert(QuicServerId(absl::StrCat("host", i, ".com"), 443),
+                 MakeTestSession(), params_, nullptr);
+  }
+  // Each shard holds up to two servers.
+  EXPECT_LE(cache.size(), 8u);
+  EXPECT_GT(cache.size(), 0u);
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST_F(QuicConcurrentClientSessionCacheTest, RemoveExpiredEntries) {
+  QuicConcurrentClientSessionCache cache;
+  cache.Insert(QuicServerId("a.com", 443), MakeTestSession(), params_,
+               nullptr);
+  cache.Insert(QuicServerId("b.com", 443), MakeTestSession(), params_,
+               nullptr);
+  EXPECT_EQ(2u, cache.size());
+
+  clock_.AdvanceTime(kTimeout * 2);
+  cache.RemoveExpiredEntries(clock_.WallNow());
+  EXPECT_EQ(0u, cache.size());
+}
+
+// Stands in for a proxy with many threads connecting to the same upstreams.
+class ResumingThread : public QuicThread {
+ public:
+  ResumingThread(QuicConcurrentClientSessionCache* cache,
+                 SSL_CTX* ssl_ctx,
+                 QuicWallTime now,
+                 int thread_index,
+                 std::atomic<int>* num_resumed)
+      : QuicThread(absl::StrCat("ResumingThread", thread_index)),
+        cache_(cache),
+        ssl_ctx_(ssl_ctx),
+        now_(now),
+        thread_index_(thread_index),
+        num_resumed_(num_resumed) {}
+
+  void Run() override {
+    for (int i = 0; i < kNumConnections; ++i) {
+      QuicServerId id(absl::StrCat("upstream", (thread_index_ + i) % 8, ".com"),
+                      443);
+      bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ssl_ctx_));
+      SSL_SESSION_set_time(session.get(), now_.ToUNIXSeconds());
+      SSL_SESSION_set_timeout(session.get(), kTimeout.ToSeconds());
+      cache_->Insert(id, std::move(session), TransportParameters(), nullptr);
+      if (cache_->Lookup(id, now_, ssl_ctx_) != nullptr) {
+        ++*num_resumed_;
+      }
+    }
+  }
+
+  static const int kNumConnections = 200;
+
+ private:
+  QuicConcurrentClientSessionCache* cache_;
+  SSL_CTX* ssl_ctx_;
+  const QuicWallTime now_;
+  const int thread_index_;
+  std::atomic<int>* num_resumed_;
+};
+
+TEST_F(QuicConcurrentClientSessionCacheTest, ManyThreads) {
+  const int kNumThreads = 32;
+  // Room for one session per thread, so that none is dropped.
+  QuicConcurrentClientSessionCache cache(
+      /*max_entries=*/1024, /*num_shards=*/16,
+      /*max_sessions_per_entry=*/kNumThreads);
+  std::atomic<int> num_resumed(0);
+  std::vector<std::unique_ptr<ResumingThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<ResumingThread>(
+        &cache, ssl_ctx_.get(), clock_.WallNow(), i, &num_resumed));
+  }
+  for (const auto& thread : threads) {
+    thread->Start();
+  }
+  for (const auto& thread : threads) {
+    thread->Join();
+  }
+  // Every thread inserts a session before looking one up, so each lookup finds
+  // a session even when another thread took the one it just inserted.
+  EXPECT_EQ(kNumThreads * ResumingThread::kNumConnections, num_resumed.load());
+  EXPECT_EQ(8u, cache.size());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
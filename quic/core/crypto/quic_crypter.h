@@ -5,12 +5,23 @@
 #ifndef QUICHE_QUIC_CORE_CRYPTO_QUIC_CRYPTER_H_
 #define QUICHE_QUIC_CORE_CRYPTO_QUIC_CRYPTER_H_
 
+#include <array>
+#include <cstddef>
+
 #include "absl/strings/string_view.h"
 #include "quic/core/quic_versions.h"
 #include "quic/platform/api/quic_export.h"
 
 namespace quic {
 
+// Number of bytes of a header protection mask which are applied to a packet:
+// one for the first byte and up to four for the packet number.
+const size_t kHeaderProtectionMaskLength = 5;
+
+// The applied part of a header protection mask, see
+// QuicEncrypter::GenerateHeaderProtectionMaskInto().
+using QuicHeaderProtectionMask = std::array<char, kHeaderProtectionMaskLength>;
+
 // QuicCrypter is the parent class for QuicEncrypter and QuicDecrypter.
 // Its purpose is to provide an interface for using methods that are common to
 // both classes when operations are being done that apply to both encrypters and
@@ -4,6 +4,7 @@
 
 #include "quic/core/crypto/quic_decrypter.h"
 
+#include <cstring>
 #include <string>
 #include <utility>
 
@@ -77,4 +78,15 @@ void QuicDecrypter::DiversifyPreliminaryKey(absl::string_view preliminary_key,
   *out_nonce_prefix = std::string(hkdf.server_write_iv());
 }
 
+bool QuicDecrypter::GenerateHeaderProtectionMaskInto(
+    QuicDataReader* sample_reader,
+    QuicHeaderProtectionMask* mask) {
+  std::string out = GenerateHeaderProtectionMask(sample_reader);
+  if (out.size() < mask->size()) {
+    return false;
+  }
+  memcpy(mask->data(), out.data(), mask->size());
+  return true;
+}
+
 }  // namespace quic
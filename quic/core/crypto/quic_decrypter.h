@@ -69,6 +69,15 @@ class QUIC_EXPORT_PRIVATE QuicDecrypter : public QuicCrypter {
   virtual std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) = 0;
 
+  // Same as GenerateHeaderProtectionMask(), but writes the first
+  // kHeaderProtectionMaskLength bytes of the mask to |mask| instead of
+  // returning a string. Returns false on failure. The default implementation
+  // calls GenerateHeaderProtectionMask(); subclasses override it to avoid the
+  // allocation.
+  virtual bool GenerateHeaderProtectionMaskInto(
+      QuicDataReader* sample_reader,
+      QuicHeaderProtectionMask* mask);
+
   // The ID of the cipher. Return 0x03000000 ORed with the 'cryptographic suite
   // selector'.
   virtual uint32_t cipher_id() const = 0;
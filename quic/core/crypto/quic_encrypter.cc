@@ -4,6 +4,8 @@
 
 #include "quic/core/crypto/quic_encrypter.h"
 
+#include <cstring>
+#include <string>
 #include <utility>
 
 #include "third_party/boringssl/src/include/openssl/tls1.h"
@@ -58,4 +60,15 @@ std::unique_ptr<QuicEncrypter> QuicEncrypter::CreateFromCipherSuite(
   }
 }
 
+bool QuicEncrypter::GenerateHeaderProtectionMaskInto(
+    absl::string_view sample,
+    QuicHeaderProtectionMask* mask) {
+  std::string out = GenerateHeaderProtectionMask(sample);
+  if (out.size() < mask->size()) {
+    return false;
+  }
+  memcpy(mask->data(), out.data(), mask->size());
+  return true;
+}
+
 }  // namespace quic
@@ -49,6 +49,15 @@ class QUIC_EXPORT_PRIVATE QuicEncrypter : public QuicCrypter {
   virtual std::string GenerateHeaderProtectionMask(
       absl::string_view sample) = 0;
 
+  // Same as GenerateHeaderProtectionMask(), but writes the first
+  // kHeaderProtectionMaskLength bytes of the mask to |mask| instead of
+  // returning a string. Returns false on failure. The default implementation
+  // calls GenerateHeaderProtectionMask(); subclasses override it to avoid the
+  // allocation.
+  virtual bool GenerateHeaderProtectionMaskInto(
+      absl::string_view sample,
+      QuicHeaderProtectionMask* mask);
+
   // Returns the maximum length of plaintext that can be encrypted
   // to ciphertext no larger than |ciphertext_size|.
   virtual size_t GetMaxPlaintextSize(size_t ciphertext_size) const = 0;
@@ -0,0 +1,166 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/tls_cert_compressor.h"
+
+#include <memory>
+#include <string>
+
+#include "third_party/boringssl/src/include/openssl/bytestring.h"
+#include "third_party/boringssl/src/include/openssl/pool.h"
+#include "quic/core/quic_lru_cache.h"
+#include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_logging.h"
+#include "quic/platform/api/quic_mutex.h"
+#include "third_party/zlib/zlib.h"
+
+namespace quic {
+
+namespace {
+
+// Codepoint for zlib from RFC 8879, section 3.
+const uint16_t kZlibCertCompressionAlgorithm = 1;
+
+// Number of distinct Certificate messages kept compressed.
+const size_t kCompressedCertificateCacheSize = 64;
+
+// Decompression bombs are bounded by the length the peer claims, so refuse
+// claims well above any plausible certificate chain.
+const size_t kMaxUncompressedCertificateLength = 128 * 1024;
+
+// Process-wide, as the same chain is typically served by every SSL_CTX and
+// every thread of a server.
+class CompressedCertificateCache {
+ public:
+  static CompressedCertificateCache* GetInstance() {
+    static CompressedCertificateCache* instance =
+        new CompressedCertificateCache();
+    return instance;
+  }
+
+  // Returns the cached compressed form of |certificate_message|, if any.
+  absl::optional<std::string> Lookup(absl::string_view certificate_message) {
+    QuicWriterMutexLock lock(&mutex_);
+    auto it = cache_.Lookup(std::string(certificate_message));
+    if (it == cache_.end()) {
+      return absl::nullopt;
+    }
+    return *it->second;
+  }
+
+  void Insert(absl::string_view certificate_message, std::string compressed) {
+    QuicWriterMutexLock lock(&mutex_);
+    cache_.Insert(std::string(certificate_message),
+                  std::make_unique<std::string>(std::move(compressed)));
+  }
+
+ private:
+  CompressedCertificateCache() : cache_(kCompressedCertificateCacheSize) {}
+
+  QuicMutex mutex_;
+  // Keyed by the uncompressed Certificate message.
+  QuicLRUCache<std::string, std::string> cache_ QUIC_GUARDED_BY(mutex_);
+};
+
+bool IsPlausibleUncompressedLength(size_t length) {
+  return length > 0 && length <= kMaxUncompressedCertificateLength;
+}
+
+bool DecompressInto(absl::string_view compressed,
+                    uint8_t* out,
+                    size_t out_length) {
+  uLongf decompressed_length = out_length;
+  return uncompress(out, &decompressed_length,
+                    reinterpret_cast<const Bytef*>(compressed.data()),
+                    compressed.size()) == Z_OK &&
+         decompressed_length == out_length;
+}
+
+}  // namespace
+
+// static
+void TlsCertCompressor::ConfigureSslCtx(SSL_CTX* ssl_ctx) {
+  if (!SSL_CTX_add_cert_compression_alg(ssl_ctx, kZlibCertCompressionAlgorithm,
+                                        &CompressCallback,
+                                        &DecompressCallback)) {
+    QUIC_BUG(quic_bug_tls_cert_compression_registration_failed)
+        << "Failed to register certificate compression";
+  }
+}
+
+// static
+std::string TlsCertCompressor::Compress(absl::string_view certificate_message) {
+  CompressedCertificateCache* cache = CompressedCertificateCache::GetInstance();
+  absl::optional<std::string> cached = cache->Lookup(certificate_message);
+  if (cached.has_value()) {
+    return *std::move(cached);
+  }
+
+  uLongf compressed_length = compressBound(certificate_message.size());
+  std::string compressed(compressed_length, '\0');
+  // Chains are compressed once and sent many times, so spend the extra time.
+  if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_length,
+                reinterpret_cast<const Bytef*>(certificate_message.data()),
+                certificate_message.size(), Z_BEST_COMPRESSION) != Z_OK) {
+    QUIC_LOG_FIRST_N(ERROR, 1) << "Failed to compress certificate message";
+    return std::string();
+  }
+  compressed.resize(compressed_length);
+  cache->Insert(certificate_message, compressed);
+  return compressed;
+}
+
+// static
+absl::optional<std::string> TlsCertCompressor::Decompress(
+    absl::string_view compressed, size_t uncompressed_length) {
+  if (!IsPlausibleUncompressedLength(uncompressed_length)) {
+    return absl::nullopt;
+  }
+  std::string uncompressed(uncompressed_length, '\0');
+  if (!DecompressInto(compressed, reinterpret_cast<uint8_t*>(&uncompressed[0]),
+                      uncompressed_length)) {
+    return absl::nullopt;
+  }
+  return uncompressed;
+}
+
+// static
+int TlsCertCompressor::CompressCallback(SSL* /*ssl*/,
+                                        CBB* out,
+                                        const uint8_t* in,
+                                        size_t in_len) {
+  std::string compressed =
+      Compress(absl::string_view(reinterpret_cast<const char*>(in), in_len));
+  // BoringSSL fails the handshake if this does.
+  if (compressed.empty()) {
+    return 0;
+  }
+  return CBB_add_bytes(out, reinterpret_cast<const uint8_t*>(compressed.data()),
+                       compressed.size());
+}
+
+// static
+int TlsCertCompressor::DecompressCallback(SSL* /*ssl*/,
+                                          CRYPTO_BUFFER** out,
+                                          size_t uncompressed_len,
+                                          const uint8_t* in,
+                                          size_t in_len) {
+  if (!IsPlausibleUncompressedLength(uncompressed_len)) {
+    return 0;
+  }
+  // Decompress straight into the buffer handed to BoringSSL.
+  uint8_t* data;
+  bssl::UniquePtr<CRYPTO_BUFFER> buffer(
+      CRYPTO_BUFFER_alloc(&data, uncompressed_len));
+  if (buffer == nullptr ||
+      !DecompressInto(
+          absl::string_view(reinterpret_cast<const char*>(in), in_len), data,
+          uncompressed_len)) {
+    return 0;
+  }
+  *out = buffer.release();
+  return 1;
+}
+
+}  // namespace quic
@@ -0,0 +1,48 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSOR_H_
+#define QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSOR_H_
+
+#include <cstddef>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// TlsCertCompressor implements zlib certificate compression for TLS 1.3, as
+// defined in RFC 8879. A server usually sends the same few certificate chains
+// in every handshake, so compressed Certificate messages are cached by their
+// contents and each chain is only compressed once per process.
+class QUIC_EXPORT_PRIVATE TlsCertCompressor {
+ public:
+  // Offers, or accepts, zlib certificate compression on connections created
+  // from |ssl_ctx|.
+  static void ConfigureSslCtx(SSL_CTX* ssl_ctx);
+
+  // Returns the zlib-compressed form of |certificate_message|, or an empty
+  // string on failure.
+  static std::string Compress(absl::string_view certificate_message);
+
+  // Returns nullopt unless |compressed| decompresses to exactly
+  // |uncompressed_length| bytes.
+  static absl::optional<std::string> Decompress(absl::string_view compressed,
+                                                size_t uncompressed_length);
+
+ private:
+  // BoringSSL callbacks registered by ConfigureSslCtx().
+  static int CompressCallback(SSL* ssl, CBB* out, const uint8_t* in,
+                              size_t in_len);
+  static int DecompressCallback(SSL* ssl, CRYPTO_BUFFER** out,
+                                size_t uncompressed_len, const uint8_t* in,
+                                size_t in_len);
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSOR_H_
@@ -0,0 +1,71 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/crypto/tls_cert_compressor.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/test_certificates.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class TlsCertCompressorTest : public QuicTest {};
+
+TEST_F(TlsCertCompressorTest, RoundTrip) {
+  // A Certificate message with the same certificate twice compresses well.
+  const std::string message =
+      absl::StrCat(kTestCertificate, kTestCertificate);
+  const std::string compressed = TlsCertCompressor::Compress(message);
+  ASSERT_FALSE(compressed.empty());
+  EXPECT_LT(compressed.size(), message.size() * 2 / 3);
+
+  absl::optional<std::string> decompressed =
+      TlsCertCompressor::Decompress(compressed, message.size());
+  ASSERT_TRUE(decompressed.has_value());
+  EXPECT_EQ(message, *decompressed);
+}
+
+TEST_F(TlsCertCompressorTest, Cached) {
+  const std::string message(kWildcardCertificate);
+  const std::string compressed = TlsCertCompressor::Compress(message);
+  ASSERT_FALSE(compressed.empty());
+  EXPECT_EQ(compressed, TlsCertCompressor::Compress(message));
+
+  // A different message must not be served from the cache.
+  const std::string other_message = absl::StrCat(message, "x");
+  const std::string other_compressed =
+      TlsCertCompressor::Compress(other_message);
+  EXPECT_NE(compressed, other_compressed);
+  EXPECT_EQ(other_message, TlsCertCompressor::Decompress(
+                               other_compressed, other_message.size()));
+}
+
+TEST_F(TlsCertCompressorTest, BadInput) {
+  const std::string message(kTestCertificate);
+  const std::string compressed = TlsCertCompressor::Compress(message);
+  ASSERT_FALSE(compressed.empty());
+
+  // Wrong uncompressed length.
+  EXPECT_FALSE(TlsCertCompressor::Decompress(compressed, message.size() - 1)
+                   .has_value());
+  EXPECT_FALSE(TlsCertCompressor::Decompress(compressed, message.size() + 1)
+                   .has_value());
+  EXPECT_FALSE(TlsCertCompressor::Decompress(compressed, 0).has_value());
+  EXPECT_FALSE(
+      TlsCertCompressor::Decompress(compressed, 1024 * 1024).has_value());
+  // Truncated or corrupted input.
+  EXPECT_FALSE(TlsCertCompressor::Decompress(
+                   compressed.substr(0, compressed.size() / 2), message.size())
+                   .has_value());
+  EXPECT_FALSE(
+      TlsCertCompressor::Decompress("not zlib", message.size()).has_value());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
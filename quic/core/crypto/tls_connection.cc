@@ -6,7 +6,10 @@
 
 #include "absl/strings/string_view.h"
 #include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/core/crypto/tls_cert_compressor.h"
 #include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_flag_utils.h"
+#include "quic/platform/api/quic_flags.h"
 
 namespace quic {
 
@@ -127,6 +130,10 @@ bssl::UniquePtr<SSL_CTX> TlsConnection::CreateSslCtx() {
   SSL_CTX_set_min_proto_version(ssl_ctx.get(), TLS1_3_VERSION);
   SSL_CTX_set_max_proto_version(ssl_ctx.get(), TLS1_3_VERSION);
   SSL_CTX_set_quic_method(ssl_ctx.get(), &kSslQuicMethod);
+  if (GetQuicReloadableFlag(quic_tls_cert_compression)) {
+    QUIC_RELOADABLE_FLAG_COUNT(quic_tls_cert_compression);
+    TlsCertCompressor::ConfigureSslCtx(ssl_ctx.get());
+  }
   return ssl_ctx;
 }
 
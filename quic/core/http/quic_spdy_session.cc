@@ -20,6 +20,7 @@
 #include "quic/core/http/http_frames.h"
 #include "quic/core/http/quic_headers_stream.h"
 #include "quic/core/http/web_transport_http3.h"
+#include "quic/core/qpack/qpack_encoder_insertion_policy.h"
 #include "quic/core/quic_error_codes.h"
 #include "quic/core/quic_types.h"
 #include "quic/core/quic_utils.h"
@@ -442,6 +443,7 @@ QuicSpdySession::QuicSpdySession(
       qpack_maximum_dynamic_table_capacity_(
           kDefaultQpackMaxDynamicTableCapacity),
       qpack_maximum_blocked_streams_(kDefaultMaximumBlockedStreams),
+      qpack_encoder_dictionary_(nullptr),
       max_inbound_header_list_size_(kDefaultMaxUncompressedHeaderSize),
       max_outbound_header_list_size_(std::numeric_limits<size_t>::max()),
       stream_id_(
@@ -491,6 +493,12 @@ void QuicSpdySession::Initialize() {
     ActivateStream(std::move(headers_stream));
   } else {
     qpack_encoder_ = std::make_unique<QpackEncoder>(this);
+    qpack_encoder_->set_dictionary(qpack_encoder_dictionary_);
+    if (GetQuicReloadableFlag(quic_qpack_cost_model_insertion_policy)) {
+      QUIC_RELOADABLE_FLAG_COUNT(quic_qpack_cost_model_insertion_policy);
+      qpack_encoder_->set_insertion_policy(
+          std::make_unique<QpackCostModelInsertionPolicy>());
+    }
     qpack_decoder_ =
         std::make_unique<QpackDecoder>(qpack_maximum_dynamic_table_capacity_,
                                        qpack_maximum_blocked_streams_, this);
@@ -276,6 +276,14 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
         qpack_maximum_dynamic_table_capacity;
   }
 
+  // Header fields to insert into the QPACK encoder dynamic table once the peer
+  // allows a large enough capacity.  |dictionary| may be shared by sessions
+  // and must outlive this object.
+  // Must not be called after Initialize().
+  void set_qpack_encoder_dictionary(const QpackEncoderDictionary* dictionary) {
+    qpack_encoder_dictionary_ = dictionary;
+  }
+
   // Must not be called after Initialize().
   // TODO(bnc): Move to constructor argument.
   void set_qpack_maximum_blocked_streams(
@@ -621,6 +629,9 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession
   // SETTINGS_QPACK_BLOCKED_STREAMS.
   uint64_t qpack_maximum_blocked_streams_;
 
+  // Not owned.  May be null.
+  const QpackEncoderDictionary* qpack_encoder_dictionary_;
+
   // The maximum size of a header block that will be accepted from the peer,
   // defined per spec as key + value + overhead per field (uncompressed).
   // Value will be sent via SETTINGS_MAX_HEADER_LIST_SIZE.
@@ -577,7 +577,17 @@ void QuicSpdyStream::OnHeadersDecoded(QuicHeaderList headers,
       debug_visitor->OnHeadersDecoded(id(), headers);
     }
 
-    OnStreamHeaderList(/* fin = */ false, headers_payload_length_, headers);
+    if (!headers_decompressed_ &&
+        GetQuicReloadableFlag(quic_move_decoded_headers_into_stream)) {
+      QUIC_RELOADABLE_FLAG_COUNT(quic_move_decoded_headers_into_stream);
+      // Take ownership of the decoded header list instead of copying it in
+      // OnInitialHeadersComplete().
+      header_list_ = std::move(headers);
+      OnStreamHeaderList(/* fin = */ false, headers_payload_length_,
+                         header_list_);
+    } else {
+      OnStreamHeaderList(/* fin = */ false, headers_payload_length_, headers);
+    }
   } else {
     spdy_session_->OnHeaderList(headers);
   }
@@ -625,7 +635,9 @@ void QuicSpdyStream::OnInitialHeadersComplete(
     bool fin, size_t /*frame_len*/, const QuicHeaderList& header_list) {
   // TODO(b/134706391): remove |fin| argument.
   headers_decompressed_ = true;
-  header_list_ = header_list;
+  if (&header_list != &header_list_) {
+    header_list_ = header_list;
+  }
   bool header_too_large = VersionUsesHttp3(transport_version())
                               ? header_list_size_limit_exceeded_
                               : header_list.empty();
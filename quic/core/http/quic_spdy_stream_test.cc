@@ -2062,6 +2062,37 @@ TEST_P(QuicSpdyStreamTest, HeadersFrameOnRequestStream) {
               ElementsAre(Pair("custom-key", "custom-value")));
 }
 
+// Regression test for moving decoded headers into the stream's header list:
+// sizes travel with the header fields, and trailers are not affected.
+TEST_P(QuicSpdyStreamTest, HeadersFrameMovedIntoHeaderList) {
+  if (!UsesHttp3()) {
+    return;
+  }
+
+  SetQuicReloadableFlag(quic_move_decoded_headers_into_stream, true);
+  Initialize(kShouldProcessData);
+
+  std::string headers = HeadersFrame({std::make_pair("foo", "bar")});
+  std::string data = DataFrame(kDataFramePayload);
+  std::string trailers =
+      HeadersFrame({std::make_pair("custom-key", "custom-value")});
+
+  std::string stream_frame_payload = absl::StrCat(headers, data, trailers);
+  QuicStreamFrame frame(stream_->id(), false, 0, stream_frame_payload);
+  stream_->OnStreamFrame(frame);
+
+  EXPECT_THAT(stream_->header_list(), ElementsAre(Pair("foo", "bar")));
+  EXPECT_LT(0u, stream_->header_list().compressed_header_bytes());
+  EXPECT_LT(0u, stream_->header_list().uncompressed_header_bytes());
+
+  stream_->ConsumeHeaderList();
+  EXPECT_TRUE(stream_->header_list().empty());
+  EXPECT_EQ(kDataFramePayload, stream_->data());
+
+  EXPECT_THAT(stream_->received_trailers(),
+              ElementsAre(Pair("custom-key", "custom-value")));
+}
+
 TEST_P(QuicSpdyStreamTest, ProcessBodyAfterTrailers) {
   if (!UsesHttp3()) {
     return;
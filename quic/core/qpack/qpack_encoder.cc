@@ -37,7 +37,8 @@ QpackEncoder::QpackEncoder(
     : decoder_stream_error_delegate_(decoder_stream_error_delegate),
       decoder_stream_receiver_(this),
       maximum_blocked_streams_(0),
-      header_list_count_(0) {
+      header_list_count_(0),
+      dictionary_(nullptr) {
   QUICHE_DCHECK(decoder_stream_error_delegate_);
 }
 
@@ -77,6 +78,13 @@ QpackEncoder::Representation QpackEncoder::EncodeLiteralHeaderField(
   return Representation::LiteralHeaderField(name, value);
 }
 
+bool QpackEncoder::ShouldInsert(absl::string_view name,
+                                absl::string_view value,
+                                bool name_match) {
+  return insertion_policy_ == nullptr ||
+         insertion_policy_->ShouldInsert(name, value, name_match);
+}
+
 QpackEncoder::Representations QpackEncoder::FirstPassEncode(
     QuicStreamId stream_id,
     const spdy::Http2HeaderBlock& header_list,
@@ -121,6 +129,12 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
     auto match_type =
         header_table_.FindHeaderField(name, value, &is_static, &index);
 
+    // Whether inserting the header field is worth it, if it is allowed.
+    const bool should_insert =
+        match_type != QpackEncoderHeaderTable::MatchType::kNameAndValue &&
+        ShouldInsert(name, value,
+                     match_type == QpackEncoderHeaderTable::MatchType::kName);
+
     switch (match_type) {
       case QpackEncoderHeaderTable::MatchType::kNameAndValue:
         if (is_static) {
@@ -177,7 +191,7 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
 
       case QpackEncoderHeaderTable::MatchType::kName:
         if (is_static) {
-          if (blocking_allowed &&
+          if (should_insert && blocking_allowed &&
               QpackEntry::Size(name, value) <=
                   header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
                       smallest_blocking_index)) {
@@ -200,26 +214,28 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
           break;
         }
 
-        if (!blocking_allowed) {
-          blocked_stream_limit_exhausted = true;
-        } else if (QpackEntry::Size(name, value) >
-                   header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
-                       std::min(smallest_blocking_index, index))) {
-          dynamic_table_insertion_blocked = true;
-        } else {
-          // If allowed, insert entry with name reference and refer to it.
-          encoder_stream_sender_.SendInsertWithNameReference(
-              is_static,
-              QpackAbsoluteIndexToEncoderStreamRelativeIndex(
-                  index, header_table_.inserted_entry_count()),
-              value);
-          uint64_t new_index = header_table_.InsertEntry(name, value);
-          representations.push_back(
-              EncodeIndexedHeaderField(is_static, new_index, referred_indices));
-          smallest_blocking_index = std::min(smallest_blocking_index, index);
-          header_table_.set_dynamic_table_entry_referenced();
+        if (should_insert) {
+          if (!blocking_allowed) {
+            blocked_stream_limit_exhausted = true;
+          } else if (QpackEntry::Size(name, value) >
+                     header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
+                         std::min(smallest_blocking_index, index))) {
+            dynamic_table_insertion_blocked = true;
+          } else {
+            // If allowed, insert entry with name reference and refer to it.
+            encoder_stream_sender_.SendInsertWithNameReference(
+                is_static,
+                QpackAbsoluteIndexToEncoderStreamRelativeIndex(
+                    index, header_table_.inserted_entry_count()),
+                value);
+            uint64_t new_index = header_table_.InsertEntry(name, value);
+            representations.push_back(EncodeIndexedHeaderField(
+                is_static, new_index, referred_indices));
+            smallest_blocking_index = std::min(smallest_blocking_index, index);
+            header_table_.set_dynamic_table_entry_referenced();
 
-          break;
+            break;
+          }
         }
 
         if ((blocking_allowed || index < known_received_count) &&
@@ -244,21 +260,23 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
 
       case QpackEncoderHeaderTable::MatchType::kNoMatch:
         // If allowed, insert entry and refer to it.
-        if (!blocking_allowed) {
-          blocked_stream_limit_exhausted = true;
-        } else if (QpackEntry::Size(name, value) >
-                   header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
-                       smallest_blocking_index)) {
-          dynamic_table_insertion_blocked = true;
-        } else {
-          encoder_stream_sender_.SendInsertWithoutNameReference(name, value);
-          uint64_t new_index = header_table_.InsertEntry(name, value);
-          representations.push_back(EncodeIndexedHeaderField(
-              /* is_static = */ false, new_index, referred_indices));
-          smallest_blocking_index =
-              std::min<uint64_t>(smallest_blocking_index, new_index);
+        if (should_insert) {
+          if (!blocking_allowed) {
+            blocked_stream_limit_exhausted = true;
+          } else if (QpackEntry::Size(name, value) >
+                     header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
+                         smallest_blocking_index)) {
+            dynamic_table_insertion_blocked = true;
+          } else {
+            encoder_stream_sender_.SendInsertWithoutNameReference(name, value);
+            uint64_t new_index = header_table_.InsertEntry(name, value);
+            representations.push_back(EncodeIndexedHeaderField(
+                /* is_static = */ false, new_index, referred_indices));
+            smallest_blocking_index =
+                std::min<uint64_t>(smallest_blocking_index, new_index);
 
-          break;
+            break;
+          }
         }
 
         // Encode entry as string literals.
@@ -391,6 +409,32 @@ void QpackEncoder::SetDynamicTableCapacity(uint64_t dynamic_table_capacity) {
 
   bool success = header_table_.SetDynamicTableCapacity(dynamic_table_capacity);
   QUICHE_DCHECK(success);
+
+  MaybeInsertDictionary();
+}
+
+void QpackEncoder::set_qpack_stream_sender_delegate(
+    QpackStreamSenderDelegate* delegate) {
+  encoder_stream_sender_.set_qpack_stream_sender_delegate(delegate);
+  MaybeInsertDictionary();
+}
+
+void QpackEncoder::MaybeInsertDictionary() {
+  if (dictionary_ == nullptr || dictionary_->entries().empty() ||
+      !encoder_stream_sender_.has_delegate() ||
+      header_table_.inserted_entry_count() > 0 ||
+      dictionary_->size() > header_table_.dynamic_table_capacity()) {
+    return;
+  }
+  QUIC_CODE_COUNT(quic_qpack_encoder_dictionary_inserted);
+  encoder_stream_sender_.SendSerializedInstructions(
+      dictionary_->encoder_stream_instructions());
+  for (const auto& entry : dictionary_->entries()) {
+    header_table_.InsertEntry(entry.first, entry.second);
+  }
+  // Send the insertions right away, so that the decoder can acknowledge them
+  // before header lists refer to them.
+  encoder_stream_sender_.Flush();
 }
 
 bool QpackEncoder::SetMaximumBlockedStreams(uint64_t maximum_blocked_streams) {
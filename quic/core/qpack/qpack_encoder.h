@@ -8,11 +8,14 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/string_view.h"
 #include "quic/core/qpack/qpack_blocking_manager.h"
 #include "quic/core/qpack/qpack_decoder_stream_receiver.h"
+#include "quic/core/qpack/qpack_encoder_dictionary.h"
+#include "quic/core/qpack/qpack_encoder_insertion_policy.h"
 #include "quic/core/qpack/qpack_encoder_stream_sender.h"
 #include "quic/core/qpack/qpack_header_table.h"
 #include "quic/core/qpack/qpack_instructions.h"
@@ -67,8 +70,26 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
   // Set dynamic table capacity to |dynamic_table_capacity|.
   // |dynamic_table_capacity| must not exceed maximum dynamic table capacity.
   // Also sends Set Dynamic Table Capacity instruction on encoder stream.
+  // If a dictionary is set, the dynamic table is empty, all entries of the
+  // dictionary fit, and the encoder stream exists, also inserts them and
+  // flushes the encoder stream.
   void SetDynamicTableCapacity(uint64_t dynamic_table_capacity);
 
+  // Set entries to insert into the dynamic table once both its capacity and
+  // the encoder stream sender delegate are set.  Must be called before
+  // SetDynamicTableCapacity() to have any effect.
+  // |dictionary| must outlive this object.
+  void set_dictionary(const QpackEncoderDictionary* dictionary) {
+    dictionary_ = dictionary;
+  }
+
+  // Set policy deciding which header fields to insert into the dynamic table.
+  // If not set, header fields are inserted whenever allowed.
+  void set_insertion_policy(
+      std::unique_ptr<QpackEncoderInsertionPolicy> insertion_policy) {
+    insertion_policy_ = std::move(insertion_policy);
+  }
+
   // Set maximum number of blocked streams.
   // Called when SETTINGS_QPACK_BLOCKED_STREAMS is received.
   // Returns true if |maximum_blocked_streams| doesn't decrease current value.
@@ -83,9 +104,9 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
                        absl::string_view error_message) override;
 
   // delegate must be set if dynamic table capacity is not zero.
-  void set_qpack_stream_sender_delegate(QpackStreamSenderDelegate* delegate) {
-    encoder_stream_sender_.set_qpack_stream_sender_delegate(delegate);
-  }
+  // Inserts the dictionary, if any, if it is not inserted yet and the dynamic
+  // table capacity is already set.
+  void set_qpack_stream_sender_delegate(QpackStreamSenderDelegate* delegate);
 
   QpackStreamReceiver* decoder_stream_receiver() {
     return &decoder_stream_receiver_;
@@ -127,6 +148,12 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
   static Representation EncodeLiteralHeaderField(absl::string_view name,
                                                  absl::string_view value);
 
+  // Returns true if |insertion_policy_| is not set or agrees to inserting the
+  // header field.
+  bool ShouldInsert(absl::string_view name,
+                    absl::string_view value,
+                    bool name_match);
+
   // Performs first pass of two-pass encoding: represent each header field in
   // |*header_list| as a reference to an existing entry, the name of an existing
   // entry with a literal value, or a literal name and value pair.  Sends
@@ -150,6 +177,11 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
   std::string SecondPassEncode(Representations representations,
                                uint64_t required_insert_count) const;
 
+  // Inserts |dictionary_| into the dynamic table and sends the insertions on
+  // the encoder stream, if the dictionary is not inserted yet, fits into the
+  // dynamic table capacity, and the encoder stream sender delegate is set.
+  void MaybeInsertDictionary();
+
   DecoderStreamErrorDelegate* const decoder_stream_error_delegate_;
   QpackDecoderStreamReceiver decoder_stream_receiver_;
   QpackEncoderStreamSender encoder_stream_sender_;
@@ -157,6 +189,10 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
   uint64_t maximum_blocked_streams_;
   QpackBlockingManager blocking_manager_;
   int header_list_count_;
+  // Not owned.  May be null.
+  const QpackEncoderDictionary* dictionary_;
+  // May be null.
+  std::unique_ptr<QpackEncoderInsertionPolicy> insertion_policy_;
 };
 
 }  // namespace quic
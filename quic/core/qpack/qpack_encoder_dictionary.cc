@@ -0,0 +1,59 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/qpack/qpack_encoder_dictionary.h"
+
+#include "quic/core/qpack/qpack_header_table.h"
+#include "quic/core/qpack/qpack_index_conversions.h"
+#include "quic/core/qpack/qpack_instruction_encoder.h"
+#include "quic/core/qpack/qpack_instructions.h"
+
+namespace quic {
+
+QpackEncoderDictionary::QpackEncoderDictionary(
+    const std::vector<HeaderField>& header_fields)
+    : size_(0) {
+  uint64_t capacity = 0;
+  for (const HeaderField& header_field : header_fields) {
+    capacity += QpackEntry::Size(header_field.first, header_field.second);
+  }
+
+  // Replay the insertions on a header table large enough to hold all of them,
+  // to find the entries whose names can be referred to.
+  QpackEncoderHeaderTable header_table;
+  header_table.SetMaximumDynamicTableCapacity(capacity);
+  header_table.SetDynamicTableCapacity(capacity);
+  QpackInstructionEncoder instruction_encoder;
+
+  for (const HeaderField& header_field : header_fields) {
+    const absl::string_view name = header_field.first;
+    const absl::string_view value = header_field.second;
+    bool is_static;
+    uint64_t index;
+    switch (header_table.FindHeaderField(name, value, &is_static, &index)) {
+      case QpackEncoderHeaderTable::MatchType::kNameAndValue:
+        continue;
+      case QpackEncoderHeaderTable::MatchType::kName:
+        if (!is_static) {
+          index = QpackAbsoluteIndexToEncoderStreamRelativeIndex(
+              index, header_table.inserted_entry_count());
+        }
+        instruction_encoder.Encode(
+            QpackInstructionWithValues::InsertWithNameReference(is_static,
+                                                                index, value),
+            &encoder_stream_instructions_);
+        break;
+      case QpackEncoderHeaderTable::MatchType::kNoMatch:
+        instruction_encoder.Encode(
+            QpackInstructionWithValues::InsertWithoutNameReference(name, value),
+            &encoder_stream_instructions_);
+        break;
+    }
+    header_table.InsertEntry(name, value);
+    entries_.push_back(header_field);
+    size_ += QpackEntry::Size(name, value);
+  }
+}
+
+}  // namespace quic
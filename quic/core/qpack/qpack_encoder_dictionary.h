@@ -0,0 +1,57 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_DICTIONARY_H_
+#define QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_DICTIONARY_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// A list of header fields, such as common response headers, that QpackEncoder
+// inserts into an empty dynamic table as soon as the dynamic table capacity
+// allows, so that even the first header lists on a connection can refer to
+// them.  The encoder stream instructions inserting the fields are computed
+// once, so a single immutable instance can be shared by all connections.
+class QUIC_EXPORT_PRIVATE QpackEncoderDictionary {
+ public:
+  using HeaderField = std::pair<std::string, std::string>;
+
+  // Header fields that are in the static table, or that appear more than
+  // once, are left out.  Names are referred to in the static table or in
+  // earlier entries when possible, and strings are Huffman encoded when that
+  // makes them shorter, as QpackEncoder does.
+  explicit QpackEncoderDictionary(
+      const std::vector<HeaderField>& header_fields);
+
+  QpackEncoderDictionary(const QpackEncoderDictionary&) = delete;
+  QpackEncoderDictionary& operator=(const QpackEncoderDictionary&) = delete;
+
+  // Entries to insert into the dynamic table, in order.
+  const std::vector<HeaderField>& entries() const { return entries_; }
+
+  // Encoder stream instructions inserting entries() into an empty dynamic
+  // table.
+  absl::string_view encoder_stream_instructions() const {
+    return encoder_stream_instructions_;
+  }
+
+  // Dynamic table capacity needed to hold all entries().
+  uint64_t size() const { return size_; }
+
+ private:
+  std::vector<HeaderField> entries_;
+  std::string encoder_stream_instructions_;
+  uint64_t size_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_DICTIONARY_H_
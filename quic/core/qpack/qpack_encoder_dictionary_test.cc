@@ -0,0 +1,51 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/qpack/qpack_encoder_dictionary.h"
+
+#include "absl/strings/escaping.h"
+#include "quic/core/qpack/qpack_header_table.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+using HeaderField = QpackEncoderDictionary::HeaderField;
+
+TEST(QpackEncoderDictionaryTest, Empty) {
+  QpackEncoderDictionary dictionary({});
+  EXPECT_TRUE(dictionary.entries().empty());
+  EXPECT_TRUE(dictionary.encoder_stream_instructions().empty());
+  EXPECT_EQ(0u, dictionary.size());
+}
+
+TEST(QpackEncoderDictionaryTest, Instructions) {
+  QpackEncoderDictionary dictionary({{"foo", "bar"},
+                                     {":method", "GET"},
+                                     {"foo", "baz"},
+                                     {"cookie", "baz"},
+                                     {"foo", "bar"}});
+
+  // The static table entry and the repeated field are left out.
+  EXPECT_EQ(std::vector<HeaderField>(
+                {{"foo", "bar"}, {"foo", "baz"}, {"cookie", "baz"}}),
+            dictionary.entries());
+  EXPECT_EQ(absl::HexStringToBytes(
+                "62"          // insert without name reference
+                "94e7"        // Huffman-encoded name "foo"
+                "03626172"    // value "bar"
+                "80"          // insert with name reference, dynamic index 0
+                "0362617a"    // value "baz"
+                "c5"          // insert with name reference, static index 5
+                "0362617a"),  // value "baz"
+            dictionary.encoder_stream_instructions());
+  EXPECT_EQ(QpackEntry::Size("foo", "bar") + QpackEntry::Size("foo", "baz") +
+                QpackEntry::Size("cookie", "baz"),
+            dictionary.size());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
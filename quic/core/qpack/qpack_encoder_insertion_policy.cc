@@ -0,0 +1,112 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/qpack/qpack_encoder_insertion_policy.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "absl/hash/hash.h"
+
+namespace quic {
+
+namespace {
+
+// Number of calls to QpackHeaderFieldFrequencySketch::Record() after which all
+// counts are halved.
+const uint32_t kHalvingPeriod = 2048;
+
+// Approximate size in bytes of a header block representation referring to a
+// dynamic table entry.
+const uint64_t kReferenceSize = 2;
+
+// Bytes an insertion is required to save in the future to make up for the risk
+// of blocking the stream that refers to the new entry until the insertion is
+// acknowledged.
+const uint64_t kBlockingCost = 16;
+
+}  // anonymous namespace
+
+QpackHeaderFieldFrequencySketch::QpackHeaderFieldFrequencySketch()
+    : counters_{}, record_count_(0) {}
+
+uint32_t QpackHeaderFieldFrequencySketch::Record(absl::string_view name,
+                                                 absl::string_view value) {
+  size_t indices[kDepth];
+  GetIndices(name, value, indices);
+
+  uint16_t estimate = std::numeric_limits<uint16_t>::max();
+  for (size_t row = 0; row < kDepth; ++row) {
+    estimate = std::min(estimate, counters_[row][indices[row]]);
+  }
+
+  // Conservative update: only increment counters that equal the estimate,
+  // which reduces overestimation caused by collisions.
+  if (estimate < std::numeric_limits<uint16_t>::max()) {
+    for (size_t row = 0; row < kDepth; ++row) {
+      if (counters_[row][indices[row]] == estimate) {
+        ++counters_[row][indices[row]];
+      }
+    }
+  }
+
+  if (++record_count_ == kHalvingPeriod) {
+    for (auto& row : counters_) {
+      for (uint16_t& counter : row) {
+        counter /= 2;
+      }
+    }
+    record_count_ = 0;
+  }
+
+  return estimate;
+}
+
+uint32_t QpackHeaderFieldFrequencySketch::Estimate(
+    absl::string_view name, absl::string_view value) const {
+  size_t indices[kDepth];
+  GetIndices(name, value, indices);
+
+  uint16_t estimate = std::numeric_limits<uint16_t>::max();
+  for (size_t row = 0; row < kDepth; ++row) {
+    estimate = std::min(estimate, counters_[row][indices[row]]);
+  }
+  return estimate;
+}
+
+void QpackHeaderFieldFrequencySketch::GetIndices(absl::string_view name,
+                                                 absl::string_view value,
+                                                 size_t indices[kDepth]) const {
+  // Derive one index for each row from two halves of a single hash, see
+  // Kirsch and Mitzenmacher, "Less Hashing, Same Performance".
+  const uint64_t hash = absl::HashOf(name, value);
+  const uint32_t hash1 = static_cast<uint32_t>(hash);
+  const uint32_t hash2 = static_cast<uint32_t>(hash >> 32) | 1;
+  for (size_t row = 0; row < kDepth; ++row) {
+    indices[row] = (hash1 + row * hash2) % kWidth;
+  }
+}
+
+bool QpackCostModelInsertionPolicy::ShouldInsert(absl::string_view name,
+                                                 absl::string_view value,
+                                                 bool name_match) {
+  // Assume that a header field that has been seen n times before is going to
+  // be seen n more times.
+  const uint64_t expected_reference_count = sketch_.Record(name, value);
+
+  // A literal representation costs the strings not found in the table, plus
+  // some overhead, in every header block.  After insertion, a reference costs
+  // only the overhead.
+  const uint64_t saving_per_reference =
+      value.size() + (name_match ? 0 : name.size());
+
+  // The insert instruction on the encoder stream costs about as much as the
+  // literal representation it replaces in the current header block, which in
+  // turn refers to the new entry.
+  const uint64_t insertion_cost = kReferenceSize + kBlockingCost;
+
+  return expected_reference_count * saving_per_reference >= insertion_cost;
+}
+
+}  // namespace quic
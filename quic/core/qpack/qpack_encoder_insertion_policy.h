@@ -0,0 +1,87 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_INSERTION_POLICY_H_
+#define QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_INSERTION_POLICY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Interface deciding whether QpackEncoder inserts a header field into the
+// dynamic table.  QpackEncoder only asks about header fields that do not match
+// an existing entry, and only inserts them if the policy agrees AND the
+// insertion is allowed by the blocked stream limit and by the entries that must
+// not be evicted.  Without a policy, QpackEncoder inserts whenever allowed.
+// An instance holds per-connection state, and must not be shared between
+// encoders.
+class QUIC_EXPORT_PRIVATE QpackEncoderInsertionPolicy {
+ public:
+  virtual ~QpackEncoderInsertionPolicy() = default;
+
+  // Called once for each header field that could be inserted.  |name_match| is
+  // true if the name of a static or dynamic table entry can be referred to,
+  // both by the insert instruction and by a literal representation.  Returns
+  // true if the header field should be inserted.
+  virtual bool ShouldInsert(absl::string_view name,
+                            absl::string_view value,
+                            bool name_match) = 0;
+};
+
+// Count-min sketch approximating the number of times each header field has been
+// seen.  Estimates are never lower than the actual count, but can be higher
+// because of hash collisions.  All counts are halved periodically, so that
+// estimates reflect recent header fields.
+class QUIC_EXPORT_PRIVATE QpackHeaderFieldFrequencySketch {
+ public:
+  QpackHeaderFieldFrequencySketch();
+
+  // Increments the count of the header field and returns its estimated count
+  // before the increment.
+  uint32_t Record(absl::string_view name, absl::string_view value);
+
+  // Returns the estimated count of the header field.
+  uint32_t Estimate(absl::string_view name, absl::string_view value) const;
+
+ private:
+  static constexpr size_t kDepth = 4;
+  static constexpr size_t kWidth = 128;
+
+  // Computes the counter index into each row for the header field.
+  void GetIndices(absl::string_view name,
+                  absl::string_view value,
+                  size_t indices[kDepth]) const;
+
+  uint16_t counters_[kDepth][kWidth];
+  // Number of calls to Record() since counts were last halved.
+  uint32_t record_count_;
+};
+
+// Insertion policy weighing the encoder stream bytes an insertion costs against
+// the header block bytes expected to be saved by referring to the new entry
+// instead of encoding the header field as a literal.  The number of future
+// references is estimated from how many times the header field has been seen
+// on the connection.
+class QUIC_EXPORT_PRIVATE QpackCostModelInsertionPolicy
+    : public QpackEncoderInsertionPolicy {
+ public:
+  QpackCostModelInsertionPolicy() = default;
+  ~QpackCostModelInsertionPolicy() override = default;
+
+  // QpackEncoderInsertionPolicy implementation.
+  bool ShouldInsert(absl::string_view name,
+                    absl::string_view value,
+                    bool name_match) override;
+
+ private:
+  QpackHeaderFieldFrequencySketch sketch_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_INSERTION_POLICY_H_
@@ -0,0 +1,89 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/qpack/qpack_encoder_insertion_policy.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+TEST(QpackHeaderFieldFrequencySketchTest, Record) {
+  QpackHeaderFieldFrequencySketch sketch;
+  EXPECT_EQ(0u, sketch.Estimate("foo", "bar"));
+
+  EXPECT_EQ(0u, sketch.Record("foo", "bar"));
+  EXPECT_EQ(1u, sketch.Record("foo", "bar"));
+  EXPECT_EQ(2u, sketch.Record("foo", "bar"));
+  EXPECT_EQ(3u, sketch.Estimate("foo", "bar"));
+
+  // Name and value are hashed separately.
+  EXPECT_EQ(0u, sketch.Record("foob", "ar"));
+  EXPECT_EQ(3u, sketch.Estimate("foo", "bar"));
+}
+
+TEST(QpackHeaderFieldFrequencySketchTest, NeverUnderestimates) {
+  QpackHeaderFieldFrequencySketch sketch;
+  // Record many more distinct header fields than there are counters in a row.
+  for (int i = 0; i < 300; ++i) {
+    for (int j = 0; j <= i % 4; ++j) {
+      sketch.Record("name", absl::StrCat(i));
+    }
+  }
+  for (int i = 0; i < 300; ++i) {
+    EXPECT_LE(static_cast<uint32_t>(i % 4 + 1),
+              sketch.Estimate("name", absl::StrCat(i)));
+  }
+}
+
+TEST(QpackHeaderFieldFrequencySketchTest, Halving) {
+  QpackHeaderFieldFrequencySketch sketch;
+  for (int i = 0; i < 10; ++i) {
+    sketch.Record("foo", "bar");
+  }
+  EXPECT_EQ(10u, sketch.Estimate("foo", "bar"));
+
+  // Counts are halved after 2048 calls to Record().
+  for (int i = 10; i < 2047; ++i) {
+    sketch.Record("baz", "qux");
+  }
+  EXPECT_EQ(10u, sketch.Estimate("foo", "bar"));
+  sketch.Record("baz", "qux");
+  EXPECT_EQ(5u, sketch.Estimate("foo", "bar"));
+}
+
+TEST(QpackCostModelInsertionPolicyTest, InsertRepeatedHeaderFields) {
+  QpackCostModelInsertionPolicy policy;
+  const std::string value(20, 'a');
+
+  // A header field seen for the first time is not inserted.
+  EXPECT_FALSE(policy.ShouldInsert("foo", value, /* name_match = */ false));
+  // Saving 23 bytes once makes up for the cost of insertion.
+  EXPECT_TRUE(policy.ShouldInsert("foo", value, /* name_match = */ false));
+}
+
+TEST(QpackCostModelInsertionPolicyTest, ShortValue) {
+  QpackCostModelInsertionPolicy policy;
+
+  // Saving three bytes is only worth it after seeing the header field six
+  // times.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_FALSE(policy.ShouldInsert("foo", "bar", /* name_match = */ true));
+  }
+  EXPECT_TRUE(policy.ShouldInsert("foo", "bar", /* name_match = */ true));
+
+  // The name contributes to the saving if it has to be encoded as a literal.
+  EXPECT_FALSE(policy.ShouldInsert("bar", "baz", /* name_match = */ false));
+  EXPECT_FALSE(policy.ShouldInsert("bar", "baz", /* name_match = */ false));
+  EXPECT_FALSE(policy.ShouldInsert("bar", "baz", /* name_match = */ false));
+  EXPECT_TRUE(policy.ShouldInsert("bar", "baz", /* name_match = */ false));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -38,6 +38,9 @@ class QUIC_EXPORT_PRIVATE QpackEncoderStreamSender {
   // 5.2.4. Set Dynamic Table Capacity
   void SendSetDynamicTableCapacity(uint64_t capacity);
 
+  // Buffers already serialized |instructions|.
+  void SendSerializedInstructions(absl::string_view instructions);
+
   // Returns number of buffered bytes.
   QuicByteCount BufferedByteCount() const { return buffer_.size(); }
 
@@ -48,6 +51,7 @@ class QUIC_EXPORT_PRIVATE QpackEncoderStreamSender {
   void set_qpack_stream_sender_delegate(QpackStreamSenderDelegate* delegate) {
     delegate_ = delegate;
   }
+  bool has_delegate() const { return delegate_ != nullptr; }
 
  private:
   QpackStreamSenderDelegate* delegate_;
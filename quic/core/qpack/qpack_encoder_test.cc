@@ -5,7 +5,9 @@
 #include "quic/core/qpack/qpack_encoder.h"
 
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
@@ -18,12 +20,23 @@
 
 using ::testing::_;
 using ::testing::Eq;
+using ::testing::Return;
 using ::testing::StrictMock;
 
 namespace quic {
 namespace test {
 namespace {
 
+class MockInsertionPolicy : public QpackEncoderInsertionPolicy {
+ public:
+  MOCK_METHOD(bool,
+              ShouldInsert,
+              (absl::string_view name,
+               absl::string_view value,
+               bool name_match),
+              (override));
+};
+
 class QpackEncoderTest : public QuicTest {
  protected:
   QpackEncoderTest()
@@ -467,6 +480,109 @@ TEST_F(QpackEncoderTest, DynamicTableCapacityLessThanMaximum) {
   EXPECT_EQ(30u, header_table->dynamic_table_capacity());
 }
 
+TEST_F(QpackEncoderTest, Dictionary) {
+  QpackEncoderDictionary dictionary(
+      {{"foo", "bar"}, {"foo", "baz"}, {"cookie", "baz"}});
+  encoder_.set_dictionary(&dictionary);
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+
+  // The dictionary is inserted along with the Set Dynamic Table Capacity
+  // instruction, before any header list is encoded.
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(absl::StrCat(
+                  absl::HexStringToBytes("3fe11f"),
+                  dictionary.encoder_stream_instructions()))));
+  encoder_.SetDynamicTableCapacity(4096);
+
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+  header_list.AppendValueOrAddHeader("foo", "baz");
+  header_list["cookie"] = "baz";
+
+  // The header list refers to the dictionary entries, and nothing more is sent
+  // on the encoder stream.
+  EXPECT_EQ(absl::HexStringToBytes(
+                "0400"      // prefix
+                "828180"),  // dynamic entries with relative index 0, 1, and 2
+            Encode(header_list));
+  EXPECT_EQ(0u, encoder_stream_sent_byte_count_);
+}
+
+TEST_F(QpackEncoderTest, DictionaryInsertedWhenEncoderStreamIsCreated) {
+  QpackEncoderDictionary dictionary(
+      {{"foo", "bar"}, {"foo", "baz"}, {"cookie", "baz"}});
+  QpackEncoder encoder(&decoder_stream_error_delegate_);
+  encoder.set_dictionary(&dictionary);
+  encoder.SetMaximumDynamicTableCapacity(4096);
+
+  // Capacity is set, for example from cached settings, before the encoder
+  // stream exists.  Nothing is inserted or written yet.
+  encoder.SetDynamicTableCapacity(4096);
+  EXPECT_EQ(0u,
+            QpackEncoderPeer::header_table(&encoder)->inserted_entry_count());
+
+  // Once the encoder stream exists, the buffered Set Dynamic Table Capacity
+  // instruction is sent together with the dictionary.
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(absl::StrCat(
+                  absl::HexStringToBytes("3fe11f"),
+                  dictionary.encoder_stream_instructions()))));
+  encoder.set_qpack_stream_sender_delegate(&encoder_stream_sender_delegate_);
+  EXPECT_EQ(3u,
+            QpackEncoderPeer::header_table(&encoder)->inserted_entry_count());
+}
+
+TEST_F(QpackEncoderTest, DictionaryDoesNotFit) {
+  QpackEncoderDictionary dictionary(
+      {{"foo", "bar"}, {"foo", "baz"}, {"cookie", "baz"}});
+  encoder_.set_dictionary(&dictionary);
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(dictionary.size() - 1);
+
+  EXPECT_EQ(0u, QpackEncoderPeer::header_table(&encoder_)
+                    ->inserted_entry_count());
+}
+
+TEST_F(QpackEncoderTest, InsertionPolicy) {
+  auto insertion_policy = std::make_unique<StrictMock<MockInsertionPolicy>>();
+  EXPECT_CALL(*insertion_policy, ShouldInsert(Eq("foo"), Eq("bar"), false))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*insertion_policy, ShouldInsert(Eq("foo"), Eq("baz"), true))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*insertion_policy, ShouldInsert(Eq("cookie"), Eq("baz"), true))
+      .WillOnce(Return(false));
+  encoder_.set_insertion_policy(std::move(insertion_policy));
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(4096);
+
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+  header_list.AppendValueOrAddHeader("foo", "baz");
+  header_list["cookie"] = "baz";
+
+  // Set Dynamic Table Capacity instruction.
+  std::string set_dyanamic_table_capacity = absl::HexStringToBytes("3fe11f");
+  // Insert only the entry the insertion policy agrees to.
+  std::string insert_entries = absl::HexStringToBytes(
+      "62"         // insert without name reference
+      "94e7"       // Huffman-encoded name "foo"
+      "03626172");  // value "bar"
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(
+                  absl::StrCat(set_dyanamic_table_capacity, insert_entries))));
+
+  EXPECT_EQ(absl::HexStringToBytes(
+                "0200"         // prefix
+                "80"           // dynamic entry with relative index 0
+                "40"           // literal with name reference, dynamic index 0
+                "0362617a"     // value "baz"
+                "55"           // literal with name reference, static index 5
+                "0362617a"),  // value "baz"
+            Encode(header_list));
+
+  EXPECT_EQ(insert_entries.size(), encoder_stream_sent_byte_count_);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -18,10 +18,14 @@ uint64_t QpackEncoderHeaderTable::InsertEntry(absl::string_view name,
                                               absl::string_view value) {
   const uint64_t index =
       QpackHeaderTableBase<QpackEncoderDynamicTable>::InsertEntry(name, value);
+  AddToIndices(dynamic_entries().back(), index);
+  return index;
+}
 
-  // Make name and value point to the new entry.
-  name = dynamic_entries().back().name();
-  value = dynamic_entries().back().value();
+void QpackEncoderHeaderTable::AddToIndices(const QpackEntry& entry,
+                                           uint64_t index) {
+  const absl::string_view name = entry.name();
+  const absl::string_view value = entry.value();
 
   auto index_result = dynamic_index_.insert(
       std::make_pair(QpackLookupEntry{name, value}, index));
@@ -46,8 +50,6 @@ uint64_t QpackEncoderHeaderTable::InsertEntry(absl::string_view name,
     auto result = dynamic_name_index_.insert({name, index});
     QUICHE_CHECK(result.second);
   }
-
-  return index;
 }
 
 QpackEncoderHeaderTable::MatchType QpackEncoderHeaderTable::FindHeaderField(
@@ -165,6 +167,17 @@ void QpackEncoderHeaderTable::RemoveEntryFromEnd() {
   QpackHeaderTableBase<QpackEncoderDynamicTable>::RemoveEntryFromEnd();
 }
 
+void QpackEncoderHeaderTable::OnDynamicEntriesMoved() {
+  // Keys of both maps point to the old buffer.
+  dynamic_index_.clear();
+  dynamic_name_index_.clear();
+  uint64_t index = dropped_entry_count();
+  for (const auto& entry : dynamic_entries()) {
+    AddToIndices(entry, index);
+    ++index;
+  }
+}
+
 QpackDecoderHeaderTable::QpackDecoderHeaderTable()
     : static_entries_(ObtainQpackStaticTable().GetStaticEntries()) {}
 
@@ -6,12 +6,13 @@
 #define QUICHE_QUIC_CORE_QPACK_QPACK_HEADER_TABLE_H_
 
 #include <cstdint>
-#include <deque>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "quic/platform/api/quic_export.h"
 #include "common/quiche_circular_deque.h"
 #include "spdy/core/hpack/hpack_entry.h"
+#include "spdy/core/hpack/hpack_entry_ring_buffer.h"
 #include "spdy/core/hpack/hpack_header_table.h"
 
 namespace quic {
@@ -20,13 +21,13 @@ using QpackEntry = spdy::HpackEntry;
 using QpackLookupEntry = spdy::HpackLookupEntry;
 constexpr size_t kQpackEntrySizeOverhead = spdy::kHpackEntrySizeOverhead;
 
-// Encoder needs pointer stability for |dynamic_index_| and
-// |dynamic_name_index_|.  However, it does not need random access.
-// TODO(b/182349990): Change to a more memory efficient container.
-using QpackEncoderDynamicTable = std::deque<QpackEntry>;
-
-// Decoder needs random access for LookupEntry().
-// However, it does not need pointer stability.
+// Names and values of dynamic entries are stored in an HpackEntryRingBuffer,
+// where they do not move until the entry is evicted, so the encoder can keep
+// |dynamic_index_| and |dynamic_name_index_| pointing to them.  Capacity for
+// as many entries as fit in the dynamic table is reserved, so that entries do
+// not move either, as LookupEntry() promises.  Both only move when the dynamic
+// table capacity is increased.
+using QpackEncoderDynamicTable = quiche::QuicheCircularDeque<QpackEntry>;
 using QpackDecoderDynamicTable = quiche::QuicheCircularDeque<QpackEntry>;
 
 // This is a base class for encoder and decoder classes that manage the QPACK
@@ -49,11 +50,9 @@ class QUIC_EXPORT_PRIVATE QpackHeaderTableBase {
                                      absl::string_view value) const;
 
   // Inserts (name, value) into the dynamic table.  Entry must not be larger
-  // than the capacity of the dynamic table.  May evict entries.  |name| and
-  // |value| are copied first, therefore it is safe for them to point to an
-  // entry in the dynamic table, even if it is about to be evicted, or even if
-  // the underlying container might move entries around when resizing for
-  // insertion.
+  // than the capacity of the dynamic table.  May evict entries.  It is safe for
+  // |name| and |value| to point to an entry in the dynamic table, even if it is
+  // about to be evicted.
   // Returns the absolute index of the inserted dynamic table entry.
   virtual uint64_t InsertEntry(absl::string_view name, absl::string_view value);
 
@@ -100,6 +99,9 @@ class QUIC_EXPORT_PRIVATE QpackHeaderTableBase {
   // |dynamic_table_size_| and |dropped_entry_count_|.
   virtual void RemoveEntryFromEnd();
 
+  // Called after the dynamic entries moved to a larger |entry_buffer_|.
+  virtual void OnDynamicEntriesMoved() {}
+
   const DynamicEntryTable& dynamic_entries() const { return dynamic_entries_; }
 
  private:
@@ -107,9 +109,19 @@ class QUIC_EXPORT_PRIVATE QpackHeaderTableBase {
   // to |capacity|.
   void EvictDownToCapacity(uint64_t capacity);
 
-  // Dynamic Table entries.
+  // Moves the dynamic entries to a new |entry_buffer_| that can hold a table of
+  // |dynamic_table_capacity_|.
+  void GrowEntryBuffer();
+
+  // Dynamic Table entries.  Their names and values point into
+  // |entry_buffer_|.
   DynamicEntryTable dynamic_entries_;
 
+  // Owns the names and values of |dynamic_entries_|.  Sized for the largest
+  // |dynamic_table_capacity_| so far, which is bounded by our own limits rather
+  // than what the peer advertises.
+  spdy::HpackEntryRingBuffer entry_buffer_;
+
   // Size of the dynamic table.  This is the sum of the size of its entries.
   uint64_t dynamic_table_size_;
 
@@ -162,16 +174,14 @@ uint64_t QpackHeaderTableBase<DynamicEntryTable>::InsertEntry(
 
   const uint64_t index = dropped_entry_count_ + dynamic_entries_.size();
 
-  // Copy name and value before modifying the container, because evicting
-  // entries or even inserting a new one might invalidate |name| or |value| if
-  // they point to an entry.
-  QpackEntry new_entry((std::string(name)), (std::string(value)));
-  const size_t entry_size = new_entry.Size();
+  // |entry_buffer_| copies |name| and |value| if they point to an entry,
+  // because they might be overwritten once that entry is evicted.
+  const size_t entry_size = QpackEntry::Size(name, value);
 
   EvictDownToCapacity(dynamic_table_capacity_ - entry_size);
 
   dynamic_table_size_ += entry_size;
-  dynamic_entries_.push_back(std::move(new_entry));
+  dynamic_entries_.push_back(entry_buffer_.Add(name, value));
 
   return index;
 }
@@ -185,6 +195,9 @@ bool QpackHeaderTableBase<DynamicEntryTable>::SetDynamicTableCapacity(
 
   dynamic_table_capacity_ = capacity;
   EvictDownToCapacity(capacity);
+  if (capacity > entry_buffer_.max_table_size()) {
+    GrowEntryBuffer();
+  }
 
   QUICHE_DCHECK_LE(dynamic_table_size_, dynamic_table_capacity_);
 
@@ -209,6 +222,7 @@ void QpackHeaderTableBase<DynamicEntryTable>::RemoveEntryFromEnd() {
   QUICHE_DCHECK_GE(dynamic_table_size_, entry_size);
   dynamic_table_size_ -= entry_size;
 
+  entry_buffer_.RemoveOldest(dynamic_entries_.front());
   dynamic_entries_.pop_front();
   ++dropped_entry_count_;
 }
@@ -222,6 +236,21 @@ void QpackHeaderTableBase<DynamicEntryTable>::EvictDownToCapacity(
   }
 }
 
+template <typename DynamicEntryTable>
+void QpackHeaderTableBase<DynamicEntryTable>::GrowEntryBuffer() {
+  // Every entry is at least kQpackEntrySizeOverhead bytes large, so until the
+  // capacity increases again, inserting entries does not move them.
+  dynamic_entries_.reserve(dynamic_table_capacity_ / kQpackEntrySizeOverhead);
+
+  spdy::HpackEntryRingBuffer entry_buffer;
+  entry_buffer.SetMaxTableSize(dynamic_table_capacity_);
+  for (QpackEntry& entry : dynamic_entries_) {
+    entry = entry_buffer.Add(entry.name(), entry.value());
+  }
+  entry_buffer_ = std::move(entry_buffer);
+  OnDynamicEntriesMoved();
+}
+
 class QUIC_EXPORT_PRIVATE QpackEncoderHeaderTable
     : public QpackHeaderTableBase<QpackEncoderDynamicTable> {
  public:
@@ -258,8 +287,13 @@ class QUIC_EXPORT_PRIVATE QpackEncoderHeaderTable
 
  protected:
   void RemoveEntryFromEnd() override;
+  void OnDynamicEntriesMoved() override;
 
  private:
+  // Makes |dynamic_index_| and |dynamic_name_index_| point to |entry|, the
+  // newest entry with its name and value, at absolute index |index|.
+  void AddToIndices(const QpackEntry& entry, uint64_t index);
+
   using NameValueToEntryMap = spdy::HpackHeaderTable::NameValueToEntryMap;
   using NameToEntryMap = spdy::HpackHeaderTable::NameToEntryMap;
 
@@ -279,13 +313,13 @@ class QUIC_EXPORT_PRIVATE QpackEncoderHeaderTable
   // An unordered set of QpackEntry pointers with a comparison operator that
   // only cares about name and value.  This allows fast lookup of the most
   // recently inserted dynamic entry for a given header name and value pair.
-  // Entries point to entries owned by |QpackHeaderTableBase::dynamic_entries_|.
+  // Keys point to names and values owned by
+  // |QpackHeaderTableBase::entry_buffer_|.
   NameValueToEntryMap dynamic_index_;
 
   // An unordered map of QpackEntry pointers keyed off header name.  This allows
   // fast lookup of the most recently inserted dynamic entry for a given header
-  // name.  Entries point to entries owned by
-  // |QpackHeaderTableBase::dynamic_entries_|.
+  // name.  Keys point to names owned by |QpackHeaderTableBase::entry_buffer_|.
   NameToEntryMap dynamic_name_index_;
 };
 
@@ -316,7 +350,8 @@ class QUIC_EXPORT_PRIVATE QpackDecoderHeaderTable
   // Returns the entry at absolute index |index| from the static or dynamic
   // table according to |is_static|.  |index| is zero based for both the static
   // and the dynamic table.  The returned pointer is valid until the entry is
-  // evicted, even if other entries are inserted into the dynamic table.
+  // evicted, even if other entries are inserted into the dynamic table, unless
+  // the dynamic table capacity is increased.
   // Returns nullptr if entry does not exist.
   const QpackEntry* LookupEntry(bool is_static, uint64_t index) const;
 
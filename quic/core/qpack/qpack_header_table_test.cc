@@ -4,9 +4,11 @@
 
 #include "quic/core/qpack/qpack_header_table.h"
 
+#include <string>
 #include <utility>
 
 #include "absl/base/macros.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "quic/core/qpack/qpack_static_table.h"
 #include "quic/platform/api/quic_test.h"
@@ -397,6 +399,81 @@ TEST_F(QpackEncoderHeaderTableTest, DrainingIndex) {
   EXPECT_EQ(4u, draining_index(1.0));
 }
 
+// Insert many entries of different sizes, so that names and values wrap around
+// the end of the buffer holding them at various offsets.
+TEST_F(QpackEncoderHeaderTableTest, InsertManyEntries) {
+  QpackEncoderHeaderTable table;
+  ASSERT_TRUE(table.SetMaximumDynamicTableCapacity(300));
+  ASSERT_TRUE(table.SetDynamicTableCapacity(300));
+
+  bool is_static = true;
+  uint64_t index = 0;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    const std::string name(i % 7, 'a' + i % 7);
+    const std::string value = absl::StrCat(std::string(i % 150, 'v'), i);
+    EXPECT_EQ(i, table.InsertEntry(name, value));
+    EXPECT_EQ(QpackEncoderHeaderTable::MatchType::kNameAndValue,
+              table.FindHeaderField(name, value, &is_static, &index));
+    EXPECT_FALSE(is_static);
+    EXPECT_EQ(i, index);
+    EXPECT_EQ(QpackEncoderHeaderTable::MatchType::kName,
+              table.FindHeaderField(name, "foo", &is_static, &index));
+    EXPECT_FALSE(is_static);
+    EXPECT_EQ(i, index);
+  }
+}
+
+// Entries can still be found after they move to make room for a larger
+// dynamic table capacity.
+TEST_F(QpackEncoderHeaderTableTest, IncreaseDynamicTableCapacity) {
+  QpackEncoderHeaderTable table;
+  ASSERT_TRUE(table.SetMaximumDynamicTableCapacity(1000));
+  ASSERT_TRUE(table.SetDynamicTableCapacity(100));
+
+  // Entry size is 3 + 3 + 32 = 38.
+  table.InsertEntry("foo", "bar");
+  table.InsertEntry("foo", "baz");
+  EXPECT_TRUE(table.SetDynamicTableCapacity(1000));
+  EXPECT_EQ(0u, table.dropped_entry_count());
+
+  bool is_static = true;
+  uint64_t index = 0;
+  EXPECT_EQ(QpackEncoderHeaderTable::MatchType::kNameAndValue,
+            table.FindHeaderField("foo", "bar", &is_static, &index));
+  EXPECT_EQ(0u, index);
+  EXPECT_EQ(QpackEncoderHeaderTable::MatchType::kNameAndValue,
+            table.FindHeaderField("foo", "baz", &is_static, &index));
+  EXPECT_EQ(1u, index);
+  EXPECT_EQ(QpackEncoderHeaderTable::MatchType::kName,
+            table.FindHeaderField("foo", "qux", &is_static, &index));
+  EXPECT_EQ(1u, index);
+
+  // Evicting the oldest entry leaves the index of its newer duplicate intact.
+  table.InsertEntry("foo", "bar");
+  EXPECT_TRUE(table.SetDynamicTableCapacity(80));
+  EXPECT_EQ(1u, table.dropped_entry_count());
+  EXPECT_EQ(QpackEncoderHeaderTable::MatchType::kNameAndValue,
+            table.FindHeaderField("foo", "bar", &is_static, &index));
+  EXPECT_EQ(2u, index);
+}
+
+// The peer may advertise any maximum dynamic table capacity, but only the
+// capacity actually set determines how much memory the table uses.
+TEST_F(QpackEncoderHeaderTableTest, HugeMaximumDynamicTableCapacity) {
+  QpackEncoderHeaderTable table;
+  ASSERT_TRUE(table.SetMaximumDynamicTableCapacity(uint64_t{1} << 40));
+  EXPECT_EQ(uint64_t{1} << 35, table.max_entries());
+  ASSERT_TRUE(table.SetDynamicTableCapacity(1024));
+
+  EXPECT_EQ(0u, table.InsertEntry("foo", "bar"));
+  bool is_static = true;
+  uint64_t index = 1;
+  EXPECT_EQ(QpackEncoderHeaderTable::MatchType::kNameAndValue,
+            table.FindHeaderField("foo", "bar", &is_static, &index));
+  EXPECT_FALSE(is_static);
+  EXPECT_EQ(0u, index);
+}
+
 class MockObserver : public QpackDecoderHeaderTable::Observer {
  public:
   ~MockObserver() override = default;
@@ -581,6 +658,68 @@ TEST_F(QpackDecoderHeaderTableTest, EvictOldestOfSameName) {
   ExpectEntryAtIndex(/* is_static = */ false, 2u, "baz", "qux");
 }
 
+// Duplicate the oldest entry many times, as a Duplicate instruction would, so
+// that new entries are inserted from entries that are about to be evicted.
+TEST_F(QpackDecoderHeaderTableTest, DuplicateOldestEntry) {
+  QpackDecoderHeaderTable table;
+  ASSERT_TRUE(table.SetMaximumDynamicTableCapacity(300));
+  ASSERT_TRUE(table.SetDynamicTableCapacity(300));
+
+  for (uint64_t i = 0; i < 4; ++i) {
+    table.InsertEntry(std::string(i * 20, 'n'), absl::StrCat(i));
+  }
+  const uint64_t last_index = table.inserted_entry_count() - 1;
+  const QpackEntry* const last_entry =
+      table.LookupEntry(/* is_static = */ false, last_index);
+  ASSERT_TRUE(last_entry);
+
+  for (uint64_t i = 0; i < 1000; ++i) {
+    const QpackEntry* const oldest_entry = table.LookupEntry(
+        /* is_static = */ false, table.dropped_entry_count());
+    ASSERT_TRUE(oldest_entry);
+    const std::string name(oldest_entry->name());
+    const std::string value(oldest_entry->value());
+
+    const uint64_t index =
+        table.InsertEntry(oldest_entry->name(), oldest_entry->value());
+    const QpackEntry* const new_entry =
+        table.LookupEntry(/* is_static = */ false, index);
+    ASSERT_TRUE(new_entry);
+    EXPECT_EQ(name, new_entry->name());
+    EXPECT_EQ(value, new_entry->value());
+
+    // Entries do not move until they are evicted.
+    if (table.dropped_entry_count() <= last_index) {
+      EXPECT_EQ(last_entry,
+                table.LookupEntry(/* is_static = */ false, last_index));
+      EXPECT_EQ(std::string(60, 'n'), last_entry->name());
+    }
+  }
+  EXPECT_EQ(1004u, table.inserted_entry_count());
+}
+
+TEST_F(QpackDecoderHeaderTableTest, IncreaseDynamicTableCapacity) {
+  QpackDecoderHeaderTable table;
+  ASSERT_TRUE(table.SetMaximumDynamicTableCapacity(1000));
+  ASSERT_TRUE(table.SetDynamicTableCapacity(100));
+
+  // Entry size is 3 + 3 + 32 = 38.
+  table.InsertEntry("foo", "bar");
+  table.InsertEntry("baz", "qux");
+  EXPECT_TRUE(table.SetDynamicTableCapacity(1000));
+
+  // Both entries are still there, and there is room for more.
+  for (uint64_t i = 0; i < 20; ++i) {
+    table.InsertEntry("foo", "bar");
+  }
+  EXPECT_EQ(22u, table.inserted_entry_count());
+  EXPECT_EQ(0u, table.dropped_entry_count());
+  const QpackEntry* entry = table.LookupEntry(/* is_static = */ false, 1);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("baz", entry->name());
+  EXPECT_EQ("qux", entry->value());
+}
+
 TEST_F(QpackDecoderHeaderTableTest, RegisterObserver) {
   StrictMock<MockObserver> observer1;
   RegisterObserver(1, &observer1);
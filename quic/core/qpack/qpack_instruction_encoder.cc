@@ -143,14 +143,15 @@ void QpackInstructionEncoder::DoStartString(absl::string_view name,
       (field_->type == QpackInstructionFieldType::kName) ? name : value;
   string_length_ = string_to_write.size();
 
-  size_t encoded_size = http2::HuffmanSize(string_to_write);
-  use_huffman_ = encoded_size < string_length_;
+  huffman_encoded_string_.clear();
+  use_huffman_ =
+      http2::HuffmanEncodeIfShorter(string_to_write, &huffman_encoded_string_);
 
   if (use_huffman_) {
     QUICHE_DCHECK_EQ(0, byte_ & (1 << field_->param));
     byte_ |= (1 << field_->param);
 
-    string_length_ = encoded_size;
+    string_length_ = huffman_encoded_string_.size();
   }
 
   state_ = State::kVarintEncode;
@@ -165,7 +166,7 @@ void QpackInstructionEncoder::DoWriteString(absl::string_view name,
   absl::string_view string_to_write =
       (field_->type == QpackInstructionFieldType::kName) ? name : value;
   if (use_huffman_) {
-    http2::HuffmanEncodeFast(string_to_write, string_length_, output);
+    absl::StrAppend(output, huffman_encoded_string_);
   } else {
     absl::StrAppend(output, string_to_write);
   }
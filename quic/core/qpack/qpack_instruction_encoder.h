@@ -38,12 +38,12 @@ class QUIC_EXPORT_PRIVATE QpackInstructionEncoder {
     // Encode an integer (|varint_| or |varint2_| or string length) with a
     // prefix, using |byte_| for the high bits.
     kVarintEncode,
-    // Determine if Huffman encoding should be used for the header name or
-    // value, set |use_huffman_| and |string_length_| appropriately, write the
-    // Huffman bit to |byte_|.
+    // Huffman encode the header name or value into |huffman_encoded_string_|
+    // if that makes it shorter, set |use_huffman_| and |string_length_|
+    // appropriately, write the Huffman bit to |byte_|.
     kStartString,
-    // Write header name or value, performing Huffman encoding if |use_huffman_|
-    // is true.
+    // Write header name or value, or its Huffman encoding if |use_huffman_| is
+    // true.
     kWriteString
   };
 
@@ -65,6 +65,9 @@ class QUIC_EXPORT_PRIVATE QpackInstructionEncoder {
   // If |use_huffman_| is true, length is after Huffman encoding.
   size_t string_length_;
 
+  // Huffman encoded name or value, if |use_huffman_| is true.
+  std::string huffman_encoded_string_;
+
   // Storage for a single byte that contains multiple fields, that is, multiple
   // states are writing it.
   uint8_t byte_;
@@ -0,0 +1,107 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares QpackEncoder insertion policies on header lists read from QIF files
+// of the QPACK Offline Interop corpus, see
+// https://github.com/quicwg/base-drafts/wiki/QPACK-Offline-Interop.
+//
+// Example usage
+//
+//  $BIN/qpack_offline_encoder_evaluator --encoder_stream_delay=2 \
+//      $TEST_QIF_DATA/fb-req.qif $TEST_QIF_DATA/netbsd.qif
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "quic/core/qpack/qpack_encoder_insertion_policy.h"
+#include "quic/platform/api/quic_flags.h"
+#include "quic/test_tools/qpack/qpack_offline_encoder_evaluator.h"
+
+DEFINE_QUIC_COMMAND_LINE_FLAG(uint64_t,
+                              max_table_capacity,
+                              4096,
+                              "Maximum dynamic table capacity in bytes.");
+
+DEFINE_QUIC_COMMAND_LINE_FLAG(uint64_t,
+                              max_blocked_streams,
+                              100,
+                              "Maximum number of blocked streams.");
+
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    uint64_t,
+    encoder_stream_delay,
+    1,
+    "Number of header blocks arriving at the decoder before encoder stream "
+    "data written while encoding an earlier header list.  Zero means encoder "
+    "stream data always arrives first, and streams are never blocked.");
+
+int main(int argc, char* argv[]) {
+  const char* usage =
+      "Usage: qpack_offline_encoder_evaluator qif_filename ...";
+  std::vector<std::string> args =
+      quic::QuicParseCommandLineFlags(usage, argc, argv);
+
+  if (args.empty()) {
+    quic::QuicPrintCommandLineFlagHelp(usage);
+    return 1;
+  }
+
+  struct Policy {
+    const char* name;
+    std::unique_ptr<quic::QpackEncoderInsertionPolicy> (*create)();
+  };
+  const Policy policies[] = {
+      {"default",
+       []() -> std::unique_ptr<quic::QpackEncoderInsertionPolicy> {
+         return nullptr;
+       }},
+      {"cost_model",
+       []() -> std::unique_ptr<quic::QpackEncoderInsertionPolicy> {
+         return std::make_unique<quic::QpackCostModelInsertionPolicy>();
+       }},
+  };
+
+  size_t failure_count = 0;
+  for (const std::string& qif_filename : args) {
+    for (const Policy& policy : policies) {
+      quic::QpackOfflineEncoderEvaluator evaluator(
+          GetQuicFlag(FLAGS_max_table_capacity),
+          GetQuicFlag(FLAGS_max_blocked_streams),
+          GetQuicFlag(FLAGS_encoder_stream_delay));
+      quic::QpackOfflineEncoderEvaluator::Result result;
+      if (!evaluator.Evaluate(qif_filename, policy.create(), &result)) {
+        std::cout << qif_filename << " " << policy.name << ": failed"
+                  << std::endl;
+        ++failure_count;
+        continue;
+      }
+
+      const uint64_t compressed_byte_count =
+          result.header_block_byte_count + result.encoder_stream_byte_count;
+      std::cout << qif_filename << " " << policy.name << ": "
+                << result.header_list_count << " header lists, "
+                << result.uncompressed_byte_count << " bytes compressed to "
+                << result.header_block_byte_count << " header block bytes + "
+                << result.encoder_stream_byte_count
+                << " encoder stream bytes, compression ratio "
+                << (result.uncompressed_byte_count == 0
+                        ? 0.0
+                        : static_cast<double>(compressed_byte_count) /
+                              result.uncompressed_byte_count)
+                << ", blocked stream rate "
+                << (result.header_list_count == 0
+                        ? 0.0
+                        : static_cast<double>(
+                              result.blocked_header_block_count) /
+                              result.header_list_count)
+                << std::endl;
+    }
+  }
+
+  return failure_count == 0 ? 0 : 1;
+}
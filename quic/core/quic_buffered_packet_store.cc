@@ -4,10 +4,14 @@
 
 #include "quic/core/quic_buffered_packet_store.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_flag_utils.h"
 #include "quic/platform/api/quic_flags.h"
+#include "quic/platform/api/quic_logging.h"
 
 namespace quic {
 
@@ -20,6 +24,10 @@ static const size_t kDefaultMaxConnectionsInStore = 100;
 // Up to half of the capacity can be used for storing non-CHLO packets.
 static const size_t kMaxConnectionsWithoutCHLO =
     kDefaultMaxConnectionsInStore / 2;
+// Sizes of the blocks buffered packets are copied into. The first block of a
+// connection fits one full sized packet, later ones double up to the max.
+static const size_t kMinPacketBlockSize = 2 * 1024;
+static const size_t kMaxPacketBlockSize = 16 * 1024;
 
 namespace {
 
@@ -125,14 +133,28 @@ EnqueuePacketResult QuicBufferedPacketStore::EnqueuePacket(
     }
   }
 
+  if (!MaybeEvictForBytes(connection_id, BytesToBuffer(packet, queue))) {
+    if (queue.buffered_packets.empty()) {
+      // Do not keep an empty entry for a connection whose first packet could
+      // not be buffered.
+      undecryptable_packets_.erase(connection_id);
+    }
+    return TOO_MANY_BYTES;
+  }
+
   if (queue.buffered_packets.empty()) {
     // If this is the first packet arrived on a new connection, initialize the
     // creation time.
     queue.creation_time = clock_->ApproximateNow();
   }
 
-  BufferedPacket new_entry(std::unique_ptr<QuicReceivedPacket>(packet.Clone()),
-                           self_address, peer_address);
+  const QuicByteCount bytes_to_buffer = BytesToBuffer(packet, queue);
+  std::shared_ptr<const char> storage;
+  BufferedPacket new_entry(CopyPacket(packet, &queue, &storage), self_address,
+                           peer_address);
+  new_entry.storage = std::move(storage);
+  queue.buffered_bytes += bytes_to_buffer;
+  buffered_bytes_ += bytes_to_buffer;
   if (is_chlo) {
     // Add CHLO to the beginning of buffered packets so that it can be delivered
     // first later.
@@ -175,6 +197,8 @@ BufferedPacketList QuicBufferedPacketStore::DeliverPackets(
   BufferedPacketList packets_to_deliver;
   auto it = undecryptable_packets_.find(connection_id);
   if (it != undecryptable_packets_.end()) {
+    QUICHE_DCHECK_GE(buffered_bytes_, it->second.buffered_bytes);
+    buffered_bytes_ -= it->second.buffered_bytes;
     packets_to_deliver = std::move(it->second);
     undecryptable_packets_.erase(connection_id);
   }
@@ -182,13 +206,14 @@ BufferedPacketList QuicBufferedPacketStore::DeliverPackets(
 }
 
 void QuicBufferedPacketStore::DiscardPackets(QuicConnectionId connection_id) {
-  undecryptable_packets_.erase(connection_id);
+  EraseConnection(connection_id);
   connections_with_chlo_.erase(connection_id);
 }
 
 void QuicBufferedPacketStore::DiscardAllPackets() {
   undecryptable_packets_.clear();
   connections_with_chlo_.clear();
+  buffered_bytes_ = 0;
   expiration_alarm_->Cancel();
 }
 
@@ -200,6 +225,8 @@ void QuicBufferedPacketStore::OnExpirationTimeout() {
       break;
     }
     QuicConnectionId connection_id = entry.first;
+    QUICHE_DCHECK_GE(buffered_bytes_, entry.second.buffered_bytes);
+    buffered_bytes_ -= entry.second.buffered_bytes;
     visitor_->OnExpiredPackets(connection_id, std::move(entry.second));
     undecryptable_packets_.pop_front();
     connections_with_chlo_.erase(connection_id);
@@ -231,6 +258,108 @@ bool QuicBufferedPacketStore::ShouldNotBufferPacket(bool is_chlo) {
   return is_store_full || reach_non_chlo_limit;
 }
 
+bool QuicBufferedPacketStore::MaybeEvictForBytes(
+    QuicConnectionId connection_id, QuicByteCount bytes_to_buffer) {
+  const QuicByteCount max_bytes =
+      GetQuicFlag(FLAGS_quic_buffered_packet_store_max_bytes);
+  if (!GetQuicReloadableFlag(quic_bound_buffered_packet_store_bytes) ||
+      max_bytes == 0) {
+    return true;
+  }
+  QUIC_RELOADABLE_FLAG_COUNT(quic_bound_buffered_packet_store_bytes);
+  // Walk connections from the oldest, skipping those with CHLO which will be
+  // delivered soon.
+  auto it = undecryptable_packets_.begin();
+  while (buffered_bytes_ + bytes_to_buffer > max_bytes &&
+         it != undecryptable_packets_.end()) {
+    if (it->first == connection_id ||
+        connections_with_chlo_.contains(it->first)) {
+      ++it;
+      continue;
+    }
+    QUIC_DVLOG(1) << "Evicting " << it->second.buffered_packets.size()
+                  << " packets buffered for connection " << it->first
+                  << " to buffer packets for " << connection_id;
+    QuicConnectionId evicted_connection_id = it->first;
+    BufferedPacketList evicted_packets = std::move(it->second);
+    QUICHE_DCHECK_GE(buffered_bytes_, evicted_packets.buffered_bytes);
+    buffered_bytes_ -= evicted_packets.buffered_bytes;
+    it = undecryptable_packets_.erase(it);
+    ++num_connections_evicted_;
+    QUIC_CODE_COUNT(quic_buffered_packet_store_evict_connection);
+    visitor_->OnExpiredPackets(evicted_connection_id,
+                               std::move(evicted_packets));
+  }
+  return buffered_bytes_ + bytes_to_buffer <= max_bytes;
+}
+
+// static
+QuicByteCount QuicBufferedPacketStore::BytesToBuffer(
+    const QuicReceivedPacket& packet, const BufferedPacketList& queue) {
+  QuicByteCount bytes = sizeof(BufferedPacket) + sizeof(QuicReceivedPacket);
+  const size_t length = PacketCopyLength(packet);
+  if (queue.packet_block_size - queue.packet_block_used < length) {
+    bytes += NextPacketBlockSize(length, queue);
+  }
+  return bytes;
+}
+
+// static
+size_t QuicBufferedPacketStore::PacketCopyLength(
+    const QuicReceivedPacket& packet) {
+  const size_t headers_length =
+      packet.packet_headers() == nullptr ? 0 : packet.headers_length();
+  return packet.length() + headers_length;
+}
+
+// static
+size_t QuicBufferedPacketStore::NextPacketBlockSize(
+    size_t length, const BufferedPacketList& queue) {
+  return std::max(
+      length,
+      std::min(kMaxPacketBlockSize,
+               std::max(kMinPacketBlockSize, 2 * queue.packet_block_size)));
+}
+
+// static
+std::unique_ptr<QuicReceivedPacket> QuicBufferedPacketStore::CopyPacket(
+    const QuicReceivedPacket& packet,
+    BufferedPacketList* queue,
+    std::shared_ptr<const char>* storage) {
+  const size_t length = PacketCopyLength(packet);
+  const size_t headers_length = length - packet.length();
+  if (queue->packet_block_size - queue->packet_block_used < length) {
+    const size_t block_size = NextPacketBlockSize(length, *queue);
+    queue->packet_block.reset(new char[block_size],
+                              std::default_delete<char[]>());
+    queue->packet_block_size = block_size;
+    queue->packet_block_used = 0;
+  }
+  char* buffer = queue->packet_block.get() + queue->packet_block_used;
+  memcpy(buffer, packet.data(), packet.length());
+  char* headers = nullptr;
+  if (headers_length > 0) {
+    headers = buffer + packet.length();
+    memcpy(headers, packet.packet_headers(), headers_length);
+  }
+  queue->packet_block_used += length;
+  *storage = queue->packet_block;
+  return std::make_unique<QuicReceivedPacket>(
+      buffer, packet.length(), packet.receipt_time(), /*owns_buffer=*/false,
+      packet.ttl(), packet.ttl() >= 0, headers, headers_length,
+      /*owns_header_buffer=*/false);
+}
+
+void QuicBufferedPacketStore::EraseConnection(QuicConnectionId connection_id) {
+  auto it = undecryptable_packets_.find(connection_id);
+  if (it == undecryptable_packets_.end()) {
+    return;
+  }
+  QUICHE_DCHECK_GE(buffered_bytes_, it->second.buffered_bytes);
+  buffered_bytes_ -= it->second.buffered_bytes;
+  undecryptable_packets_.erase(it);
+}
+
 BufferedPacketList QuicBufferedPacketStore::DeliverPacketsForNextConnection(
     QuicConnectionId* connection_id) {
   if (connections_with_chlo_.empty()) {
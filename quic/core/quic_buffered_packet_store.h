@@ -6,6 +6,7 @@
 #define QUICHE_QUIC_CORE_QUIC_BUFFERED_PACKET_STORE_H_
 
 #include <list>
+#include <memory>
 #include <string>
 
 #include "quic/core/quic_alarm.h"
@@ -33,12 +34,21 @@ class QuicBufferedPacketStorePeer;
 // of connections: connections with CHLO buffered and those without CHLO. The
 // latter has its own upper limit along with the max number of connections this
 // store can hold. The former pool can grow till this store is full.
+//
+// The total number of bytes allocated for buffered packets can also be
+// bounded. When a new packet does not fit, the oldest connections without CHLO
+// are evicted to make room; connections with CHLO are never evicted as they are
+// about to be created.
+//
+// Packets of a connection are copied back to back into a few geometrically
+// growing blocks instead of being cloned one by one.
 class QUIC_NO_EXPORT QuicBufferedPacketStore {
  public:
   enum EnqueuePacketResult {
     SUCCESS = 0,
     TOO_MANY_PACKETS,  // Too many packets stored up for a certain connection.
-    TOO_MANY_CONNECTIONS  // Too many connections stored up in the store.
+    TOO_MANY_CONNECTIONS,  // Too many connections stored up in the store.
+    TOO_MANY_BYTES  // Too many bytes stored up in the store.
   };
 
   struct QUIC_NO_EXPORT BufferedPacket {
@@ -54,6 +64,8 @@ class QUIC_NO_EXPORT QuicBufferedPacketStore {
     std::unique_ptr<QuicReceivedPacket> packet;
     QuicSocketAddress self_address;
     QuicSocketAddress peer_address;
+    // The block |packet| points into, if |packet| does not own its buffer.
+    std::shared_ptr<const char> storage;
   };
 
   // A queue of BufferedPackets for a connection.
@@ -75,6 +87,13 @@ class QUIC_NO_EXPORT QuicBufferedPacketStore {
     // Otherwise, it is the version of the first packet in |buffered_packets|.
     ParsedQuicVersion version;
     TlsChloExtractor tls_chlo_extractor;
+    // Total number of bytes allocated for |buffered_packets|, including the
+    // packet blocks and per-packet bookkeeping.
+    QuicByteCount buffered_bytes = 0;
+    // Block the next packet is copied into, and how much of it is used.
+    std::shared_ptr<char> packet_block;
+    size_t packet_block_size = 0;
+    size_t packet_block_used = 0;
   };
 
   using BufferedPacketMap = quiche::QuicheLinkedHashMap<QuicConnectionId,
@@ -160,6 +179,13 @@ class QUIC_NO_EXPORT QuicBufferedPacketStore {
   // Is there any CHLO buffered in the store?
   bool HasChlosBuffered() const;
 
+  // Total number of bytes allocated for buffered packets across all
+  // connections.
+  QuicByteCount buffered_bytes() const { return buffered_bytes_; }
+
+  // Number of connections evicted to stay within the byte budget.
+  uint64_t num_connections_evicted() const { return num_connections_evicted_; }
+
  private:
   friend class test::QuicBufferedPacketStorePeer;
 
@@ -170,6 +196,36 @@ class QUIC_NO_EXPORT QuicBufferedPacketStore {
   // limit. The limit for non-CHLO packet and CHLO packet is different.
   bool ShouldNotBufferPacket(bool is_chlo);
 
+  // Evicts the oldest connections without CHLO, other than |connection_id|,
+  // until |bytes_to_buffer| more bytes fit in the byte budget. Evicted
+  // connections are passed to |visitor_| as if they expired. Returns false if
+  // there is not enough room.
+  bool MaybeEvictForBytes(QuicConnectionId connection_id,
+                          QuicByteCount bytes_to_buffer);
+
+  // Returns the number of bytes buffering |packet| in |queue| allocates.
+  static QuicByteCount BytesToBuffer(const QuicReceivedPacket& packet,
+                                     const BufferedPacketList& queue);
+
+  // Returns the number of bytes of |packet| and its headers.
+  static size_t PacketCopyLength(const QuicReceivedPacket& packet);
+
+  // Returns the size of the block |queue| allocates next to copy |length|
+  // bytes into.
+  static size_t NextPacketBlockSize(size_t length,
+                                    const BufferedPacketList& queue);
+
+  // Copies |packet| into the packet blocks of |queue| and returns a packet
+  // pointing into them. |storage| is set to the block it points into.
+  static std::unique_ptr<QuicReceivedPacket> CopyPacket(
+      const QuicReceivedPacket& packet,
+      BufferedPacketList* queue,
+      std::shared_ptr<const char>* storage);
+
+  // Removes the entry of |connection_id| from |undecryptable_packets_| and
+  // updates |buffered_bytes_|.
+  void EraseConnection(QuicConnectionId connection_id);
+
   // A map to store packet queues with creation time for each connection.
   BufferedPacketMap undecryptable_packets_;
 
@@ -188,6 +244,11 @@ class QUIC_NO_EXPORT QuicBufferedPacketStore {
   // arrive.
   quiche::QuicheLinkedHashMap<QuicConnectionId, bool, QuicConnectionIdHash>
       connections_with_chlo_;
+
+  // Sum of |buffered_bytes| of all entries in |undecryptable_packets_|.
+  QuicByteCount buffered_bytes_ = 0;
+
+  uint64_t num_connections_evicted_ = 0;
 };
 
 }  // namespace quic
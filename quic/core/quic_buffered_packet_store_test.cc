@@ -4,8 +4,10 @@
 
 #include "quic/core/quic_buffered_packet_store.h"
 
+#include <algorithm>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "quic/core/quic_versions.h"
 #include "quic/platform/api/quic_flags.h"
@@ -447,6 +449,171 @@ TEST_F(QuicBufferedPacketStoreTest, DiscardPacketsEmpty) {
   EXPECT_FALSE(store_.HasChlosBuffered());
 }
 
+TEST_F(QuicBufferedPacketStoreTest, EvictOldestConnectionWithoutChlo) {
+  SetQuicReloadableFlag(quic_bound_buffered_packet_store_bytes, true);
+  QuicConnectionId connection_id_1 = TestConnectionId(1);
+  QuicConnectionId connection_id_2 = TestConnectionId(2);
+  QuicConnectionId connection_id_3 = TestConnectionId(3);
+  QuicConnectionId connection_id_4 = TestConnectionId(4);
+  EXPECT_EQ(EnqueuePacketResult::SUCCESS,
+            store_.EnqueuePacket(connection_id_1, false, packet_, self_address_,
+                                 peer_address_, valid_version_,
+                                 kDefaultParsedChlo));
+  // The first packet of a connection is charged for its whole packet block.
+  const QuicByteCount bytes_per_connection = store_.buffered_bytes();
+  EXPECT_LT(packet_content_.size(), bytes_per_connection);
+  SetQuicFlag(FLAGS_quic_buffered_packet_store_max_bytes,
+              3 * bytes_per_connection);
+  for (QuicConnectionId connection_id :
+       {connection_id_2, connection_id_3, connection_id_4}) {
+    EXPECT_EQ(EnqueuePacketResult::SUCCESS,
+              store_.EnqueuePacket(connection_id, false, packet_,
+                                   self_address_, peer_address_,
+                                   invalid_version_, kNoParsedChlo));
+  }
+
+  // Connection 2 is the oldest one without CHLO and makes room for 4.
+  EXPECT_TRUE(store_.HasBufferedPackets(connection_id_1));
+  EXPECT_FALSE(store_.HasBufferedPackets(connection_id_2));
+  EXPECT_TRUE(store_.HasBufferedPackets(connection_id_3));
+  EXPECT_TRUE(store_.HasBufferedPackets(connection_id_4));
+  EXPECT_EQ(1u, store_.num_connections_evicted());
+  EXPECT_EQ(3 * bytes_per_connection, store_.buffered_bytes());
+  // The visitor is told about the evicted connection.
+  EXPECT_EQ(1u, visitor_.last_expired_packet_queue_.buffered_packets.size());
+
+  store_.DiscardPackets(connection_id_3);
+  EXPECT_EQ(2 * bytes_per_connection, store_.buffered_bytes());
+  store_.DeliverPackets(connection_id_4);
+  EXPECT_EQ(bytes_per_connection, store_.buffered_bytes());
+}
+
+TEST_F(QuicBufferedPacketStoreTest, ByteBudgetNotEnforcedWithoutFlag) {
+  SetQuicReloadableFlag(quic_bound_buffered_packet_store_bytes, false);
+  SetQuicFlag(FLAGS_quic_buffered_packet_store_max_bytes, 1);
+  for (uint64_t conn_id = 1; conn_id <= 3; ++conn_id) {
+    EXPECT_EQ(EnqueuePacketResult::SUCCESS,
+              store_.EnqueuePacket(TestConnectionId(conn_id), false, packet_,
+                                   self_address_, peer_address_,
+                                   invalid_version_, kNoParsedChlo));
+  }
+  EXPECT_EQ(0u, store_.num_connections_evicted());
+}
+
+TEST_F(QuicBufferedPacketStoreTest, PacketHeadersAreCharged) {
+  QuicConnectionId connection_id = TestConnectionId(1);
+  store_.EnqueuePacket(connection_id, false, packet_, self_address_,
+                       peer_address_, invalid_version_, kNoParsedChlo);
+  const QuicByteCount bytes_without_headers = store_.buffered_bytes();
+  store_.DiscardPackets(connection_id);
+
+  // A packet with headers too large for the first block needs a larger one.
+  std::string headers(4096, 'h');
+  QuicReceivedPacket packet_with_headers(
+      packet_content_.data(), packet_content_.size(), packet_time_,
+      /*owns_buffer=*/false, /*ttl=*/0, /*ttl_valid=*/false,
+      headers.data(), headers.size(), /*owns_header_buffer=*/false);
+  store_.EnqueuePacket(connection_id, false, packet_with_headers,
+                       self_address_, peer_address_, invalid_version_,
+                       kNoParsedChlo);
+  EXPECT_LT(bytes_without_headers, store_.buffered_bytes());
+  EXPECT_LE(packet_content_.size() + headers.size(), store_.buffered_bytes());
+}
+
+TEST_F(QuicBufferedPacketStoreTest, ConnectionsWithChloAreNotEvicted) {
+  SetQuicReloadableFlag(quic_bound_buffered_packet_store_bytes, true);
+  QuicConnectionId connection_id_1 = TestConnectionId(1);
+  QuicConnectionId connection_id_2 = TestConnectionId(2);
+  QuicConnectionId connection_id_3 = TestConnectionId(3);
+  for (QuicConnectionId connection_id : {connection_id_1, connection_id_2}) {
+    EXPECT_EQ(EnqueuePacketResult::SUCCESS,
+              store_.EnqueuePacket(connection_id, false, packet_,
+                                   self_address_, peer_address_,
+                                   valid_version_, kDefaultParsedChlo));
+  }
+  SetQuicFlag(FLAGS_quic_buffered_packet_store_max_bytes,
+              store_.buffered_bytes());
+
+  EXPECT_EQ(EnqueuePacketResult::TOO_MANY_BYTES,
+            store_.EnqueuePacket(connection_id_3, false, packet_, self_address_,
+                                 peer_address_, valid_version_,
+                                 kDefaultParsedChlo));
+  EXPECT_EQ(EnqueuePacketResult::TOO_MANY_BYTES,
+            store_.EnqueuePacket(connection_id_1, false, packet_, self_address_,
+                                 peer_address_, valid_version_, kNoParsedChlo));
+  EXPECT_FALSE(store_.HasBufferedPackets(connection_id_3));
+  EXPECT_EQ(0u, store_.num_connections_evicted());
+
+  QuicConnectionId delivered_connection_id;
+  EXPECT_EQ(1u, store_.DeliverPacketsForNextConnection(&delivered_connection_id)
+                    .buffered_packets.size());
+  EXPECT_EQ(connection_id_1, delivered_connection_id);
+  EXPECT_EQ(EnqueuePacketResult::SUCCESS,
+            store_.EnqueuePacket(connection_id_3, false, packet_, self_address_,
+                                 peer_address_, valid_version_,
+                                 kDefaultParsedChlo));
+}
+
+TEST_F(QuicBufferedPacketStoreTest, PacketsOutliveDeliveredList) {
+  // Packets spanning several blocks stay valid once moved out of the list
+  // returned by DeliverPackets().
+  QuicConnectionId connection_id = TestConnectionId(1);
+  std::vector<std::string> contents;
+  for (size_t i = 0; i < kDefaultMaxUndecryptablePackets; ++i) {
+    contents.push_back(std::string(1000 + i, 'a' + i));
+    QuicReceivedPacket packet(contents.back().data(), contents.back().size(),
+                              packet_time_);
+    EXPECT_EQ(EnqueuePacketResult::SUCCESS,
+              store_.EnqueuePacket(connection_id, false, packet, self_address_,
+                                   peer_address_, invalid_version_,
+                                   kNoParsedChlo));
+  }
+  std::list<BufferedPacket> queue =
+      store_.DeliverPackets(connection_id).buffered_packets;
+  ASSERT_EQ(contents.size(), queue.size());
+  size_t i = 0;
+  for (const BufferedPacket& packet : queue) {
+    EXPECT_EQ(contents[i++], packet.packet->AsStringPiece());
+    EXPECT_EQ(packet_time_, packet.packet->receipt_time());
+  }
+  EXPECT_EQ(0u, store_.buffered_bytes());
+}
+
+TEST_F(QuicBufferedPacketStoreTest, ChloFloodStaysWithinByteBudget) {
+  // Replays a flood of new connections which each send full sized packets
+  // and, for some of them, a CHLO which never gets processed.
+  SetQuicReloadableFlag(quic_bound_buffered_packet_store_bytes, true);
+  const QuicByteCount kMaxBytes = 256 * 1024;
+  SetQuicFlag(FLAGS_quic_buffered_packet_store_max_bytes, kMaxBytes);
+  std::string content(1200, 'x');
+  QuicReceivedPacket packet(content.data(), content.size(), packet_time_);
+  QuicByteCount max_buffered_bytes = 0;
+  for (uint64_t conn_id = 1; conn_id <= 10000; ++conn_id) {
+    QuicConnectionId connection_id = TestConnectionId(conn_id);
+    for (size_t i = 0; i < kDefaultMaxUndecryptablePackets; ++i) {
+      store_.EnqueuePacket(connection_id, false, packet, self_address_,
+                           peer_address_, invalid_version_, kNoParsedChlo);
+    }
+    if (conn_id % 3 == 0 && !store_.HasChloForConnection(connection_id)) {
+      store_.EnqueuePacket(connection_id, false, packet, self_address_,
+                           peer_address_, valid_version_, kDefaultParsedChlo);
+    }
+    max_buffered_bytes = std::max(max_buffered_bytes, store_.buffered_bytes());
+    if (conn_id % 100 == 0) {
+      clock_.AdvanceTime(
+          QuicBufferedPacketStorePeer::expiration_alarm(&store_)->deadline() -
+          clock_.ApproximateNow());
+      alarm_factory_.FireAlarm(
+          QuicBufferedPacketStorePeer::expiration_alarm(&store_));
+    }
+  }
+  EXPECT_LE(max_buffered_bytes, kMaxBytes);
+  EXPECT_LT(0u, store_.num_connections_evicted());
+
+  store_.DiscardAllPackets();
+  EXPECT_EQ(0u, store_.buffered_bytes());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
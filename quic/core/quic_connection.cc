@@ -16,6 +16,7 @@
 #include <string>
 #include <utility>
 
+#include "absl/base/optimization.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -4356,6 +4357,12 @@ void QuicConnection::RemoveDecrypter(EncryptionLevel level) {
 
 void QuicConnection::DiscardPreviousOneRttKeys() {
   framer_.DiscardPreviousOneRttKeys();
+  if (GetQuicReloadableFlag(quic_precompute_next_key_phase)) {
+    QUIC_RELOADABLE_FLAG_COUNT(quic_precompute_next_key_phase);
+    // This alarm fires well after the last key update, so prepare the next one
+    // now rather than when a packet triggers it.
+    framer_.PrepareNextKeyPhase();
+  }
 }
 
 bool QuicConnection::IsKeyUpdateAllowed() const {
@@ -6034,7 +6041,22 @@ bool QuicConnection::FlushCoalescedPacket() {
     return true;
   }
 
-  char buffer[kMaxOutgoingPacketSize];
+  ABSL_CACHELINE_ALIGNED char stack_buffer[kMaxOutgoingPacketSize];
+  QuicOwnedPacketBuffer packet_buffer(stack_buffer, nullptr);
+  if (GetQuicReloadableFlag(quic_serialize_coalesced_packet_in_place) &&
+      buffered_packets_.empty() && !writer_->IsWriteBlocked()) {
+    // Serialize and encrypt directly into the writer's buffer (e.g. the next
+    // slot of a GSO batch) so the packet is not copied again on write.
+    QuicPacketBuffer writer_buffer = writer_->GetNextWriteLocation(
+        coalesced_packet_.self_address().host(),
+        coalesced_packet_.peer_address());
+    if (writer_buffer.buffer != nullptr) {
+      QUIC_RELOADABLE_FLAG_COUNT(quic_serialize_coalesced_packet_in_place);
+      packet_buffer.buffer = writer_buffer.buffer;
+      packet_buffer.release_buffer = std::move(writer_buffer.release_buffer);
+    }
+  }
+  char* buffer = packet_buffer.buffer;
   const size_t length = packet_creator_.SerializeCoalescedPacket(
       coalesced_packet_, buffer, coalesced_packet_.max_packet_length());
   if (length == 0) {
@@ -6055,6 +6077,8 @@ bool QuicConnection::FlushCoalescedPacket() {
     return true;
   }
 
+  // writer_->WritePacket transfers buffer ownership back to the writer.
+  packet_buffer.release_buffer = nullptr;
   WriteResult result = writer_->WritePacket(
       buffer, length, coalesced_packet_.self_address().host(),
       coalesced_packet_.peer_address(), per_packet_options_);
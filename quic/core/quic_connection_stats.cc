@@ -27,6 +27,9 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionStats& s) {
   os << " packets_dropped: " << s.packets_dropped;
   os << " undecryptable_packets_received_before_handshake_complete: "
      << s.undecryptable_packets_received_before_handshake_complete;
+  os << " packets_buffered_before_creation: "
+     << s.packets_buffered_before_creation;
+  os << " bytes_buffered_before_creation: " << s.bytes_buffered_before_creation;
   os << " crypto_retransmit_count: " << s.crypto_retransmit_count;
   os << " loss_timeout_count: " << s.loss_timeout_count;
   os << " tlp_count: " << s.tlp_count;
@@ -92,6 +92,11 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   // before the handshake was complete.
   QuicPacketCount undecryptable_packets_received_before_handshake_complete = 0;
 
+  // Packets the dispatcher buffered before this connection was created, and
+  // their total size in bytes.
+  QuicPacketCount packets_buffered_before_creation = 0;
+  QuicByteCount bytes_buffered_before_creation = 0;
+
   size_t crypto_retransmit_count = 0;
   // Count of times the loss detection alarm fired.  At least one packet should
   // be lost when the alarm fires.
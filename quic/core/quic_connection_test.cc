@@ -11533,6 +11533,49 @@ TEST_P(QuicConnectionTest, CoalescePacketOfLowerEncryptionLevel) {
   }
 }
 
+TEST_P(QuicConnectionTest, CoalescedPacketSerializedInPlace) {
+  if (!connection_.version().CanSendCoalescedPackets()) {
+    return;
+  }
+  SetQuicReloadableFlag(quic_serialize_coalesced_packet_in_place, true);
+  EXPECT_CALL(visitor_, OnHandshakePacketSent()).Times(1);
+  {
+    QuicConnection::ScopedPacketFlusher flusher(&connection_);
+    use_tagging_decrypter();
+    connection_.SetEncrypter(ENCRYPTION_HANDSHAKE,
+                             std::make_unique<TaggingEncrypter>(0x01));
+    connection_.SetDefaultEncryptionLevel(ENCRYPTION_HANDSHAKE);
+    connection_.SendCryptoDataWithString("foo", 0, ENCRYPTION_HANDSHAKE);
+    connection_.SendCryptoDataWithString("bar", 3, ENCRYPTION_HANDSHAKE);
+  }
+  EXPECT_EQ(1u, writer_->packets_write_attempts());
+  // The coalesced packet is serialized into the writer's buffer.
+  EXPECT_EQ(1u, writer_->packets_written_in_place());
+}
+
+TEST_P(QuicConnectionTest, CoalescedPacketSerializedInPlaceWhileWriteBlocked) {
+  if (!connection_.version().CanSendCoalescedPackets()) {
+    return;
+  }
+  SetQuicReloadableFlag(quic_serialize_coalesced_packet_in_place, true);
+  use_tagging_decrypter();
+  connection_.SetEncrypter(ENCRYPTION_HANDSHAKE,
+                           std::make_unique<TaggingEncrypter>(0x01));
+  connection_.SetDefaultEncryptionLevel(ENCRYPTION_HANDSHAKE);
+  BlockOnNextWrite();
+  EXPECT_CALL(visitor_, OnWriteBlocked()).Times(AnyNumber());
+  EXPECT_CALL(visitor_, OnHandshakePacketSent()).Times(AnyNumber());
+  connection_.SendCryptoDataWithString("foo", 0, ENCRYPTION_HANDSHAKE);
+  EXPECT_EQ(1u, writer_->packets_written_in_place());
+  EXPECT_EQ(1u, connection_.NumQueuedPackets());
+
+  // The blocked packet was copied out of the writer's buffer, so it can still
+  // be sent once the writer is unblocked.
+  writer_->SetWritable();
+  connection_.OnCanWrite();
+  EXPECT_EQ(0u, connection_.NumQueuedPackets());
+}
+
 // Regression test for b/160790422.
 TEST_P(QuicConnectionTest, ServerRetransmitsHandshakeDataEarly) {
   if (!connection_.SupportsMultiplePacketNumberSpaces()) {
@@ -13101,6 +13144,74 @@ TEST_P(QuicConnectionTest, InitiateKeyUpdate) {
   EXPECT_FALSE(connection_.HaveSentPacketsInCurrentKeyPhaseButNoneAcked());
 }
 
+TEST_P(QuicConnectionTest, PrecomputeNextKeyPhase) {
+  if (!connection_.version().UsesTls()) {
+    return;
+  }
+  SetQuicReloadableFlag(quic_precompute_next_key_phase, true);
+
+  TransportParameters params;
+  params.key_update_not_yet_supported = false;
+  QuicConfig config;
+  std::string error_details;
+  EXPECT_THAT(config.ProcessTransportParameters(
+                  params, /* is_resumption = */ false, &error_details),
+              IsQuicNoError());
+  config.SetKeyUpdateSupportedLocally();
+  QuicConfigPeer::SetNegotiated(&config, true);
+  QuicConfigPeer::SetReceivedOriginalConnectionId(&config,
+                                                  connection_.connection_id());
+  QuicConfigPeer::SetReceivedInitialSourceConnectionId(
+      &config, connection_.connection_id());
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  connection_.SetFromConfig(config);
+
+  MockFramerVisitor peer_framer_visitor_;
+  peer_framer_.set_visitor(&peer_framer_visitor_);
+
+  use_tagging_decrypter();
+
+  connection_.SetDefaultEncryptionLevel(ENCRYPTION_FORWARD_SECURE);
+  connection_.SetEncrypter(ENCRYPTION_FORWARD_SECURE,
+                           std::make_unique<TaggingEncrypter>(0x01));
+  SetDecrypter(ENCRYPTION_FORWARD_SECURE,
+               std::make_unique<StrictTaggingDecrypter>(0x01));
+  EXPECT_CALL(visitor_, GetHandshakeState())
+      .WillRepeatedly(Return(HANDSHAKE_CONFIRMED));
+  connection_.OnHandshakeComplete();
+
+  peer_framer_.SetEncrypter(ENCRYPTION_FORWARD_SECURE,
+                            std::make_unique<TaggingEncrypter>(0x01));
+
+  // Send packet 1 and receive its ack.
+  QuicPacketNumber last_packet;
+  SendStreamDataToPeer(1, "foo", 0, NO_FIN, &last_packet);
+  EXPECT_CALL(*send_algorithm_, OnCongestionEvent(true, _, _, _, _));
+  QuicAckFrame frame1 = InitAckFrame(1);
+  ProcessAckPacket(&frame1);
+  EXPECT_TRUE(connection_.GetDiscardPreviousOneRttKeysAlarm()->IsSet());
+
+  // The next key phase is derived when the alarm fires, and only then.
+  bool derived_next_keys = false;
+  EXPECT_CALL(visitor_, AdvanceKeysAndCreateCurrentOneRttDecrypter())
+      .WillOnce([&derived_next_keys]() {
+        derived_next_keys = true;
+        return std::make_unique<StrictTaggingDecrypter>(0x02);
+      });
+  EXPECT_CALL(visitor_, CreateCurrentOneRttEncrypter()).WillOnce([]() {
+    return std::make_unique<TaggingEncrypter>(0x02);
+  });
+  connection_.GetDiscardPreviousOneRttKeysAlarm()->Fire();
+  EXPECT_TRUE(derived_next_keys);
+
+  EXPECT_CALL(visitor_, OnKeyUpdate(KeyUpdateReason::kLocalForTests));
+  EXPECT_TRUE(connection_.InitiateKeyUpdate(KeyUpdateReason::kLocalForTests));
+
+  // Packets are now sent in the new key phase.
+  SendStreamDataToPeer(2, "bar", 0, NO_FIN, &last_packet);
+  EXPECT_EQ(0x02020202u, writer_->final_bytes_of_last_packet());
+}
+
 TEST_P(QuicConnectionTest, InitiateKeyUpdateApproachingConfidentialityLimit) {
   if (!connection_.version().UsesTls()) {
     return;
@@ -4,6 +4,8 @@
 
 #include "quic/core/quic_data_reader.h"
 
+#include <cstring>
+
 #include "absl/strings/string_view.h"
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_utils.h"
@@ -164,6 +166,27 @@ bool QuicDataReader::ReadVarInt62(uint64_t* result) {
   return false;
 }
 
+size_t QuicDataReader::ReadVarInt62Batch(uint64_t* results, size_t count) {
+  QUICHE_DCHECK_EQ(endianness(), quiche::NETWORK_BYTE_ORDER);
+
+  size_t num_read = 0;
+  // Every encoding fits in an 8-byte load: its top two bits give the length,
+  // and the value is the first |length| bytes without those two bits.
+  while (num_read < count && BytesRemaining() >= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data() + pos(), sizeof(word));
+    word = quiche::QuicheEndian::NetToHost64(word);
+    const size_t length = size_t{1} << (word >> 62);
+    results[num_read++] =
+        (word & UINT64_C(0x3fffffffffffffff)) >> (64 - 8 * length);
+    AdvancePos(length);
+  }
+  while (num_read < count && ReadVarInt62(&results[num_read])) {
+    ++num_read;
+  }
+  return num_read;
+}
+
 bool QuicDataReader::ReadStringPieceVarInt62(absl::string_view* result) {
   uint64_t result_length;
   if (!ReadVarInt62(&result_length)) {
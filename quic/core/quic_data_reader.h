@@ -77,6 +77,13 @@ class QUIC_EXPORT_PRIVATE QuicDataReader : public quiche::QuicheDataReader {
   // and that the integers in the range 0 ... (2^62)-1.
   bool ReadVarInt62(uint64_t* result);
 
+  // Reads up to |count| consecutive IETF-encoded Variable Length Integers into
+  // |results|, stopping at the first one that does not fit in the buffer.
+  // Returns the number of integers read. Equivalent to calling ReadVarInt62()
+  // in a loop, but decodes without branching on the encoded length while at
+  // least 8 bytes remain.
+  size_t ReadVarInt62Batch(uint64_t* results, size_t count);
+
   // Reads a string prefixed with a Variable Length integer length into the
   // given output parameter.
   //
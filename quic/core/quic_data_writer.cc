@@ -5,6 +5,7 @@
 #include "quic/core/quic_data_writer.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 
 #include "absl/strings/string_view.h"
@@ -225,6 +226,37 @@ bool QuicDataWriter::WriteVarInt62(
   return false;
 }
 
+bool QuicDataWriter::WriteVarInt62Batch(const uint64_t* values, size_t count) {
+  QUICHE_DCHECK_EQ(endianness(), quiche::NETWORK_BYTE_ORDER);
+
+  size_t total_length = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if ((values[i] & kVarInt62ErrorMask) != 0) {
+      return false;
+    }
+    total_length += GetVarInt62Len(values[i]);
+  }
+  if (remaining() < total_length) {
+    return false;
+  }
+
+  char* next = buffer() + length();
+  for (size_t i = 0; i < count; ++i) {
+    const size_t value_length = GetVarInt62Len(values[i]);
+    // Two-bit length tag: 0, 1, 2 or 3 for 1, 2, 4 or 8 bytes.
+    const uint64_t tag =
+        (value_length > 1) + (value_length > 2) + (value_length > 4);
+    // Left-align the encoding so that its first |value_length| bytes are the
+    // ones to write.
+    const uint64_t encoded = quiche::QuicheEndian::HostToNet64(
+        (tag << 62) | (values[i] << (64 - 8 * value_length)));
+    memcpy(next, &encoded, value_length);
+    next += value_length;
+  }
+  IncreaseLength(total_length);
+  return true;
+}
+
 // static
 QuicVariableLengthIntegerLength QuicDataWriter::GetVarInt62Len(uint64_t value) {
   if ((value & kVarInt62ErrorMask) != 0) {
@@ -67,6 +67,12 @@ class QUIC_EXPORT_PRIVATE QuicDataWriter : public quiche::QuicheDataWriter {
   bool WriteVarInt62(uint64_t value,
                      QuicVariableLengthIntegerLength write_length);
 
+  // Writes |count| values from |values| with WriteVarInt62() encoding, all or
+  // nothing: returns false without writing anything if any value is out of
+  // range or if they do not all fit in the buffer. Checks the space once for
+  // the whole batch and encodes each value with a single store.
+  bool WriteVarInt62Batch(const uint64_t* values, size_t count);
+
   // Writes a string piece as a consecutive length/content pair. The
   // length is VarInt62 encoded.
   bool WriteStringPieceVarInt62(const absl::string_view& string_piece);
@@ -4,8 +4,10 @@
 
 #include "quic/core/quic_data_writer.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/strings/str_cat.h"
@@ -1008,6 +1010,97 @@ TEST_P(QuicDataWriterTest, MultiVarInt1) {
   EXPECT_FALSE(reader.ReadVarInt62(&test_val));
 }
 
+// Test that the batch varint paths produce the same bytes and values as
+// WriteVarInt62 and ReadVarInt62, with every encoding length mixed together.
+TEST_P(QuicDataWriterTest, VarInt62Batch) {
+  std::vector<uint64_t> values;
+  for (int i = 0; i < kMultiVarCount; i++) {
+    switch (i % 4) {
+      case 0:
+        values.push_back(UINT64_C(0x30) + (i & 0xf));
+        break;
+      case 1:
+        values.push_back(UINT64_C(0x3142) + i);
+        break;
+      case 2:
+        values.push_back(UINT64_C(0x3142f3e4) + i);
+        break;
+      case 3:
+        values.push_back(UINT64_C(0x3142f3e4d5c6b7a8) + i);
+        break;
+    }
+  }
+  const size_t encoded_length = 15 * kMultiVarCount / 4;
+
+  char expected[encoded_length];
+  QuicDataWriter expected_writer(sizeof(expected), expected,
+                                 quiche::Endianness::NETWORK_BYTE_ORDER);
+  for (uint64_t value : values) {
+    EXPECT_TRUE(expected_writer.WriteVarInt62(value));
+  }
+  EXPECT_EQ(encoded_length, expected_writer.length());
+
+  char buffer[encoded_length];
+  QuicDataWriter writer(sizeof(buffer), buffer,
+                        quiche::Endianness::NETWORK_BYTE_ORDER);
+  EXPECT_TRUE(writer.WriteVarInt62Batch(values.data(), values.size()));
+  EXPECT_EQ(encoded_length, writer.length());
+  quiche::test::CompareCharArraysWithHexError(
+      "VarInt62Batch", buffer, writer.length(), expected,
+      expected_writer.length());
+  // The buffer is full.
+  EXPECT_FALSE(writer.WriteVarInt62Batch(values.data(), 1));
+  EXPECT_TRUE(writer.WriteVarInt62Batch(values.data(), 0));
+
+  // Read back in uneven batches, and ask for one value more than was written.
+  QuicDataReader reader(buffer, sizeof(buffer),
+                        quiche::Endianness::NETWORK_BYTE_ORDER);
+  std::vector<uint64_t> read_values(values.size() + 1);
+  size_t num_read = 0;
+  for (size_t batch_size = 1; num_read < values.size(); ++batch_size) {
+    const size_t count = std::min(batch_size, read_values.size() - num_read);
+    const size_t batch_read =
+        reader.ReadVarInt62Batch(&read_values[num_read], count);
+    num_read += batch_read;
+    if (batch_read < count) {
+      break;
+    }
+  }
+  EXPECT_EQ(values.size(), num_read);
+  read_values.resize(num_read);
+  EXPECT_EQ(values, read_values);
+  EXPECT_TRUE(reader.IsDoneReading());
+}
+
+// Test that batch reads stop at the first truncated varint and that batch
+// writes are all or nothing.
+TEST_P(QuicDataWriterTest, VarInt62BatchPartial) {
+  const uint64_t values[] = {UINT64_C(0x3142f3e4d5c6b7a8), 0x3142, 0x31,
+                             0x3142f3e4};
+  char buffer[15];
+  QuicDataWriter writer(sizeof(buffer), buffer,
+                        quiche::Endianness::NETWORK_BYTE_ORDER);
+  const uint64_t out_of_range[] = {0x31, kVarInt62MaxValue + 1};
+  EXPECT_FALSE(writer.WriteVarInt62Batch(out_of_range, 2));
+  EXPECT_EQ(0u, writer.length());
+  EXPECT_TRUE(writer.WriteVarInt62Batch(values, 3));
+  // Only the first of these two fits.
+  EXPECT_FALSE(writer.WriteVarInt62Batch(&values[2], 2));
+  EXPECT_EQ(11u, writer.length());
+  EXPECT_TRUE(writer.WriteVarInt62Batch(&values[3], 1));
+  EXPECT_EQ(sizeof(buffer), writer.length());
+
+  // Drop the last byte, so that the last varint is truncated.
+  QuicDataReader reader(buffer, sizeof(buffer) - 1,
+                        quiche::Endianness::NETWORK_BYTE_ORDER);
+  uint64_t read_values[4];
+  EXPECT_EQ(3u, reader.ReadVarInt62Batch(read_values, 4));
+  EXPECT_EQ(values[0], read_values[0]);
+  EXPECT_EQ(values[1], read_values[1]);
+  EXPECT_EQ(values[2], read_values[2]);
+  EXPECT_EQ(3u, reader.BytesRemaining());
+}
+
 // Test writing varints with a forced length.
 TEST_P(QuicDataWriterTest, VarIntFixedLength) {
   char buffer[90];
@@ -1194,6 +1194,7 @@ void QuicDispatcher::OnExpiredPackets(
 }
 
 void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
+  ProcessCompletedSignatures();
   // Reset the counter before starting creating connections.
   new_sessions_allowed_per_event_loop_ = max_connections_to_create;
   for (; new_sessions_allowed_per_event_loop_ > 0;
@@ -1241,6 +1242,15 @@ void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
   }
 }
 
+void QuicDispatcher::ProcessCompletedSignatures() {
+  if (!completed_signatures_runner_) {
+    return;
+  }
+  size_t num_signatures = completed_signatures_runner_();
+  QUIC_DVLOG(1) << "Resumed " << num_signatures
+                << " handshakes waiting for signatures";
+}
+
 bool QuicDispatcher::HasChlosBuffered() const {
   return buffered_packets_.HasChlosBuffered();
 }
@@ -1385,7 +1395,10 @@ QuicDispatcher::GetSupportedVersionsWithQuicCrypto() {
 void QuicDispatcher::DeliverPacketsToSession(
     const std::list<BufferedPacket>& packets,
     QuicSession* session) {
+  QuicConnectionStats& stats = session->connection()->mutable_stats();
   for (const BufferedPacket& packet : packets) {
+    ++stats.packets_buffered_before_creation;
+    stats.bytes_buffered_before_creation += packet.packet->length();
     session->ProcessUdpPacket(packet.self_address, packet.peer_address,
                               *(packet.packet));
   }
@@ -9,8 +9,10 @@
 #define QUICHE_QUIC_CORE_QUIC_DISPATCHER_H_
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -148,6 +150,19 @@ class QUIC_NO_EXPORT QuicDispatcher
   // Return true if there is CHLO buffered.
   virtual bool HasChlosBuffered() const;
 
+  // Lets ProcessCompletedSignatures() resume the handshakes whose signatures
+  // are computed off the dispatcher's thread by the proof source of
+  // |crypto_config_|, e.g. a ThreadPoolProofSource. |runner| runs the
+  // callbacks of the signatures completed so far and returns how many it ran.
+  void SetCompletedSignaturesRunner(std::function<size_t()> runner) {
+    completed_signatures_runner_ = std::move(runner);
+  }
+
+  // Resumes the handshakes whose signatures have been computed since the last
+  // call. Should be called each time the proof source signals that signatures
+  // completed. Also called by ProcessBufferedChlos().
+  virtual void ProcessCompletedSignatures();
+
   // Start accepting new ConnectionIds.
   void StartAcceptingNewConnections();
 
@@ -402,6 +417,10 @@ class QUIC_NO_EXPORT QuicDispatcher
 
   const QuicCryptoServerConfig* crypto_config_;
 
+  // If set, runs the callbacks of TLS signatures computed off the dispatcher's
+  // thread.
+  std::function<size_t()> completed_signatures_runner_;
+
   // The cache for most recently compressed certs.
   QuicCompressedCertsCache compressed_certs_cache_;
 
@@ -143,6 +143,27 @@ QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_bbr2_exit_startup_on_persistent_queue2
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_bbr2_add_bytes_acked_after_inflight_hi_limited, true)
 // When true, the BBR4 copt sets the extra_acked window to 20 RTTs and BBR5 sets it to 40 RTTs.
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_bbr2_extra_acked_window, true)
+// If true, QuicTimeWaitListManager rate limits stateless resets and termination packets per source prefix and globally.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_rate_limit_stateless_responses, false)
+// If true, QuicConnection serializes coalesced packets directly into the packet writer's next write location when one is available.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_serialize_coalesced_packet_in_place, false)
+// If true, TLS clients and servers negotiate zlib certificate compression (RFC 8879).
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_tls_cert_compression, false)
+// If true, QuicConnection derives the next 1-RTT key phase when it discards the previous one, instead of when the next key update happens.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_precompute_next_key_phase, false)
 
+// If true, TlsChloExtractor parses ClientHellos with TlsChloParser and only uses BoringSSL when that fails.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_parse_tls_chlo_without_ssl, false)
+// If true, HpackHuffmanDecoder decodes with the 4-bit state machine of HpackHuffmanFsmDecoder.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_hpack_huffman_fsm_decoder, false)
+
+// If true, QuicSpdySession decides which header fields QpackEncoder inserts into the dynamic table with QpackCostModelInsertionPolicy.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_qpack_cost_model_insertion_policy, false)
+
+// If true, QuicSpdyStream moves QPACK-decoded initial headers into its header list instead of copying them.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_move_decoded_headers_into_stream, false)
+
+// If true, QuicBufferedPacketStore evicts connections without CHLO to stay within quic_buffered_packet_store_max_bytes.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_bound_buffered_packet_store_bytes, false)
 #endif
 
@@ -137,6 +137,10 @@ const uint8_t kQuicTimestampPacketNumberGapLength = 1;
 // Maximum length of encoded error strings.
 const int kMaxErrorStringLength = 256;
 
+// Number of IETF ACK ranges whose gap and length varints are decoded or
+// encoded together.
+const size_t kIetfAckRangeBatchSize = 32;
+
 const uint8_t kConnectionIdLengthAdjustment = 3;
 const uint8_t kDestinationConnectionIdLengthMask = 0xF0;
 const uint8_t kSourceConnectionIdLengthMask = 0x0F;
@@ -4032,63 +4036,74 @@ bool QuicFramer::ProcessIetfAckFrame(QuicDataReader* reader,
     return false;
   }
 
+  // Each additional ACK block is a gap value followed by an ack block value.
+  uint64_t block_values[2 * kIetfAckRangeBatchSize];
   while (ack_block_count != 0) {
-    uint64_t gap_block_value;
-    // Get the sizes of the gap and ack blocks,
-    if (!reader->ReadVarInt62(&gap_block_value)) {
-      set_detailed_error("Unable to read gap block value.");
-      return false;
-    }
-    // It's an error if the gap is larger than the space from packet
-    // number 0 to the start of the block that's just been acked, PLUS
-    // there must be space for at least 1 packet to be acked. For
-    // example, if block_low is 10 and gap_block_value is 9, it means
-    // the gap block is 10 packets long, leaving no room for a packet
-    // to be acked. Thus, gap_block_value+2 can not be larger than
-    // block_low.
-    // The test is written this way to detect wrap-arounds.
-    if ((gap_block_value + 2) > block_low) {
-      set_detailed_error(
-          absl::StrCat("Underflow with gap block length ", gap_block_value + 1,
-                       " previous ack block start is ", block_low, ".")
-              .c_str());
-      return false;
-    }
+    const size_t num_values =
+        2 * std::min<uint64_t>(ack_block_count, kIetfAckRangeBatchSize);
+    const size_t num_read = reader->ReadVarInt62Batch(block_values, num_values);
+    for (size_t i = 0; i < num_values; i += 2) {
+      // Get the sizes of the gap and ack blocks,
+      if (i >= num_read) {
+        set_detailed_error("Unable to read gap block value.");
+        return false;
+      }
+      const uint64_t gap_block_value = block_values[i];
+      // It's an error if the gap is larger than the space from packet
+      // number 0 to the start of the block that's just been acked, PLUS
+      // there must be space for at least 1 packet to be acked. For
+      // example, if block_low is 10 and gap_block_value is 9, it means
+      // the gap block is 10 packets long, leaving no room for a packet
+      // to be acked. Thus, gap_block_value+2 can not be larger than
+      // block_low.
+      // The test is written this way to detect wrap-arounds.
+      if ((gap_block_value + 2) > block_low) {
+        set_detailed_error(
+            absl::StrCat("Underflow with gap block length ",
+                         gap_block_value + 1, " previous ack block start is ",
+                         block_low, ".")
+                .c_str());
+        return false;
+      }
 
-    // Adjust block_high to be the top of the next ack block.
-    // There is a gap of |gap_block_value| packets between the bottom
-    // of ack block N and top of block N+1.  Note that gap_block_value
-    // is he size of the gap minus 1 (per the QUIC protocol), and
-    // block_high is the packet number of the first packet of the gap
-    // (per the implementation of OnAckRange/AddAckRange, below).
-    block_high = block_low - 1 - gap_block_value;
+      // Adjust block_high to be the top of the next ack block.
+      // There is a gap of |gap_block_value| packets between the bottom
+      // of ack block N and top of block N+1.  Note that gap_block_value
+      // is he size of the gap minus 1 (per the QUIC protocol), and
+      // block_high is the packet number of the first packet of the gap
+      // (per the implementation of OnAckRange/AddAckRange, below).
+      block_high = block_low - 1 - gap_block_value;
 
-    if (!reader->ReadVarInt62(&ack_block_value)) {
-      set_detailed_error("Unable to read ack block value.");
-      return false;
-    }
-    if (ack_block_value + first_sending_packet_number_.ToUint64() >
-        (block_high - 1)) {
-      set_detailed_error(
-          absl::StrCat("Underflow with ack block length ", ack_block_value + 1,
-                       " latest ack block end is ", block_high - 1, ".")
-              .c_str());
-      return false;
-    }
-    // Calculate the low end of the new nth ack block. The +1 is
-    // because the encoded value is the blocksize-1.
-    block_low = block_high - 1 - ack_block_value;
-    if (!visitor_->OnAckRange(QuicPacketNumber(block_low),
-                              QuicPacketNumber(block_high))) {
-      // The visitor suppresses further processing of the packet. Although
-      // this is not a parsing error, returns false as this is in middle
-      // of processing an ACK frame.
-      set_detailed_error("Visitor suppresses further processing of ACK frame.");
-      return false;
-    }
+      if (i + 1 >= num_read) {
+        set_detailed_error("Unable to read ack block value.");
+        return false;
+      }
+      ack_block_value = block_values[i + 1];
+      if (ack_block_value + first_sending_packet_number_.ToUint64() >
+          (block_high - 1)) {
+        set_detailed_error(
+            absl::StrCat("Underflow with ack block length ",
+                         ack_block_value + 1, " latest ack block end is ",
+                         block_high - 1, ".")
+                .c_str());
+        return false;
+      }
+      // Calculate the low end of the new nth ack block. The +1 is
+      // because the encoded value is the blocksize-1.
+      block_low = block_high - 1 - ack_block_value;
+      if (!visitor_->OnAckRange(QuicPacketNumber(block_low),
+                                QuicPacketNumber(block_high))) {
+        // The visitor suppresses further processing of the packet. Although
+        // this is not a parsing error, returns false as this is in middle
+        // of processing an ACK frame.
+        set_detailed_error(
+            "Visitor suppresses further processing of ACK frame.");
+        return false;
+      }
 
-    // Another one done.
-    ack_block_count--;
+      // Another one done.
+      ack_block_count--;
+    }
   }
 
   if (frame_type == IETF_ACK_RECEIVE_TIMESTAMPS) {
@@ -4436,6 +4451,23 @@ void QuicFramer::DiscardPreviousOneRttKeys() {
   previous_decrypter_ = nullptr;
 }
 
+bool QuicFramer::PrepareNextKeyPhase() {
+  if (!support_key_update_for_connection_ ||
+      decrypter_[ENCRYPTION_FORWARD_SECURE] == nullptr ||
+      encrypter_[ENCRYPTION_FORWARD_SECURE] == nullptr) {
+    return false;
+  }
+  if (next_encrypter_ != nullptr) {
+    return true;
+  }
+  if (!next_decrypter_) {
+    next_decrypter_ = visitor_->AdvanceKeysAndCreateCurrentOneRttDecrypter();
+  }
+  // The next write secret was derived along with the next read secret.
+  next_encrypter_ = visitor_->CreateCurrentOneRttEncrypter();
+  return next_decrypter_ != nullptr && next_encrypter_ != nullptr;
+}
+
 bool QuicFramer::DoKeyUpdate(KeyUpdateReason reason) {
   QUICHE_DCHECK(support_key_update_for_connection_);
   if (!next_decrypter_) {
@@ -4444,7 +4476,8 @@ bool QuicFramer::DoKeyUpdate(KeyUpdateReason reason) {
     next_decrypter_ = visitor_->AdvanceKeysAndCreateCurrentOneRttDecrypter();
   }
   std::unique_ptr<QuicEncrypter> next_encrypter =
-      visitor_->CreateCurrentOneRttEncrypter();
+      next_encrypter_ != nullptr ? std::move(next_encrypter_)
+                                 : visitor_->CreateCurrentOneRttEncrypter();
   if (!next_decrypter_ || !next_encrypter) {
     QUIC_BUG(quic_bug_10850_58) << "Failed to create next crypters";
     return false;
@@ -4599,8 +4632,8 @@ bool QuicFramer::ApplyHeaderProtection(EncryptionLevel level,
     return false;
   }
 
-  std::string mask = encrypter_[level]->GenerateHeaderProtectionMask(sample);
-  if (mask.empty()) {
+  QuicHeaderProtectionMask mask;
+  if (!encrypter_[level]->GenerateHeaderProtectionMaskInto(sample, &mask)) {
     QUIC_BUG(quic_bug_10850_61) << "Unable to generate header protection mask.";
     return false;
   }
@@ -4695,12 +4728,12 @@ bool QuicFramer::RemoveHeaderProtection(QuicDataReader* reader,
       return false;
     }
   }
-  std::string mask = decrypter->GenerateHeaderProtectionMask(&sample_reader);
-  QuicDataReader mask_reader(mask.data(), mask.size());
-  if (mask.empty()) {
+  QuicHeaderProtectionMask mask;
+  if (!decrypter->GenerateHeaderProtectionMaskInto(&sample_reader, &mask)) {
     QUIC_DVLOG(1) << "Failed to compute mask";
     return false;
   }
+  QuicDataReader mask_reader(mask.data(), mask.size());
 
   // Unmask the rest of the type byte.
   uint8_t bitmask = 0x1f;
@@ -5898,24 +5931,34 @@ bool QuicFramer::AppendIetfAckFrameAndTypeByte(const QuicAckFrame& frame,
   }
   QuicPacketNumber previous_smallest = iter->min();
   ++iter;
-  // Append remaining ACK blocks.
+  // Append remaining ACK blocks, as gap and ack range pairs.
   uint64_t appended_ack_blocks = 0;
-  for (; iter != frame.packets.rend(); ++iter) {
-    const uint64_t gap = previous_smallest - iter->max() - 1;
-    const uint64_t ack_range = iter->Length() - 1;
-
-    if (writer->remaining() < ecn_size ||
-        writer->remaining() - ecn_size <
-            static_cast<size_t>(QuicDataWriter::GetVarInt62Len(gap) +
-                                QuicDataWriter::GetVarInt62Len(ack_range))) {
-      // ACK range does not fit, truncate it.
-      break;
+  uint64_t block_values[2 * kIetfAckRangeBatchSize];
+  bool truncated = false;
+  while (!truncated && iter != frame.packets.rend()) {
+    size_t num_values = 0;
+    size_t batch_length = 0;
+    for (; iter != frame.packets.rend(); ++iter) {
+      if (num_values == 2 * kIetfAckRangeBatchSize) {
+        break;
+      }
+      const uint64_t gap = previous_smallest - iter->max() - 1;
+      const uint64_t ack_range = iter->Length() - 1;
+      const size_t block_length = QuicDataWriter::GetVarInt62Len(gap) +
+                                  QuicDataWriter::GetVarInt62Len(ack_range);
+      if (writer->remaining() < ecn_size + batch_length + block_length) {
+        // ACK range does not fit, truncate it.
+        truncated = true;
+        break;
+      }
+      block_values[num_values++] = gap;
+      block_values[num_values++] = ack_range;
+      batch_length += block_length;
+      previous_smallest = iter->min();
     }
-    const bool success =
-        writer->WriteVarInt62(gap) && writer->WriteVarInt62(ack_range);
+    const bool success = writer->WriteVarInt62Batch(block_values, num_values);
     QUICHE_DCHECK(success);
-    previous_smallest = iter->min();
-    ++appended_ack_blocks;
+    appended_ack_blocks += num_values / 2;
   }
 
   if (appended_ack_blocks < ack_block_count) {
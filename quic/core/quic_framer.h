@@ -553,6 +553,10 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   void SetKeyUpdateSupportForConnection(bool enabled);
   // Discard the decrypter for the previous key phase.
   void DiscardPreviousOneRttKeys();
+  // Derives the keys for the next key phase and creates their crypters ahead
+  // of time, so that a later key update only has to swap them in. Returns
+  // false if they cannot be created yet.
+  bool PrepareNextKeyPhase();
   // Update the key phase.
   bool DoKeyUpdate(KeyUpdateReason reason);
   // Returns the count of packets received that appeared to attempt a key
@@ -1153,6 +1157,9 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // Decrypter for the next key phase. May be null if next keys haven't been
   // generated yet.
   std::unique_ptr<QuicDecrypter> next_decrypter_;
+  // Encrypter for the next key phase. Only set by PrepareNextKeyPhase(), along
+  // with |next_decrypter_|.
+  std::unique_ptr<QuicEncrypter> next_encrypter_;
 
   // If this is a framer of a connection, this is the packet number of first
   // sending packet. If this is a framer of a framer of dispatcher, this is the
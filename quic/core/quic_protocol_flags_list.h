@@ -17,6 +17,13 @@ QUIC_PROTOCOL_FLAG(
     "future CHLO, and allow CHLO packets to be buffered until next "
     "iteration of the event loop.")
 
+QUIC_PROTOCOL_FLAG(
+    uint64_t, quic_buffered_packet_store_max_bytes, 1024 * 1024,
+    "Max number of bytes the dispatcher allocates to buffer packets for "
+    "connections which have not been created yet. 0 means no limit. Only "
+    "enforced if quic_reloadable_flag_quic_bound_buffered_packet_store_bytes "
+    "is true.")
+
 QUIC_PROTOCOL_FLAG(bool,
                    quic_disable_pacing_for_perf_tests,
                    false,
@@ -64,6 +71,20 @@ QUIC_PROTOCOL_FLAG(
     uint64_t, quic_recent_stateless_reset_addresses_lifetime_ms, 1000,
     "Max time that a client address lives in recent reset addresses set.")
 
+// Token bucket rates used to limit stateless resets and termination packets
+// when quic_rate_limit_stateless_responses is true. 0 means no limit.
+QUIC_PROTOCOL_FLAG(
+    uint64_t, quic_stateless_response_per_prefix_rate, 100,
+    "Max stateless responses per second sent to one source address prefix.")
+
+QUIC_PROTOCOL_FLAG(uint64_t, quic_stateless_response_global_rate, 10000,
+                   "Max stateless responses per second sent to all sources.")
+
+QUIC_PROTOCOL_FLAG(
+    uint64_t, quic_stateless_response_max_tracked_prefixes, 16384,
+    "Max number of source address prefixes tracked for stateless response "
+    "rate limiting.")
+
 QUIC_PROTOCOL_FLAG(double,
                    quic_bbr_cwnd_gain,
                    2.0f,
@@ -0,0 +1,128 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stateless_response_limiter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "quic/core/quic_constants.h"
+#include "quic/platform/api/quic_flag_utils.h"
+#include "quic/platform/api/quic_logging.h"
+#include "common/quiche_endian.h"
+
+namespace quic {
+
+namespace {
+
+// Every bucket holds up to one second worth of tokens.
+const QuicTime::Delta kBucketCapacity = QuicTime::Delta::FromSeconds(1);
+
+QuicTime::Delta RateToInterval(uint64_t rate) {
+  if (rate == 0) {
+    return QuicTime::Delta::Zero();
+  }
+  return QuicTime::Delta::FromMicroseconds(
+      std::max<uint64_t>(1, kNumMicrosPerSecond / rate));
+}
+
+}  // namespace
+
+QuicStatelessResponseLimiter::QuicStatelessResponseLimiter(
+    uint64_t per_prefix_rate,
+    uint64_t global_rate,
+    size_t max_tracked_prefixes)
+    : per_prefix_interval_(RateToInterval(per_prefix_rate)),
+      global_interval_(RateToInterval(global_rate)),
+      max_tracked_prefixes_(max_tracked_prefixes) {}
+
+bool QuicStatelessResponseLimiter::AllowResponse(
+    const QuicIpAddress& peer_address,
+    QuicTime now) {
+  if (!HasToken(global_full_time_, global_interval_, now)) {
+    QUIC_CODE_COUNT(quic_stateless_response_global_limit);
+    return false;
+  }
+
+  if (!per_prefix_interval_.IsZero()) {
+    const uint64_t key = GetPrefixKey(peer_address);
+    auto it = prefix_buckets_.find(key);
+    if (it == prefix_buckets_.end()) {
+      if (prefix_buckets_.size() >= max_tracked_prefixes_) {
+        PruneFullBuckets(now);
+      }
+      if (prefix_buckets_.size() >= max_tracked_prefixes_) {
+        QUIC_CODE_COUNT(quic_stateless_response_too_many_prefixes);
+        return false;
+      }
+      // A new bucket starts out full.
+      it = prefix_buckets_.emplace(key, now).first;
+    } else if (!HasToken(it->second, per_prefix_interval_, now)) {
+      QUIC_CODE_COUNT(quic_stateless_response_prefix_limit);
+      return false;
+    }
+    it->second = ConsumeToken(it->second, per_prefix_interval_, now);
+  }
+
+  global_full_time_ = ConsumeToken(global_full_time_, global_interval_, now);
+  return true;
+}
+
+// static
+uint64_t QuicStatelessResponseLimiter::GetPrefixKey(
+    const QuicIpAddress& peer_address) {
+  const QuicIpAddress address = peer_address.Normalized();
+  if (address.IsIPv4()) {
+    const uint32_t host =
+        quiche::QuicheEndian::NetToHost32(address.GetIPv4().s_addr);
+    // The lowest byte tags the key as IPv4.
+    return (uint64_t{host >> (32 - kIpv4PrefixLength)} << 8) | 0x04;
+  }
+  if (address.IsIPv6()) {
+    const in6_addr ipv6 = address.GetIPv6();
+    uint64_t high;
+    memcpy(&high, ipv6.s6_addr, sizeof(high));
+    high = quiche::QuicheEndian::NetToHost64(high);
+    // The lowest two bytes tag the key as IPv6.
+    return ((high >> (64 - kIpv6PrefixLength)) << 16) | 0x06;
+  }
+  return 0;
+}
+
+// static
+bool QuicStatelessResponseLimiter::HasToken(QuicTime full_time,
+                                            QuicTime::Delta interval,
+                                            QuicTime now) {
+  if (interval.IsZero()) {
+    return true;
+  }
+  return ConsumeToken(full_time, interval, now) - now <= kBucketCapacity;
+}
+
+// static
+QuicTime QuicStatelessResponseLimiter::ConsumeToken(QuicTime full_time,
+                                                    QuicTime::Delta interval,
+                                                    QuicTime now) {
+  return std::max(full_time, now) + interval;
+}
+
+void QuicStatelessResponseLimiter::PruneFullBuckets(QuicTime now) {
+  if (now < next_prune_time_) {
+    return;
+  }
+  // Any bucket charged before |now| is full by |now| + kBucketCapacity, so
+  // pruning more often than that would only find the same buckets again.
+  next_prune_time_ = now + kBucketCapacity;
+  for (auto it = prefix_buckets_.begin(); it != prefix_buckets_.end();) {
+    if (it->second <= now) {
+      prefix_buckets_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  QUIC_DVLOG(1) << "Pruned stateless response buckets, "
+                << prefix_buckets_.size() << " remaining";
+}
+
+}  // namespace quic
@@ -0,0 +1,89 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_STATELESS_RESPONSE_LIMITER_H_
+#define QUICHE_QUIC_CORE_QUIC_STATELESS_RESPONSE_LIMITER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "quic/core/quic_time.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_ip_address.h"
+
+namespace quic {
+
+// Limits the rate of stateless responses (stateless resets and copies of
+// termination packets) a server sends, so that a flood of spoofed packets
+// cannot make the server spend unbounded CPU on building responses or use it
+// as a reflector. There is one token bucket per source address prefix and one
+// shared by all sources; a response is allowed only if both have a token.
+//
+// Each bucket holds up to one second worth of tokens and is represented by the
+// time at which it will be full again, so checking and charging a bucket is a
+// comparison and an addition. A bucket which is full carries no information,
+// which allows the per-prefix buckets to be pruned cheaply.
+class QUIC_EXPORT_PRIVATE QuicStatelessResponseLimiter {
+ public:
+  // Length of the source address prefixes sharing a bucket.
+  static constexpr int kIpv4PrefixLength = 24;
+  static constexpr int kIpv6PrefixLength = 48;
+
+  // |per_prefix_rate| and |global_rate| are in responses per second, 0 means
+  // no limit. At most |max_tracked_prefixes| per-prefix buckets are kept;
+  // responses to new prefixes are refused while that many prefixes are being
+  // limited.
+  QuicStatelessResponseLimiter(uint64_t per_prefix_rate,
+                               uint64_t global_rate,
+                               size_t max_tracked_prefixes);
+  QuicStatelessResponseLimiter(const QuicStatelessResponseLimiter&) = delete;
+  QuicStatelessResponseLimiter& operator=(const QuicStatelessResponseLimiter&) =
+      delete;
+
+  // Returns true and consumes a token from the bucket of |peer_address|'s
+  // prefix and from the global bucket if both have one. Returns false without
+  // consuming anything otherwise.
+  bool AllowResponse(const QuicIpAddress& peer_address, QuicTime now);
+
+  // Number of per-prefix buckets currently tracked.
+  size_t num_tracked_prefixes() const { return prefix_buckets_.size(); }
+
+ private:
+  // Returns a key which is identical for all addresses in the same prefix of
+  // |peer_address|, and differs between IPv4 and IPv6 prefixes.
+  static uint64_t GetPrefixKey(const QuicIpAddress& peer_address);
+
+  // Returns true if the bucket which will be full at |full_time| has a token at
+  // |now|, when tokens are added every |interval|.
+  static bool HasToken(QuicTime full_time,
+                       QuicTime::Delta interval,
+                       QuicTime now);
+
+  // Returns the time at which the bucket which will be full at |full_time|
+  // will be full again after a token is taken from it at |now|.
+  static QuicTime ConsumeToken(QuicTime full_time,
+                               QuicTime::Delta interval,
+                               QuicTime now);
+
+  // Removes all per-prefix buckets which are full at |now|.
+  void PruneFullBuckets(QuicTime now);
+
+  // Time between two tokens being added to a per-prefix bucket and to the
+  // global bucket. Zero if the bucket is not limited.
+  const QuicTime::Delta per_prefix_interval_;
+  const QuicTime::Delta global_interval_;
+  const size_t max_tracked_prefixes_;
+
+  // Time at which the global bucket will be full.
+  QuicTime global_full_time_ = QuicTime::Zero();
+  // Maps prefix keys to the time at which their bucket will be full.
+  absl::flat_hash_map<uint64_t, QuicTime> prefix_buckets_;
+  // Earliest time at which prefix_buckets_ may be pruned again.
+  QuicTime next_prune_time_ = QuicTime::Zero();
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_STATELESS_RESPONSE_LIMITER_H_
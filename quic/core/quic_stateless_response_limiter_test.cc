@@ -0,0 +1,111 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/quic_stateless_response_limiter.h"
+
+#include <string>
+
+#include "quic/platform/api/quic_ip_address.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+QuicIpAddress Address(std::string address) {
+  QuicIpAddress ip;
+  EXPECT_TRUE(ip.FromString(address));
+  return ip;
+}
+
+class QuicStatelessResponseLimiterTest : public QuicTest {
+ protected:
+  QuicTime now_ = QuicTime::Zero() + QuicTime::Delta::FromSeconds(10);
+};
+
+TEST_F(QuicStatelessResponseLimiterTest, PerPrefixBurstAndRefill) {
+  QuicStatelessResponseLimiter limiter(/*per_prefix_rate=*/10,
+                                       /*global_rate=*/0,
+                                       /*max_tracked_prefixes=*/100);
+  const QuicIpAddress peer = Address("192.0.2.1");
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(limiter.AllowResponse(peer, now_)) << i;
+  }
+  EXPECT_FALSE(limiter.AllowResponse(peer, now_));
+
+  // One token is added every 100ms.
+  now_ = now_ + QuicTime::Delta::FromMilliseconds(99);
+  EXPECT_FALSE(limiter.AllowResponse(peer, now_));
+  now_ = now_ + QuicTime::Delta::FromMilliseconds(1);
+  EXPECT_TRUE(limiter.AllowResponse(peer, now_));
+  EXPECT_FALSE(limiter.AllowResponse(peer, now_));
+
+  // The bucket never holds more than one second worth of tokens.
+  now_ = now_ + QuicTime::Delta::FromSeconds(100);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(limiter.AllowResponse(peer, now_)) << i;
+  }
+  EXPECT_FALSE(limiter.AllowResponse(peer, now_));
+}
+
+TEST_F(QuicStatelessResponseLimiterTest, AddressesShareBucketOfTheirPrefix) {
+  QuicStatelessResponseLimiter limiter(/*per_prefix_rate=*/1,
+                                       /*global_rate=*/0,
+                                       /*max_tracked_prefixes=*/100);
+  EXPECT_TRUE(limiter.AllowResponse(Address("192.0.2.1"), now_));
+  EXPECT_FALSE(limiter.AllowResponse(Address("192.0.2.200"), now_));
+  EXPECT_FALSE(limiter.AllowResponse(Address("::ffff:192.0.2.7"), now_));
+  EXPECT_TRUE(limiter.AllowResponse(Address("192.0.3.1"), now_));
+
+  EXPECT_TRUE(limiter.AllowResponse(Address("2001:db8:1::1"), now_));
+  EXPECT_FALSE(limiter.AllowResponse(Address("2001:db8:1:ffff::2"), now_));
+  EXPECT_TRUE(limiter.AllowResponse(Address("2001:db8:2::1"), now_));
+  EXPECT_EQ(4u, limiter.num_tracked_prefixes());
+}
+
+TEST_F(QuicStatelessResponseLimiterTest, GlobalLimit) {
+  QuicStatelessResponseLimiter limiter(/*per_prefix_rate=*/0,
+                                       /*global_rate=*/5,
+                                       /*max_tracked_prefixes=*/100);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(limiter.AllowResponse(
+        Address("198.51.100." + std::to_string(i)), now_));
+  }
+  EXPECT_FALSE(limiter.AllowResponse(Address("203.0.113.1"), now_));
+  EXPECT_EQ(0u, limiter.num_tracked_prefixes());
+  now_ = now_ + QuicTime::Delta::FromMilliseconds(200);
+  EXPECT_TRUE(limiter.AllowResponse(Address("203.0.113.1"), now_));
+}
+
+TEST_F(QuicStatelessResponseLimiterTest, RefusedByPrefixDoesNotChargeGlobal) {
+  QuicStatelessResponseLimiter limiter(/*per_prefix_rate=*/1,
+                                       /*global_rate=*/2,
+                                       /*max_tracked_prefixes=*/100);
+  EXPECT_TRUE(limiter.AllowResponse(Address("192.0.2.1"), now_));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_FALSE(limiter.AllowResponse(Address("192.0.2.1"), now_));
+  }
+  EXPECT_TRUE(limiter.AllowResponse(Address("198.51.100.1"), now_));
+  EXPECT_FALSE(limiter.AllowResponse(Address("203.0.113.1"), now_));
+}
+
+TEST_F(QuicStatelessResponseLimiterTest, FullBucketsArePruned) {
+  QuicStatelessResponseLimiter limiter(/*per_prefix_rate=*/10,
+                                       /*global_rate=*/0,
+                                       /*max_tracked_prefixes=*/2);
+  EXPECT_TRUE(limiter.AllowResponse(Address("192.0.2.1"), now_));
+  EXPECT_TRUE(limiter.AllowResponse(Address("198.51.100.1"), now_));
+  // No room for a third prefix while the others are being limited.
+  EXPECT_FALSE(limiter.AllowResponse(Address("203.0.113.1"), now_));
+  EXPECT_EQ(2u, limiter.num_tracked_prefixes());
+
+  // Once the existing buckets are full again they are dropped.
+  now_ = now_ + QuicTime::Delta::FromSeconds(1);
+  EXPECT_TRUE(limiter.AllowResponse(Address("203.0.113.1"), now_));
+  EXPECT_EQ(1u, limiter.num_tracked_prefixes());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -76,6 +76,10 @@ QuicTimeWaitListManager::QuicTimeWaitListManager(
     QuicAlarmFactory* alarm_factory)
     : time_wait_period_(QuicTime::Delta::FromSeconds(
           GetQuicFlag(FLAGS_quic_time_wait_list_seconds))),
+      stateless_response_limiter_(
+          GetQuicFlag(FLAGS_quic_stateless_response_per_prefix_rate),
+          GetQuicFlag(FLAGS_quic_stateless_response_global_rate),
+          GetQuicFlag(FLAGS_quic_stateless_response_max_tracked_prefixes)),
       connection_id_clean_up_alarm_(
           alarm_factory->CreateAlarm(new ConnectionIdCleanUpAlarm(this))),
       clock_(clock),
@@ -88,36 +92,50 @@ QuicTimeWaitListManager::~QuicTimeWaitListManager() {
   connection_id_clean_up_alarm_->Cancel();
 }
 
-QuicTimeWaitListManager::ConnectionIdMap::iterator
-QuicTimeWaitListManager::FindConnectionIdDataInMap(
+QuicTimeWaitListManager::ConnectionIdData*
+QuicTimeWaitListManager::FindConnectionIdData(
     const QuicConnectionId& connection_id) {
-  auto it = indirect_connection_id_map_.find(connection_id);
-  if (it == indirect_connection_id_map_.end()) {
-    return connection_id_map_.end();
+  auto it = connection_id_map_.find(connection_id);
+  if (it == connection_id_map_.end()) {
+    return nullptr;
   }
-  return connection_id_map_.find(it->second);
+  QUICHE_DCHECK_GE(it->second, first_entry_sequence_number_);
+  return &time_wait_entries_[it->second - first_entry_sequence_number_];
 }
 
-void QuicTimeWaitListManager::AddConnectionIdDataToMap(
-    const QuicConnectionId& canonical_connection_id,
+void QuicTimeWaitListManager::AddConnectionIdData(
     int num_packets,
     TimeWaitAction action,
     TimeWaitConnectionInfo info) {
+  const uint64_t sequence_number =
+      first_entry_sequence_number_ + time_wait_entries_.size();
   for (const auto& cid : info.active_connection_ids) {
-    indirect_connection_id_map_[cid] = canonical_connection_id;
+    connection_id_map_[cid] = sequence_number;
   }
-  ConnectionIdData data(num_packets, clock_->ApproximateNow(), action,
-                        std::move(info));
-  connection_id_map_.emplace(
-      std::make_pair(canonical_connection_id, std::move(data)));
+  time_wait_entries_.emplace_back(num_packets, clock_->ApproximateNow(),
+                                  action, std::move(info));
+  ++num_connections_;
 }
 
-void QuicTimeWaitListManager::RemoveConnectionDataFromMap(
-    ConnectionIdMap::iterator it) {
-  for (const auto& cid : it->second.info.active_connection_ids) {
-    indirect_connection_id_map_.erase(cid);
+void QuicTimeWaitListManager::RemoveConnectionData(ConnectionIdData* data) {
+  QUICHE_DCHECK(!data->cleared());
+  for (const auto& cid : data->active_connection_ids) {
+    // Do not unmap a connection ID which has since been claimed by a newer
+    // entry.
+    if (FindConnectionIdData(cid) == data) {
+      connection_id_map_.erase(cid);
+    }
+  }
+  data->Clear();
+  --num_connections_;
+  PopClearedEntries();
+}
+
+void QuicTimeWaitListManager::PopClearedEntries() {
+  while (!time_wait_entries_.empty() && time_wait_entries_.front().cleared()) {
+    time_wait_entries_.pop_front();
+    ++first_entry_sequence_number_;
   }
-  connection_id_map_.erase(it);
 }
 
 void QuicTimeWaitListManager::AddConnectionIdToTimeWait(
@@ -130,29 +148,29 @@ void QuicTimeWaitListManager::AddConnectionIdToTimeWait(
                 !info.termination_packets.empty());
   QUICHE_DCHECK(action != DO_NOTHING || info.ietf_quic);
   int num_packets = 0;
-  auto it = FindConnectionIdDataInMap(canonical_connection_id);
-  const bool new_connection_id = it == connection_id_map_.end();
+  ConnectionIdData* existing_data =
+      FindConnectionIdData(canonical_connection_id);
+  const bool new_connection_id = existing_data == nullptr;
   if (!new_connection_id) {  // Replace record if it is reinserted.
-    num_packets = it->second.num_packets;
-    RemoveConnectionDataFromMap(it);
+    num_packets = existing_data->num_packets;
+    RemoveConnectionData(existing_data);
   }
   TrimTimeWaitListIfNeeded();
   int64_t max_connections =
       GetQuicFlag(FLAGS_quic_time_wait_list_max_connections);
-  QUICHE_DCHECK(connection_id_map_.empty() ||
+  QUICHE_DCHECK(num_connections() == 0 ||
                 num_connections() < static_cast<size_t>(max_connections));
   if (new_connection_id) {
     for (const auto& cid : info.active_connection_ids) {
       visitor_->OnConnectionAddedToTimeWaitList(cid);
     }
   }
-  AddConnectionIdDataToMap(canonical_connection_id, num_packets, action,
-                           std::move(info));
+  AddConnectionIdData(num_packets, action, std::move(info));
 }
 
 bool QuicTimeWaitListManager::IsConnectionIdInTimeWait(
     QuicConnectionId connection_id) const {
-  return indirect_connection_id_map_.contains(connection_id);
+  return connection_id_map_.contains(connection_id);
 }
 
 void QuicTimeWaitListManager::OnBlockedWriterCanWrite() {
@@ -176,10 +194,9 @@ void QuicTimeWaitListManager::ProcessPacket(
   QUICHE_DCHECK(IsConnectionIdInTimeWait(connection_id));
   // TODO(satyamshekhar): Think about handling packets from different peer
   // addresses.
-  auto it = FindConnectionIdDataInMap(connection_id);
-  QUICHE_DCHECK(it != connection_id_map_.end());
+  ConnectionIdData* connection_data = FindConnectionIdData(connection_id);
+  QUICHE_DCHECK(connection_data != nullptr);
   // Increment the received packet count.
-  ConnectionIdData* connection_data = &it->second;
   ++(connection_data->num_packets);
   const QuicTime now = clock_->ApproximateNow();
   QuicTime::Delta delta = QuicTime::Delta::Zero();
@@ -187,7 +204,7 @@ void QuicTimeWaitListManager::ProcessPacket(
     delta = now - connection_data->time_added;
   }
   OnPacketReceivedForKnownConnection(connection_data->num_packets, delta,
-                                     connection_data->info.srtt);
+                                     connection_data->srtt);
 
   if (!ShouldSendResponse(connection_data->num_packets)) {
     QUIC_DLOG(INFO) << "Processing " << connection_id << " in time wait state: "
@@ -197,55 +214,49 @@ void QuicTimeWaitListManager::ProcessPacket(
 
   QUIC_DLOG(INFO) << "Processing " << connection_id << " in time wait state: "
                   << "header format=" << header_format
-                  << " ietf=" << connection_data->info.ietf_quic
+                  << " ietf=" << connection_data->ietf_quic
                   << ", action=" << connection_data->action
                   << ", number termination packets="
-                  << connection_data->info.termination_packets.size();
+                  << connection_data->num_termination_packets();
   switch (connection_data->action) {
     case SEND_TERMINATION_PACKETS:
-      if (connection_data->info.termination_packets.empty()) {
+      if (connection_data->num_termination_packets() == 0) {
         QUIC_BUG(quic_bug_10608_1) << "There are no termination packets.";
         return;
       }
       switch (header_format) {
         case IETF_QUIC_LONG_HEADER_PACKET:
-          if (!connection_data->info.ietf_quic) {
+          if (!connection_data->ietf_quic) {
             QUIC_CODE_COUNT(quic_received_long_header_packet_for_gquic);
           }
           break;
         case IETF_QUIC_SHORT_HEADER_PACKET:
-          if (!connection_data->info.ietf_quic) {
+          if (!connection_data->ietf_quic) {
             QUIC_CODE_COUNT(quic_received_short_header_packet_for_gquic);
           }
           // Send stateless reset in response to short header packets.
           SendPublicReset(self_address, peer_address, connection_id,
-                          connection_data->info.ietf_quic,
+                          connection_data->ietf_quic,
                           received_packet_length, std::move(packet_context));
           return;
         case GOOGLE_QUIC_PACKET:
-          if (connection_data->info.ietf_quic) {
+          if (connection_data->ietf_quic) {
             QUIC_CODE_COUNT(quic_received_gquic_packet_for_ietf_quic);
           }
           break;
       }
 
-      for (const auto& packet : connection_data->info.termination_packets) {
-        SendOrQueuePacket(std::make_unique<QueuedPacket>(
-                              self_address, peer_address, packet->Clone()),
-                          packet_context.get());
-      }
+      SendTerminationPackets(*connection_data, self_address, peer_address,
+                             packet_context.get());
       return;
 
     case SEND_CONNECTION_CLOSE_PACKETS:
-      if (connection_data->info.termination_packets.empty()) {
+      if (connection_data->num_termination_packets() == 0) {
         QUIC_BUG(quic_bug_10608_2) << "There are no termination packets.";
         return;
       }
-      for (const auto& packet : connection_data->info.termination_packets) {
-        SendOrQueuePacket(std::make_unique<QueuedPacket>(
-                              self_address, peer_address, packet->Clone()),
-                          packet_context.get());
-      }
+      SendTerminationPackets(*connection_data, self_address, peer_address,
+                             packet_context.get());
       return;
 
     case SEND_STATELESS_RESET:
@@ -253,12 +264,30 @@ void QuicTimeWaitListManager::ProcessPacket(
         QUIC_CODE_COUNT(quic_stateless_reset_long_header_packet);
       }
       SendPublicReset(self_address, peer_address, connection_id,
-                      connection_data->info.ietf_quic, received_packet_length,
+                      connection_data->ietf_quic, received_packet_length,
                       std::move(packet_context));
       return;
     case DO_NOTHING:
       QUIC_CODE_COUNT(quic_time_wait_list_do_nothing);
-      QUICHE_DCHECK(connection_data->info.ietf_quic);
+      QUICHE_DCHECK(connection_data->ietf_quic);
+  }
+}
+
+void QuicTimeWaitListManager::SendTerminationPackets(
+    const ConnectionIdData& connection_data,
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    const QuicPerPacketContext* packet_context) {
+  if (ShouldRateLimitResponse(peer_address)) {
+    return;
+  }
+  for (size_t i = 0; i < connection_data.num_termination_packets(); ++i) {
+    absl::string_view packet = connection_data.termination_packet(i);
+    SendOrQueuePacket(
+        std::make_unique<QueuedPacket>(
+            self_address, peer_address,
+            QuicEncryptedPacket(packet.data(), packet.length()).Clone()),
+        packet_context);
   }
 }
 
@@ -293,6 +322,20 @@ bool QuicTimeWaitListManager::ShouldSendResponse(int received_packet_count) {
   return (received_packet_count & (received_packet_count - 1)) == 0;
 }
 
+bool QuicTimeWaitListManager::ShouldRateLimitResponse(
+    const QuicSocketAddress& peer_address) {
+  if (!GetQuicReloadableFlag(quic_rate_limit_stateless_responses)) {
+    return false;
+  }
+  QUIC_RELOADABLE_FLAG_COUNT(quic_rate_limit_stateless_responses);
+  if (stateless_response_limiter_.AllowResponse(peer_address.host(),
+                                                clock_->ApproximateNow())) {
+    return false;
+  }
+  QUIC_DVLOG(1) << "Rate limited stateless response to " << peer_address;
+  return true;
+}
+
 void QuicTimeWaitListManager::SendPublicReset(
     const QuicSocketAddress& self_address,
     const QuicSocketAddress& peer_address,
@@ -300,6 +343,10 @@ void QuicTimeWaitListManager::SendPublicReset(
     bool ietf_quic,
     size_t received_packet_length,
     std::unique_ptr<QuicPerPacketContext> packet_context) {
+  // Check the limit before building the reset, which is the expensive part.
+  if (ShouldRateLimitResponse(peer_address)) {
+    return;
+  }
   if (ietf_quic) {
     std::unique_ptr<QuicEncryptedPacket> ietf_reset_packet =
         BuildIetfStatelessResetPacket(connection_id, received_packet_length);
@@ -416,9 +463,8 @@ bool QuicTimeWaitListManager::WriteToWire(QueuedPacket* queued_packet) {
 
 void QuicTimeWaitListManager::SetConnectionIdCleanUpAlarm() {
   QuicTime::Delta next_alarm_interval = QuicTime::Delta::Zero();
-  if (!connection_id_map_.empty()) {
-    QuicTime oldest_connection_id =
-        connection_id_map_.begin()->second.time_added;
+  if (!time_wait_entries_.empty()) {
+    QuicTime oldest_connection_id = time_wait_entries_.front().time_added;
     QuicTime now = clock_->ApproximateNow();
     if (now - oldest_connection_id < time_wait_period_) {
       next_alarm_interval = oldest_connection_id + time_wait_period_ - now;
@@ -437,19 +483,20 @@ void QuicTimeWaitListManager::SetConnectionIdCleanUpAlarm() {
 
 bool QuicTimeWaitListManager::MaybeExpireOldestConnection(
     QuicTime expiration_time) {
-  if (connection_id_map_.empty()) {
+  if (time_wait_entries_.empty()) {
     return false;
   }
-  auto it = connection_id_map_.begin();
-  QuicTime oldest_connection_id_time = it->second.time_added;
+  ConnectionIdData* oldest_data = &time_wait_entries_.front();
+  QUICHE_DCHECK(!oldest_data->cleared());
+  QuicTime oldest_connection_id_time = oldest_data->time_added;
   if (oldest_connection_id_time > expiration_time) {
     // Too recent, don't retire.
     return false;
   }
   // This connection_id has lived its age, retire it now.
-  QUIC_DLOG(INFO) << "Connection " << it->first
+  QUIC_DLOG(INFO) << "Connection " << oldest_data->active_connection_ids.front()
                   << " expired from time wait list";
-  RemoveConnectionDataFromMap(it);
+  RemoveConnectionData(oldest_data);
   if (expiration_time == QuicTime::Infinite()) {
     QUIC_CODE_COUNT(quic_time_wait_list_trim_full);
   } else {
@@ -474,7 +521,7 @@ void QuicTimeWaitListManager::TrimTimeWaitListIfNeeded() {
   if (kMaxConnections < 0) {
     return;
   }
-  while (!connection_id_map_.empty() &&
+  while (num_connections() > 0 &&
          num_connections() >= static_cast<size_t>(kMaxConnections)) {
     MaybeExpireOldestConnection(QuicTime::Infinite());
   }
@@ -486,15 +533,50 @@ QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData(
     TimeWaitAction action,
     TimeWaitConnectionInfo info)
     : num_packets(num_packets),
-      time_added(time_added),
       action(action),
-      info(std::move(info)) {}
+      ietf_quic(info.ietf_quic),
+      time_added(time_added),
+      srtt(info.srtt),
+      active_connection_ids(std::move(info.active_connection_ids)) {
+  size_t total_length = 0;
+  for (const auto& packet : info.termination_packets) {
+    total_length += packet->length();
+  }
+  termination_packet_buffer.reserve(total_length);
+  for (const auto& packet : info.termination_packets) {
+    termination_packet_buffer.append(packet->data(), packet->length());
+    termination_packet_lengths.push_back(packet->length());
+  }
+}
 
 QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData(
     ConnectionIdData&& other) = default;
 
+QuicTimeWaitListManager::ConnectionIdData&
+QuicTimeWaitListManager::ConnectionIdData::operator=(
+    ConnectionIdData&& other) = default;
+
 QuicTimeWaitListManager::ConnectionIdData::~ConnectionIdData() = default;
 
+absl::string_view QuicTimeWaitListManager::ConnectionIdData::termination_packet(
+    size_t index) const {
+  QUICHE_DCHECK_LT(index, termination_packet_lengths.size());
+  size_t offset = 0;
+  for (size_t i = 0; i < index; ++i) {
+    offset += termination_packet_lengths[i];
+  }
+  return absl::string_view(termination_packet_buffer)
+      .substr(offset, termination_packet_lengths[index]);
+}
+
+void QuicTimeWaitListManager::ConnectionIdData::Clear() {
+  // Swap with empty containers to release the memory right away, as the entry
+  // itself may stay in time_wait_entries_ for up to the time-wait period.
+  std::vector<QuicConnectionId>().swap(active_connection_ids);
+  std::string().swap(termination_packet_buffer);
+  absl::InlinedVector<QuicPacketLength, 2>().swap(termination_packet_lengths);
+}
+
 StatelessResetToken QuicTimeWaitListManager::GetStatelessResetToken(
     QuicConnectionId connection_id) const {
   return QuicUtils::GenerateStatelessResetToken(connection_id);
@@ -12,15 +12,18 @@
 #include <memory>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
 #include "quic/core/quic_blocked_writer_interface.h"
 #include "quic/core/quic_connection_id.h"
 #include "quic/core/quic_framer.h"
 #include "quic/core/quic_packet_writer.h"
 #include "quic/core/quic_packets.h"
 #include "quic/core/quic_session.h"
+#include "quic/core/quic_stateless_response_limiter.h"
 #include "quic/core/quic_types.h"
 #include "quic/platform/api/quic_flags.h"
-#include "common/quiche_linked_hash_map.h"
+#include "common/quiche_circular_deque.h"
 
 namespace quic {
 
@@ -146,7 +149,7 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
   void TrimTimeWaitListIfNeeded();
 
   // The number of connections on the time-wait list.
-  size_t num_connections() const { return connection_id_map_.size(); }
+  size_t num_connections() const { return num_connections_; }
 
   // Sends a version negotiation packet for |server_connection_id| and
   // |client_connection_id| announcing support for |supported_versions| to
@@ -236,6 +239,10 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
   // number of received packets.
   bool ShouldSendResponse(int received_packet_count);
 
+  // Returns true if a stateless response to |peer_address| must be dropped
+  // because too many have been sent to its prefix or in total recently.
+  bool ShouldRateLimitResponse(const QuicSocketAddress& peer_address);
+
   // Sends the packet out. Returns true if the packet was successfully consumed.
   // If the writer got blocked and did not buffer the packet, we'll need to keep
   // the packet and retry sending. In case of all other errors we drop the
@@ -248,10 +255,11 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
   // Removes the oldest connection from the time-wait list if it was added prior
   // to "expiration_time".  To unconditionally remove the oldest connection, use
   // a QuicTime::Delta:Infinity().  This function modifies the
-  // connection_id_map_.  If you plan to call this function in a loop, any
-  // iterators that you hold before the call to this function may be invalid
-  // afterward.  Returns true if the oldest connection was expired.  Returns
-  // false if the map is empty or the oldest connection has not expired.
+  // time_wait_entries_.  If you plan to call this function in a loop, any
+  // pointers to entries that you hold before the call to this function may be
+  // invalid afterward.  Returns true if the oldest connection was expired.
+  // Returns false if the list is empty or the oldest connection has not
+  // expired.
   bool MaybeExpireOldestConnection(QuicTime expiration_time);
 
   // Called when a packet is received for a connection in this time wait list.
@@ -264,9 +272,10 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
       QuicConnectionId connection_id,
       size_t received_packet_length);
 
-  // A map from a recently closed connection_id to the number of packets
-  // received after the termination of the connection bound to the
-  // connection_id.
+  // A recently closed connection together with the number of packets received
+  // after the termination of the connection. Termination packets are copied
+  // back to back into a single buffer so that an entry costs at most one
+  // allocation for packets regardless of how many the connection provided.
   struct QUIC_NO_EXPORT ConnectionIdData {
     ConnectionIdData(int num_packets,
                      QuicTime time_added,
@@ -275,46 +284,70 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
 
     ConnectionIdData(const ConnectionIdData& other) = delete;
     ConnectionIdData(ConnectionIdData&& other);
+    ConnectionIdData& operator=(ConnectionIdData&& other);
 
     ~ConnectionIdData();
 
+    // Returns the |index|th termination packet.
+    absl::string_view termination_packet(size_t index) const;
+    size_t num_termination_packets() const {
+      return termination_packet_lengths.size();
+    }
+
+    // Drops the connection IDs and termination packets of this entry. The
+    // entry itself is released once it reaches the front of
+    // time_wait_entries_.
+    void Clear();
+    // True if Clear() has been called on this entry.
+    bool cleared() const { return active_connection_ids.empty(); }
+
     int num_packets;
-    QuicTime time_added;
     TimeWaitAction action;
-    TimeWaitConnectionInfo info;
+    bool ietf_quic;
+    QuicTime time_added;
+    QuicTime::Delta srtt;
+    std::vector<QuicConnectionId> active_connection_ids;
+    std::string termination_packet_buffer;
+    absl::InlinedVector<QuicPacketLength, 2> termination_packet_lengths;
   };
 
-  // QuicheLinkedHashMap allows lookup by ConnectionId
-  // and traversal in add order.
-  using ConnectionIdMap = quiche::QuicheLinkedHashMap<QuicConnectionId,
-                                                      ConnectionIdData,
-                                                      QuicConnectionIdHash>;
-  // Do not use find/emplace/erase on this map directly. Use
-  // FindConnectionIdDataInMap, AddConnectionIdDateToMap,
-  // RemoveConnectionDataFromMap instead.
-  ConnectionIdMap connection_id_map_;
-
-  // TODO(haoyuewang) Consider making connection_id_map_ a map of shared pointer
-  // and remove the indirect map.
-  // A connection can have multiple unretired ConnectionIds when it is closed.
-  // These Ids have the same ConnectionIdData entry in connection_id_map_. To
-  // find the entry, look up the cannoical ConnectionId in
-  // indirect_connection_id_map_ first, and look up connection_id_map_ with the
-  // cannoical ConnectionId.
-  absl::flat_hash_map<QuicConnectionId, QuicConnectionId, QuicConnectionIdHash>
-      indirect_connection_id_map_;
-
-  // Find an iterator for the given connection_id. Returns
-  // connection_id_map_.end() if none found.
-  ConnectionIdMap::iterator FindConnectionIdDataInMap(
-      const QuicConnectionId& connection_id);
-  // Inserts a ConnectionIdData entry to connection_id_map_.
-  void AddConnectionIdDataToMap(const QuicConnectionId& canonical_connection_id,
-                                int num_packets,
-                                TimeWaitAction action,
-                                TimeWaitConnectionInfo info);
-  // Removes a ConnectionIdData entry in connection_id_map_.
-  void RemoveConnectionDataFromMap(ConnectionIdMap::iterator it);
+  // Entries in the order they were added, which is also the order in which
+  // they expire. Entries are stored inline so that adding a connection does
+  // not allocate a node per entry, and the oldest entries are always at the
+  // front. An entry is identified by its sequence number: the entry with
+  // sequence number n lives at index n - first_entry_sequence_number_.
+  quiche::QuicheCircularDeque<ConnectionIdData> time_wait_entries_;
+  // Sequence number of time_wait_entries_.front().
+  uint64_t first_entry_sequence_number_ = 0;
+  // Number of entries in time_wait_entries_ which have not been cleared.
+  size_t num_connections_ = 0;
+
+  // Maps every active connection ID of every connection in time wait state to
+  // the sequence number of its entry in time_wait_entries_. A connection with
+  // multiple unretired connection IDs has one map entry per connection ID, all
+  // pointing to the same time_wait_entries_ entry.
+  absl::flat_hash_map<QuicConnectionId, uint64_t, QuicConnectionIdHash>
+      connection_id_map_;
+
+  // Returns the entry for the given connection_id, or nullptr if none found.
+  ConnectionIdData* FindConnectionIdData(const QuicConnectionId& connection_id);
+  // Appends an entry to time_wait_entries_ and maps all its active connection
+  // IDs to it.
+  void AddConnectionIdData(int num_packets,
+                           TimeWaitAction action,
+                           TimeWaitConnectionInfo info);
+  // Unmaps all active connection IDs of |data| and clears it. The cleared
+  // entry is released once it reaches the front of time_wait_entries_.
+  void RemoveConnectionData(ConnectionIdData* data);
+  // Pops cleared entries off the front of time_wait_entries_.
+  void PopClearedEntries();
+
+  // Sends copies of the termination packets of |connection_data| to
+  // |peer_address|.
+  void SendTerminationPackets(const ConnectionIdData& connection_data,
+                              const QuicSocketAddress& self_address,
+                              const QuicSocketAddress& peer_address,
+                              const QuicPerPacketContext* packet_context);
 
   // Pending termination packets that need to be sent out to the peer when we
   // are given a chance to write by the dispatcher.
@@ -324,6 +357,9 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
   // Time period for which connection_ids should remain in time wait state.
   const QuicTime::Delta time_wait_period_;
 
+  // Limits the rate of stateless resets and termination packets.
+  QuicStatelessResponseLimiter stateless_response_limiter_;
+
   // Alarm to clean up connection_ids that have out lived their duration in
   // time wait state.
   std::unique_ptr<QuicAlarm> connection_id_clean_up_alarm_;
@@ -9,6 +9,7 @@
 #include <ostream>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
 #include "quic/core/crypto/crypto_protocol.h"
 #include "quic/core/crypto/null_encrypter.h"
 #include "quic/core/crypto/quic_decrypter.h"
@@ -569,6 +570,62 @@ TEST_F(QuicTimeWaitListManagerTest, AddConnectionIdTwice) {
   EXPECT_EQ(0u, time_wait_list_manager_.num_connections());
 }
 
+TEST_F(QuicTimeWaitListManagerTest, ReAddedConnectionIdExpiresWithNewEntry) {
+  const QuicConnectionId connection_id1 = TestConnectionId(1);
+  const QuicConnectionId connection_id2 = TestConnectionId(2);
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id1));
+  AddConnectionId(connection_id1, QuicTimeWaitListManager::DO_NOTHING);
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id2));
+  AddConnectionId(connection_id2, QuicTimeWaitListManager::DO_NOTHING);
+
+  // Re-adding connection_id1 moves it behind connection_id2.
+  const QuicTime::Delta time_wait_period =
+      QuicTimeWaitListManagerPeer::time_wait_period(&time_wait_list_manager_);
+  const QuicTime::Delta half_period = time_wait_period * 0.5;
+  clock_.AdvanceTime(half_period);
+  AddConnectionId(connection_id1, QuicTimeWaitListManager::DO_NOTHING);
+  EXPECT_EQ(2u, time_wait_list_manager_.num_connections());
+
+  clock_.AdvanceTime(half_period);
+  EXPECT_CALL(alarm_factory_, OnAlarmSet(_, clock_.Now() + half_period));
+  time_wait_list_manager_.CleanUpOldConnectionIds();
+  EXPECT_TRUE(IsConnectionIdInTimeWait(connection_id1));
+  EXPECT_FALSE(IsConnectionIdInTimeWait(connection_id2));
+  EXPECT_EQ(1u, time_wait_list_manager_.num_connections());
+
+  clock_.AdvanceTime(half_period);
+  EXPECT_CALL(alarm_factory_, OnAlarmSet(_, clock_.Now() + time_wait_period));
+  time_wait_list_manager_.CleanUpOldConnectionIds();
+  EXPECT_FALSE(IsConnectionIdInTimeWait(connection_id1));
+  EXPECT_EQ(0u, time_wait_list_manager_.num_connections());
+}
+
+TEST_F(QuicTimeWaitListManagerTest, SendTerminationPacketsInOrder) {
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id_));
+  std::vector<std::unique_ptr<QuicEncryptedPacket>> termination_packets;
+  termination_packets.push_back(
+      std::make_unique<QuicEncryptedPacket>("first", 5));
+  termination_packets.push_back(
+      std::make_unique<QuicEncryptedPacket>("second packet", 13));
+  AddConnectionId(connection_id_, QuicVersionMax(),
+                  QuicTimeWaitListManager::SEND_CONNECTION_CLOSE_PACKETS,
+                  &termination_packets);
+
+  std::vector<std::string> written_packets;
+  EXPECT_CALL(writer_,
+              WritePacket(_, _, self_address_.host(), peer_address_, _))
+      .Times(2)
+      .WillRepeatedly([&written_packets](const char* buffer, size_t buf_len,
+                                         const QuicIpAddress&,
+                                         const QuicSocketAddress&,
+                                         PerPacketOptions*) {
+        written_packets.emplace_back(buffer, buf_len);
+        return WriteResult(WRITE_STATUS_OK, buf_len);
+      });
+  ProcessPacket(connection_id_);
+  EXPECT_THAT(written_packets, testing::ElementsAre("first", "second packet"));
+}
+
 TEST_F(QuicTimeWaitListManagerTest, ConnectionIdsOrderedByTime) {
   // Simple randomization: the values of connection_ids are randomly swapped.
   // If the container is broken, the test will be 50% flaky.
@@ -783,6 +840,51 @@ TEST_F(QuicTimeWaitListManagerTest, TooManyPendingPackets) {
                     &time_wait_list_manager_));
 }
 
+// Replays a flood of short header packets with random connection IDs from a
+// handful of spoofed source prefixes, and verifies that the number of
+// stateless resets stays within the configured rates.
+TEST_F(QuicTimeWaitListManagerTest, RateLimitStatelessResetFlood) {
+  SetQuicReloadableFlag(quic_rate_limit_stateless_responses, true);
+  SetQuicFlag(FLAGS_quic_stateless_response_per_prefix_rate, 10);
+  SetQuicFlag(FLAGS_quic_stateless_response_global_rate, 25);
+  QuicTimeWaitListManager time_wait_list_manager(&writer_, &visitor_, &clock_,
+                                                 &alarm_factory_);
+
+  size_t num_resets = 0;
+  EXPECT_CALL(writer_, WritePacket(_, _, _, _, _))
+      .WillRepeatedly([&num_resets](const char*, size_t buf_len,
+                                    const QuicIpAddress&,
+                                    const QuicSocketAddress&,
+                                    PerPacketOptions*) {
+        ++num_resets;
+        return WriteResult(WRITE_STATUS_OK, buf_len);
+      });
+
+  const size_t kNumPrefixes = 4;
+  const size_t kPacketsPerMillisecond = 10;
+  const size_t kFloodMilliseconds = 2000;
+  QuicRandom* random = QuicRandom::GetInstance();
+  for (size_t ms = 0; ms < kFloodMilliseconds; ++ms) {
+    for (size_t i = 0; i < kPacketsPerMillisecond; ++i) {
+      QuicIpAddress source;
+      ASSERT_TRUE(source.FromString(
+          absl::StrCat("10.0.", random->RandUint64() % kNumPrefixes, ".",
+                       random->RandUint64() % 256)));
+      time_wait_list_manager.SendPublicReset(
+          self_address_, QuicSocketAddress(source, kTestPort),
+          TestConnectionId(random->RandUint64()), /*ietf_quic=*/true,
+          /*received_packet_length=*/kTestPacketSize,
+          /*packet_context=*/nullptr);
+    }
+    clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(1));
+  }
+  // Each bucket starts with one second worth of tokens and is refilled at its
+  // rate during the 2 seconds of the flood. The global bucket is the tighter
+  // limit here and allows at most 25 * 3 resets out of 20000 packets.
+  EXPECT_LE(num_resets, 75u);
+  EXPECT_GE(num_resets, 50u);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
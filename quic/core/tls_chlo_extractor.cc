@@ -16,11 +16,15 @@
 #include "quic/core/quic_time.h"
 #include "quic/core/quic_types.h"
 #include "quic/core/quic_versions.h"
+#include "quic/core/tls_chlo_parser.h"
 #include "quic/platform/api/quic_bug_tracker.h"
+#include "quic/platform/api/quic_flag_utils.h"
+#include "quic/platform/api/quic_flags.h"
 
 namespace quic {
 
 namespace {
+
 bool HasExtension(const SSL_CLIENT_HELLO* client_hello, uint16_t extension) {
   const uint8_t* unused_extension_bytes;
   size_t unused_extension_len;
@@ -60,6 +64,9 @@ TlsChloExtractor& TlsChloExtractor::operator=(TlsChloExtractor&& other) {
       other.parsed_crypto_frame_in_this_packet_;
   alpns_ = std::move(other.alpns_);
   server_name_ = std::move(other.server_name_);
+  resumption_attempted_ = other.resumption_attempted_;
+  early_data_attempted_ = other.early_data_attempted_;
+  chlo_buffer_ = std::move(other.chlo_buffer_);
   return *this;
 }
 
@@ -179,10 +186,81 @@ bool TlsChloExtractor::OnCryptoFrame(const QuicCryptoFrame& frame) {
 // Called by the QuicStreamSequencer when it receives a CRYPTO frame that
 // advances the amount of contiguous data we now have starting from offset 0.
 void TlsChloExtractor::OnDataAvailable() {
+  if (ssl_ != nullptr ||
+      !GetQuicReloadableFlag(quic_parse_tls_chlo_without_ssl)) {
+    ParseChloWithSsl();
+    return;
+  }
+  QUIC_RELOADABLE_FLAG_COUNT(quic_parse_tls_chlo_without_ssl);
+
+  // Buffer the data ourselves, BoringSSL is only needed if TlsChloParser
+  // cannot handle the CHLO.
+  struct iovec iov;
+  while (crypto_stream_sequencer_.GetReadableRegion(&iov)) {
+    if (!HasParsedFullChlo()) {
+      chlo_buffer_.append(static_cast<const char*>(iov.iov_base),
+                          iov.iov_len);
+    }
+    crypto_stream_sequencer_.MarkConsumed(iov.iov_len);
+  }
+  if (HasParsedFullChlo() || !MaybeAttemptToParseChloLength()) {
+    return;
+  }
+  AttemptToParseFullChlo();
+}
+
+bool TlsChloExtractor::MaybeAttemptToParseChloLength() {
+  if (chlo_buffer_.size() < TlsChloParser::kHandshakeHeaderLength) {
+    return false;
+  }
+  absl::optional<size_t> chlo_length =
+      TlsChloParser::GetMessageLength(chlo_buffer_);
+  return !chlo_length.has_value() ||
+         *chlo_length > TlsChloParser::kMaxMessageLength ||
+         chlo_buffer_.size() >= *chlo_length;
+}
+
+void TlsChloExtractor::AttemptToParseFullChlo() {
+  absl::optional<size_t> chlo_length =
+      TlsChloParser::GetMessageLength(chlo_buffer_);
+  absl::optional<TlsChloParser::ParsedChlo> parsed_chlo;
+  if (chlo_length.has_value() &&
+      *chlo_length <= TlsChloParser::kMaxMessageLength) {
+    parsed_chlo = TlsChloParser::Parse(
+        absl::string_view(chlo_buffer_).substr(0, *chlo_length));
+  }
+  if (!parsed_chlo.has_value()) {
+    // Let BoringSSL either parse the CHLO or report why it cannot.
+    QUIC_CODE_COUNT(quic_tls_chlo_parser_fell_back_to_ssl);
+    ParseChloWithSsl();
+    return;
+  }
+
+  server_name_ = std::move(parsed_chlo->server_name);
+  alpns_ = std::move(parsed_chlo->alpns);
+  resumption_attempted_ = parsed_chlo->resumption_attempted;
+  early_data_attempted_ = parsed_chlo->early_data_attempted;
+  chlo_buffer_.clear();
+  AdvanceStateAfterParsingFullChlo();
+}
+
+void TlsChloExtractor::ParseChloWithSsl() {
   // Lazily set up BoringSSL handle.
   SetupSslHandle();
 
-  // Get data from the stream sequencer and pass it to BoringSSL.
+  // Pass data buffered for TlsChloParser first, then everything else from the
+  // stream sequencer.
+  if (!chlo_buffer_.empty()) {
+    const int rv = SSL_provide_quic_data(
+        ssl_.get(), ssl_encryption_initial,
+        reinterpret_cast<const uint8_t*>(chlo_buffer_.data()),
+        chlo_buffer_.size());
+    if (rv != 1) {
+      HandleUnrecoverableError("SSL_provide_quic_data failed");
+      return;
+    }
+    chlo_buffer_.clear();
+  }
   struct iovec iov;
   while (crypto_stream_sequencer_.GetReadableRegion(&iov)) {
     const int rv = SSL_provide_quic_data(
@@ -319,7 +397,10 @@ void TlsChloExtractor::HandleParsedChlo(const SSL_CLIENT_HELLO* client_hello) {
     }
   }
 
-  // Update our state now that we've parsed a full CHLO.
+  AdvanceStateAfterParsingFullChlo();
+}
+
+void TlsChloExtractor::AdvanceStateAfterParsingFullChlo() {
   if (state_ == State::kInitial) {
     state_ = State::kParsedFullSinglePacketChlo;
   } else if (state_ == State::kParsedPartialChloFragment) {
@@ -189,11 +189,17 @@ class QUIC_NO_EXPORT TlsChloExtractor
   ParsedQuicVersion version() const override { return framer_->version(); }
 
  private:
-  // Parses the length of the CHLO message by looking at the first four bytes.
-  // Returns whether we have received enough data to parse the full CHLO now.
+  // Parses the length of the CHLO message by looking at the first four bytes
+  // of |chlo_buffer_|. Returns whether we have received enough data to parse
+  // the full CHLO now, or to tell that TlsChloParser cannot parse it.
   bool MaybeAttemptToParseChloLength();
-  // Parses the full CHLO message if enough data has been received.
+  // Parses the full CHLO message in |chlo_buffer_| with TlsChloParser, and
+  // falls back to BoringSSL if that fails.
   void AttemptToParseFullChlo();
+  // Passes all received crypto data to BoringSSL and lets it parse the CHLO.
+  void ParseChloWithSsl();
+  // Updates |state_| once a full CHLO has been parsed.
+  void AdvanceStateAfterParsingFullChlo();
   // Moves to the failed state and records the error details.
   void HandleUnrecoverableError(const std::string& error_details);
   // Lazily sets up shared SSL handles if needed.
@@ -236,8 +242,12 @@ class QUIC_NO_EXPORT TlsChloExtractor
   std::unique_ptr<QuicFramer> framer_;
   // Used to reassemble the crypto stream from received CRYPTO frames.
   QuicStreamSequencer crypto_stream_sequencer_;
-  // BoringSSL handle required to parse the CHLO.
+  // BoringSSL handle required to parse the CHLO. Only created when
+  // TlsChloParser is not used or cannot parse the CHLO.
   bssl::UniquePtr<SSL> ssl_;
+  // Crypto stream data received so far, buffered until it holds a full CHLO
+  // for TlsChloParser.
+  std::string chlo_buffer_;
   // State of this TlsChloExtractor.
   State state_;
   // Detail string that can be logged in the presence of unrecoverable errors.
@@ -0,0 +1,159 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/tls_chlo_parser.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/core/quic_data_reader.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Sizes of the fixed-length ClientHello fields, from RFC 8446 section 4.1.2.
+const size_t kLegacyVersionLength = 2;
+const size_t kRandomLength = 32;
+const size_t kMaxLegacySessionIdLength = 32;
+
+// Mirrors BoringSSL's extract_sni(): exactly one host_name entry.
+bool ParseServerName(absl::string_view extension, std::string* server_name) {
+  QuicDataReader reader(extension);
+  absl::string_view server_name_list;
+  uint8_t name_type;
+  absl::string_view host_name;
+  if (!reader.ReadStringPiece16(&server_name_list) || !reader.IsDoneReading()) {
+    return false;
+  }
+  QuicDataReader list_reader(server_name_list);
+  if (!list_reader.ReadUInt8(&name_type) ||
+      !list_reader.ReadStringPiece16(&host_name) ||
+      !list_reader.IsDoneReading()) {
+    return false;
+  }
+  if (name_type != TLSEXT_NAMETYPE_host_name || host_name.empty() ||
+      host_name.size() > TLSEXT_MAXLEN_host_name ||
+      host_name.find('\0') != absl::string_view::npos) {
+    return false;
+  }
+  *server_name = std::string(host_name);
+  return true;
+}
+
+// Parses the ALPN extension the same way TlsChloExtractor::HandleParsedChlo
+// does.
+bool ParseAlpns(absl::string_view extension, std::vector<std::string>* alpns) {
+  QuicDataReader reader(extension);
+  absl::string_view alpns_payload;
+  if (!reader.ReadStringPiece16(&alpns_payload)) {
+    return false;
+  }
+  QuicDataReader alpns_payload_reader(alpns_payload);
+  while (!alpns_payload_reader.IsDoneReading()) {
+    absl::string_view alpn_payload;
+    if (!alpns_payload_reader.ReadStringPiece8(&alpn_payload)) {
+      return false;
+    }
+    alpns->emplace_back(std::string(alpn_payload));
+  }
+  return true;
+}
+
+}  // namespace
+
+TlsChloParser::ParsedChlo::ParsedChlo() = default;
+
+TlsChloParser::ParsedChlo::ParsedChlo(const ParsedChlo& other) = default;
+
+TlsChloParser::ParsedChlo::~ParsedChlo() = default;
+
+// static
+absl::optional<size_t> TlsChloParser::GetMessageLength(
+    absl::string_view header) {
+  QuicDataReader reader(header);
+  uint8_t message_type;
+  uint64_t body_length;
+  if (!reader.ReadUInt8(&message_type) ||
+      message_type != SSL3_MT_CLIENT_HELLO ||
+      !reader.ReadBytesToUInt64(3, &body_length)) {
+    return absl::nullopt;
+  }
+  return kHandshakeHeaderLength + body_length;
+}
+
+// static
+absl::optional<TlsChloParser::ParsedChlo> TlsChloParser::Parse(
+    absl::string_view message) {
+  if (message.size() < kHandshakeHeaderLength ||
+      message.size() > kMaxMessageLength) {
+    return absl::nullopt;
+  }
+  absl::optional<size_t> message_length = GetMessageLength(message);
+  if (!message_length.has_value() || *message_length != message.size()) {
+    return absl::nullopt;
+  }
+
+  QuicDataReader reader(message.substr(kHandshakeHeaderLength));
+  absl::string_view session_id;
+  absl::string_view cipher_suites;
+  absl::string_view compression_methods;
+  if (!reader.Seek(kLegacyVersionLength + kRandomLength) ||
+      !reader.ReadStringPiece8(&session_id) ||
+      session_id.size() > kMaxLegacySessionIdLength ||
+      !reader.ReadStringPiece16(&cipher_suites) || cipher_suites.size() < 2 ||
+      cipher_suites.size() % 2 != 0 ||
+      !reader.ReadStringPiece8(&compression_methods) ||
+      compression_methods.empty()) {
+    QUIC_DVLOG(1) << "Malformed ClientHello prefix";
+    return absl::nullopt;
+  }
+
+  ParsedChlo parsed_chlo;
+  if (reader.IsDoneReading()) {
+    // Extensions are optional in the ClientHello syntax.
+    return parsed_chlo;
+  }
+  absl::string_view extensions;
+  if (!reader.ReadStringPiece16(&extensions) || !reader.IsDoneReading()) {
+    QUIC_DVLOG(1) << "Malformed ClientHello extensions block";
+    return absl::nullopt;
+  }
+
+  QuicDataReader extensions_reader(extensions);
+  absl::flat_hash_set<uint16_t> seen_extensions;
+  while (!extensions_reader.IsDoneReading()) {
+    uint16_t type;
+    absl::string_view contents;
+    if (!extensions_reader.ReadUInt16(&type) ||
+        !extensions_reader.ReadStringPiece16(&contents) ||
+        !seen_extensions.insert(type).second) {
+      QUIC_DVLOG(1) << "Malformed or duplicate ClientHello extension";
+      return absl::nullopt;
+    }
+    switch (type) {
+      case TLSEXT_TYPE_server_name:
+        if (!ParseServerName(contents, &parsed_chlo.server_name)) {
+          return absl::nullopt;
+        }
+        break;
+      case TLSEXT_TYPE_application_layer_protocol_negotiation:
+        if (!ParseAlpns(contents, &parsed_chlo.alpns)) {
+          return absl::nullopt;
+        }
+        break;
+      case TLSEXT_TYPE_pre_shared_key:
+        parsed_chlo.resumption_attempted = true;
+        break;
+      case TLSEXT_TYPE_early_data:
+        parsed_chlo.early_data_attempted = true;
+        break;
+      default:
+        break;
+    }
+  }
+  return parsed_chlo;
+}
+
+}  // namespace quic
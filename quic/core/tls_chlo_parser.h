@@ -0,0 +1,58 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_TLS_CHLO_PARSER_H_
+#define QUICHE_QUIC_CORE_TLS_CHLO_PARSER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// TlsChloParser extracts the fields of a TLS ClientHello that are needed to
+// route a connection, without creating a BoringSSL SSL object. It checks the
+// structure of the message the same way BoringSSL does before it calls its
+// early callbacks, but does no negotiation: a ClientHello it accepts may still
+// fail the handshake.
+class QUIC_NO_EXPORT TlsChloParser {
+ public:
+  struct QUIC_NO_EXPORT ParsedChlo {
+    ParsedChlo();
+    ParsedChlo(const ParsedChlo& other);
+    ~ParsedChlo();
+
+    std::string server_name;
+    std::vector<std::string> alpns;
+    // Whether the 'pre_shared_key' extension is present.
+    bool resumption_attempted = false;
+    // Whether the 'early_data' extension is present.
+    bool early_data_attempted = false;
+  };
+
+  // Size of the handshake message header.
+  static constexpr size_t kHandshakeHeaderLength = 4;
+
+  // Largest ClientHello, including its header, that Parse() accepts. BoringSSL
+  // rejects Initial flights larger than this, so TlsChloParser must not accept
+  // them either.
+  static constexpr size_t kMaxMessageLength = 16384;
+
+  // Returns the length of the ClientHello starting at |header|, including the
+  // header, or nullopt if |header| does not start a ClientHello. |header| must
+  // be at least kHandshakeHeaderLength long.
+  static absl::optional<size_t> GetMessageLength(absl::string_view header);
+
+  // Parses |message|, a complete ClientHello handshake message including its
+  // header. Returns nullopt if it is malformed or longer than
+  // kMaxMessageLength.
+  static absl::optional<ParsedChlo> Parse(absl::string_view message);
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_TLS_CHLO_PARSER_H_
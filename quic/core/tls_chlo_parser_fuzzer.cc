@@ -0,0 +1,138 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares TlsChloParser with the ClientHello parsing in BoringSSL: BoringSSL
+// must accept every input TlsChloParser accepts, and extract the same fields
+// from it. Inputs TlsChloParser rejects are handed to BoringSSL by
+// TlsChloExtractor, so whatever BoringSSL does with them is not compared.
+
+#include <string>
+
+#include "absl/types/optional.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/core/quic_data_reader.h"
+#include "quic/core/tls_chlo_parser.h"
+#include "common/platform/api/quiche_logging.h"
+
+namespace {
+
+// Result of the BoringSSL parse of the current input.
+absl::optional<quic::TlsChloParser::ParsedChlo>* ssl_parsed_chlo = nullptr;
+
+bool HasExtension(const SSL_CLIENT_HELLO* client_hello, uint16_t extension) {
+  const uint8_t* unused_data;
+  size_t unused_len;
+  return SSL_early_callback_ctx_extension_get(client_hello, extension,
+                                              &unused_data, &unused_len) == 1;
+}
+
+enum ssl_select_cert_result_t SelectCertCallback(
+    const SSL_CLIENT_HELLO* client_hello) {
+  quic::TlsChloParser::ParsedChlo parsed_chlo;
+  const char* server_name =
+      SSL_get_servername(client_hello->ssl, TLSEXT_NAMETYPE_host_name);
+  if (server_name != nullptr) {
+    parsed_chlo.server_name = server_name;
+  }
+  parsed_chlo.resumption_attempted =
+      HasExtension(client_hello, TLSEXT_TYPE_pre_shared_key);
+  parsed_chlo.early_data_attempted =
+      HasExtension(client_hello, TLSEXT_TYPE_early_data);
+  const uint8_t* alpn_data;
+  size_t alpn_len;
+  if (SSL_early_callback_ctx_extension_get(
+          client_hello, TLSEXT_TYPE_application_layer_protocol_negotiation,
+          &alpn_data, &alpn_len) == 1) {
+    // Decoded the same way as in TlsChloExtractor::HandleParsedChlo.
+    quic::QuicDataReader reader(reinterpret_cast<const char*>(alpn_data),
+                                alpn_len);
+    absl::string_view alpns_payload;
+    if (!reader.ReadStringPiece16(&alpns_payload)) {
+      return ssl_select_cert_error;
+    }
+    quic::QuicDataReader alpns_payload_reader(alpns_payload);
+    while (!alpns_payload_reader.IsDoneReading()) {
+      absl::string_view alpn_payload;
+      if (!alpns_payload_reader.ReadStringPiece8(&alpn_payload)) {
+        return ssl_select_cert_error;
+      }
+      parsed_chlo.alpns.emplace_back(std::string(alpn_payload));
+    }
+  }
+  *ssl_parsed_chlo = parsed_chlo;
+  return ssl_select_cert_error;
+}
+
+int SetSecretCallback(SSL* /*ssl*/,
+                      enum ssl_encryption_level_t /*level*/,
+                      const SSL_CIPHER* /*cipher*/,
+                      const uint8_t* /*secret*/,
+                      size_t /*secret_length*/) {
+  return 0;
+}
+
+int WriteMessageCallback(SSL* /*ssl*/,
+                         enum ssl_encryption_level_t /*level*/,
+                         const uint8_t* /*data*/,
+                         size_t /*len*/) {
+  return 0;
+}
+
+int FlushFlightCallback(SSL* /*ssl*/) { return 0; }
+
+int SendAlertCallback(SSL* /*ssl*/,
+                      enum ssl_encryption_level_t /*level*/,
+                      uint8_t /*desc*/) {
+  return 0;
+}
+
+SSL_CTX* GetSslCtx() {
+  static SSL_CTX* ssl_ctx = []() {
+    CRYPTO_library_init();
+    SSL_CTX* ctx = SSL_CTX_new(TLS_with_buffers_method());
+    SSL_CTX_set_min_proto_version(ctx, TLS1_3_VERSION);
+    SSL_CTX_set_max_proto_version(ctx, TLS1_3_VERSION);
+    static const SSL_QUIC_METHOD kQuicCallbacks{
+        SetSecretCallback, SetSecretCallback, WriteMessageCallback,
+        FlushFlightCallback, SendAlertCallback};
+    SSL_CTX_set_quic_method(ctx, &kQuicCallbacks);
+    SSL_CTX_set_select_certificate_cb(ctx, SelectCertCallback);
+    return ctx;
+  }();
+  return ssl_ctx;
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  absl::optional<quic::TlsChloParser::ParsedChlo> parsed_chlo =
+      quic::TlsChloParser::Parse(
+          absl::string_view(reinterpret_cast<const char*>(data), size));
+  if (!parsed_chlo.has_value()) {
+    // TlsChloExtractor falls back to BoringSSL, nothing to compare.
+    return 0;
+  }
+
+  absl::optional<quic::TlsChloParser::ParsedChlo> result;
+  ssl_parsed_chlo = &result;
+  bssl::UniquePtr<SSL> ssl(SSL_new(GetSslCtx()));
+  SSL_set_accept_state(ssl.get());
+  if (SSL_provide_quic_data(ssl.get(), ssl_encryption_initial, data, size) ==
+      1) {
+    (void)SSL_do_handshake(ssl.get());
+  }
+  ssl_parsed_chlo = nullptr;
+
+  // Otherwise TlsChloExtractor would accept a ClientHello that the handshake
+  // then rejects.
+  QUICHE_CHECK(result.has_value())
+      << "TlsChloParser accepted a ClientHello that BoringSSL rejects";
+  QUICHE_CHECK_EQ(parsed_chlo->server_name, result->server_name);
+  QUICHE_CHECK(parsed_chlo->alpns == result->alpns);
+  QUICHE_CHECK_EQ(parsed_chlo->resumption_attempted,
+                  result->resumption_attempted);
+  QUICHE_CHECK_EQ(parsed_chlo->early_data_attempted,
+                  result->early_data_attempted);
+  return 0;
+}
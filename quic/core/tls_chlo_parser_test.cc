@@ -0,0 +1,129 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/core/tls_chlo_parser.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+std::string Uint16(uint16_t value) {
+  return std::string({static_cast<char>(value >> 8), static_cast<char>(value)});
+}
+
+std::string Prefixed8(absl::string_view data) {
+  return absl::StrCat(std::string(1, static_cast<char>(data.size())), data);
+}
+
+std::string Prefixed16(absl::string_view data) {
+  return absl::StrCat(Uint16(data.size()), data);
+}
+
+std::string Extension(uint16_t type, absl::string_view contents) {
+  return absl::StrCat(Uint16(type), Prefixed16(contents));
+}
+
+std::string ServerNameExtension(absl::string_view host_name) {
+  return Extension(
+      0, Prefixed16(absl::StrCat(std::string(1, '\0'), Prefixed16(host_name))));
+}
+
+std::string AlpnExtension(absl::string_view alpn1, absl::string_view alpn2) {
+  return Extension(
+      16, Prefixed16(absl::StrCat(Prefixed8(alpn1), Prefixed8(alpn2))));
+}
+
+// Builds a ClientHello handshake message around |extensions|.
+std::string ClientHello(absl::string_view extensions) {
+  std::string body = absl::StrCat(
+      Uint16(0x0303), std::string(32, 'r'), Prefixed8(std::string(32, 's')),
+      Prefixed16(Uint16(0x1301)), Prefixed8(std::string(1, '\0')),
+      Prefixed16(extensions));
+  return absl::StrCat(std::string({1, 0}), Uint16(body.size()), body);
+}
+
+class TlsChloParserTest : public QuicTest {};
+
+TEST_F(TlsChloParserTest, Parse) {
+  const std::string chlo = ClientHello(absl::StrCat(
+      Extension(0x1234, "unknown"), ServerNameExtension("example.org"),
+      AlpnExtension("h3", "hq"), Extension(42, ""), Extension(41, "psk")));
+  ASSERT_EQ(chlo.size(), TlsChloParser::GetMessageLength(chlo));
+
+  absl::optional<TlsChloParser::ParsedChlo> parsed_chlo =
+      TlsChloParser::Parse(chlo);
+  ASSERT_TRUE(parsed_chlo.has_value());
+  EXPECT_EQ("example.org", parsed_chlo->server_name);
+  EXPECT_EQ(std::vector<std::string>({"h3", "hq"}), parsed_chlo->alpns);
+  EXPECT_TRUE(parsed_chlo->resumption_attempted);
+  EXPECT_TRUE(parsed_chlo->early_data_attempted);
+}
+
+TEST_F(TlsChloParserTest, NoExtensions) {
+  const std::string chlo = ClientHello("");
+  absl::optional<TlsChloParser::ParsedChlo> parsed_chlo =
+      TlsChloParser::Parse(chlo);
+  ASSERT_TRUE(parsed_chlo.has_value());
+  EXPECT_TRUE(parsed_chlo->server_name.empty());
+  EXPECT_TRUE(parsed_chlo->alpns.empty());
+  EXPECT_FALSE(parsed_chlo->resumption_attempted);
+  EXPECT_FALSE(parsed_chlo->early_data_attempted);
+}
+
+TEST_F(TlsChloParserTest, NotAClientHello) {
+  std::string chlo = ClientHello(ServerNameExtension("example.org"));
+  chlo[0] = 2;
+  EXPECT_FALSE(TlsChloParser::GetMessageLength(chlo).has_value());
+  EXPECT_FALSE(TlsChloParser::Parse(chlo).has_value());
+}
+
+TEST_F(TlsChloParserTest, Truncated) {
+  const std::string chlo = ClientHello(absl::StrCat(
+      ServerNameExtension("example.org"), AlpnExtension("h3", "hq")));
+  for (size_t length = 0; length < chlo.size(); ++length) {
+    EXPECT_FALSE(TlsChloParser::Parse(chlo.substr(0, length)).has_value())
+        << length;
+  }
+  // Trailing data after the message.
+  EXPECT_FALSE(TlsChloParser::Parse(absl::StrCat(chlo, "x")).has_value());
+}
+
+TEST_F(TlsChloParserTest, DuplicateExtension) {
+  EXPECT_FALSE(TlsChloParser::Parse(ClientHello(absl::StrCat(
+                                        Extension(42, ""), Extension(42, ""))))
+                   .has_value());
+}
+
+TEST_F(TlsChloParserTest, InvalidServerName) {
+  EXPECT_FALSE(
+      TlsChloParser::Parse(ClientHello(ServerNameExtension(""))).has_value());
+  EXPECT_FALSE(TlsChloParser::Parse(
+                   ClientHello(ServerNameExtension(std::string(256, 'a'))))
+                   .has_value());
+  EXPECT_FALSE(TlsChloParser::Parse(
+                   ClientHello(ServerNameExtension(std::string("a\0b", 3))))
+                   .has_value());
+  // Two names.
+  const std::string host_name =
+      absl::StrCat(std::string(1, '\0'), Prefixed16("example.org"));
+  EXPECT_FALSE(TlsChloParser::Parse(
+                   ClientHello(Extension(
+                       0, Prefixed16(absl::StrCat(host_name, host_name)))))
+                   .has_value());
+}
+
+TEST_F(TlsChloParserTest, InvalidAlpn) {
+  EXPECT_FALSE(
+      TlsChloParser::Parse(ClientHello(Extension(16, Prefixed16("\x05h3"))))
+          .has_value());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -176,6 +176,14 @@ void TlsServerHandshaker::DecryptCallback::Run(std::vector<uint8_t> plaintext) {
   handshaker->ticket_decryption_callback_ = nullptr;
 }
 
+void TlsServerHandshaker::DecryptCallback::RunWithoutEarlyData(
+    std::vector<uint8_t> plaintext) {
+  if (handshaker_ != nullptr) {
+    handshaker_->decrypted_session_ticket_without_early_data_ = true;
+  }
+  Run(std::move(plaintext));
+}
+
 void TlsServerHandshaker::DecryptCallback::Cancel() {
   QUICHE_DCHECK(handshaker_);
   handshaker_ = nullptr;
@@ -869,6 +877,12 @@ ssl_ticket_aead_result_t TlsServerHandshaker::FinalizeSessionTicketOpen(
   memcpy(out, decrypted_session_ticket_.data(),
          decrypted_session_ticket_.size());
   *out_len = decrypted_session_ticket_.size();
+  if (decrypted_session_ticket_without_early_data_) {
+    // BoringSSL decides whether to accept early data after the ticket is
+    // opened, so the session is still resumed.
+    QUIC_CODE_COUNT(quic_tls_server_handshaker_tickets_opened_without_0rtt);
+    SSL_set_early_data_enabled(ssl(), 0);
+  }
 
   QUIC_CODE_COUNT(quic_tls_server_handshaker_tickets_opened);
   return ssl_ticket_aead_success;
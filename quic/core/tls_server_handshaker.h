@@ -205,6 +205,7 @@ class QUIC_EXPORT_PRIVATE TlsServerHandshaker
    public:
     explicit DecryptCallback(TlsServerHandshaker* handshaker);
     void Run(std::vector<uint8_t> plaintext) override;
+    void RunWithoutEarlyData(std::vector<uint8_t> plaintext) override;
 
     // If called, Cancel causes the pending callback to be a no-op.
     void Cancel();
@@ -339,6 +340,8 @@ class QUIC_EXPORT_PRIVATE TlsServerHandshaker
   // |decrypted_session_ticket_| contains the decrypted session ticket after the
   // callback has run but before it is passed to BoringSSL.
   std::vector<uint8_t> decrypted_session_ticket_;
+  // Set if the ticket crypter accepted the ticket but ruled out early data.
+  bool decrypted_session_ticket_without_early_data_ = false;
   // |ticket_received_| tracks whether we received a resumption ticket from the
   // client. It does not matter whether we were able to decrypt said ticket or
   // if we actually resumed a session with it - the presence of this ticket
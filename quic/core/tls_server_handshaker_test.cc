@@ -462,6 +462,62 @@ TEST_P(TlsServerHandshakerTest, ConnectedAfterTlsHandshake) {
   ExpectHandshakeSuccessful();
 }
 
+// Counts the Certificate and CompressedCertificate messages sent on an SSL.
+struct CertificateMessageCounts {
+  int certificate = 0;
+  int compressed_certificate = 0;
+};
+
+void CountSentCertificateMessages(int write_p,
+                                  int /*version*/,
+                                  int content_type,
+                                  const void* buf,
+                                  size_t len,
+                                  SSL* /*ssl*/,
+                                  void* arg) {
+  if (!write_p || content_type != SSL3_RT_HANDSHAKE || len == 0) {
+    return;
+  }
+  auto* counts = static_cast<CertificateMessageCounts*>(arg);
+  switch (static_cast<const uint8_t*>(buf)[0]) {
+    case SSL3_MT_CERTIFICATE:
+      ++counts->certificate;
+      break;
+    case SSL3_MT_COMPRESSED_CERTIFICATE:
+      ++counts->compressed_certificate;
+      break;
+  }
+}
+
+TEST_P(TlsServerHandshakerTest, HandshakeWithCertCompression) {
+  CertificateMessageCounts uncompressed_counts;
+  SSL_set_msg_callback(server_stream()->GetSsl(),
+                       &CountSentCertificateMessages);
+  SSL_set_msg_callback_arg(server_stream()->GetSsl(), &uncompressed_counts);
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+  EXPECT_EQ(1, uncompressed_counts.certificate);
+  EXPECT_EQ(0, uncompressed_counts.compressed_certificate);
+
+  // Both SSL_CTXs are created with the flag, so rebuild both configs.
+  SetQuicReloadableFlag(quic_tls_cert_compression, true);
+  client_crypto_config_ = std::make_unique<QuicCryptoClientConfig>(
+      crypto_test_utils::ProofVerifierForTesting(),
+      std::make_unique<test::SimpleSessionCache>());
+  InitializeServerConfig();
+  InitializeServer();
+  InitializeFakeClient();
+  CertificateMessageCounts compressed_counts;
+  SSL_set_msg_callback(server_stream()->GetSsl(),
+                       &CountSentCertificateMessages);
+  SSL_set_msg_callback_arg(server_stream()->GetSsl(), &compressed_counts);
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+  // The server sent its chain as a CompressedCertificate message.
+  EXPECT_EQ(0, compressed_counts.certificate);
+  EXPECT_EQ(1, compressed_counts.compressed_certificate);
+}
+
 TEST_P(TlsServerHandshakerTest, HandshakeWithAsyncSelectCertSuccess) {
   InitializeServerWithFakeProofSourceHandle();
   server_handshaker_->SetupProofSourceHandle(
@@ -890,6 +946,29 @@ TEST_P(TlsServerHandshakerTest, ZeroRttResumption) {
   EXPECT_NE(server_stream()->IsZeroRtt(), GetParam().disable_resumption);
 }
 
+TEST_P(TlsServerHandshakerTest, ZeroRttDisabledByTicketCrypter) {
+  std::vector<uint8_t> application_state = {0, 1, 2, 3};
+
+  // Do the first handshake
+  server_stream()->SetServerApplicationStateForResumption(
+      std::make_unique<ApplicationState>(application_state));
+  InitializeFakeClient();
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+
+  // The ticket crypter accepts the ticket but rules out early data, e.g.
+  // because the ticket was seen before.
+  InitializeServer();
+  ticket_crypter_->set_disable_early_data(true);
+  server_stream()->SetServerApplicationStateForResumption(
+      std::make_unique<ApplicationState>(application_state));
+  InitializeFakeClient();
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+  EXPECT_NE(client_stream()->IsResumption(), GetParam().disable_resumption);
+  EXPECT_FALSE(server_stream()->IsZeroRtt());
+}
+
 TEST_P(TlsServerHandshakerTest, ZeroRttRejectOnApplicationStateChange) {
   std::vector<uint8_t> original_application_state = {1, 2};
   std::vector<uint8_t> new_application_state = {3, 4};
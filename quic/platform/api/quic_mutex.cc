@@ -26,6 +26,10 @@ void QuicMutex::AssertReaderHeld() const {
   impl_.AssertReaderHeld();
 }
 
+void QuicCondVar::Wait(QuicMutex* mutex) {
+  impl_.Wait(&mutex->impl_);
+}
+
 QuicReaderMutexLock::QuicReaderMutexLock(QuicMutex* lock) : lock_(lock) {
   lock->ReaderLock();
 }
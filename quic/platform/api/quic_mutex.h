@@ -46,6 +46,8 @@ class QUIC_LOCKABLE QUIC_EXPORT_PRIVATE QuicMutex {
   void AssertReaderHeld() const QUIC_ASSERT_SHARED_LOCK();
 
  private:
+  friend class QuicCondVar;
+
   QuicLockImpl impl_;
 };
 
@@ -78,6 +80,28 @@ class QUIC_SCOPED_LOCKABLE QUIC_EXPORT_PRIVATE QuicWriterMutexLock {
   QuicMutex* const lock_;
 };
 
+// A condition variable to be used with a QuicMutex held exclusively.
+class QUIC_EXPORT_PRIVATE QuicCondVar {
+ public:
+  QuicCondVar() = default;
+  QuicCondVar(const QuicCondVar&) = delete;
+  QuicCondVar& operator=(const QuicCondVar&) = delete;
+
+  // Atomically releases |mutex|, which the caller must hold exclusively, and
+  // blocks until woken up by Signal() or SignalAll(), then reacquires |mutex|.
+  // May also wake up spuriously, so callers must recheck their condition.
+  void Wait(QuicMutex* mutex);
+
+  // Wakes up at least one waiting thread, if any.
+  void Signal() { impl_.Signal(); }
+
+  // Wakes up all waiting threads.
+  void SignalAll() { impl_.SignalAll(); }
+
+ private:
+  QuicCondVarImpl impl_;
+};
+
 // A Notification allows threads to receive notification of a single occurrence
 // of a single event.
 class QUIC_EXPORT_PRIVATE QuicNotification {
@@ -37,6 +37,14 @@ class QpackOfflineDecoder : public QpackDecoder::EncoderStreamErrorDelegate {
   void OnEncoderStreamError(QuicErrorCode error_code,
                             absl::string_view error_message) override;
 
+  // Parse next header list from |*expected_headers_data| into
+  // |*expected_header_list|, removing consumed data from the beginning of
+  // |*expected_headers_data|.  Returns true on success, false if parsing fails.
+  // Also used by QpackOfflineEncoderEvaluator to read header lists to encode.
+  static bool ReadNextExpectedHeaderList(
+      absl::string_view* expected_headers_data,
+      spdy::Http2HeaderBlock* expected_header_list);
+
  private:
   // Data structure to hold TestHeadersHandler and QpackProgressiveDecoder until
   // decoding of a header header block (and all preceding header blocks) is
@@ -60,12 +68,6 @@ class QpackOfflineDecoder : public QpackDecoder::EncoderStreamErrorDelegate {
   // decoded header lists in |decoded_header_lists_| against them.
   bool VerifyDecodedHeaderLists(absl::string_view expected_headers_filename);
 
-  // Parse next header list from |*expected_headers_data| into
-  // |*expected_header_list|, removing consumed data from the beginning of
-  // |*expected_headers_data|.  Returns true on success, false if parsing fails.
-  bool ReadNextExpectedHeaderList(absl::string_view* expected_headers_data,
-                                  spdy::Http2HeaderBlock* expected_header_list);
-
   // Compare two header lists.  Allow for different orders of certain headers as
   // described at
   // https://github.com/qpackers/qifs/blob/master/encoded/qpack-03/h2o/README.md.
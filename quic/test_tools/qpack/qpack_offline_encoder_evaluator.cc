@@ -0,0 +1,178 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/test_tools/qpack/qpack_offline_encoder_evaluator.h"
+
+#include <limits>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "quic/platform/api/quic_logging.h"
+#include "quic/test_tools/qpack/qpack_offline_decoder.h"
+#include "common/platform/api/quiche_file_utils.h"
+
+namespace quic {
+
+QpackOfflineEncoderEvaluator::QpackOfflineEncoderEvaluator(
+    uint64_t maximum_dynamic_table_capacity,
+    uint64_t maximum_blocked_streams,
+    uint64_t encoder_stream_delay)
+    : maximum_dynamic_table_capacity_(maximum_dynamic_table_capacity),
+      maximum_blocked_streams_(maximum_blocked_streams),
+      encoder_stream_delay_(encoder_stream_delay),
+      error_detected_(false) {}
+
+bool QpackOfflineEncoderEvaluator::Evaluate(
+    absl::string_view qif_filename,
+    std::unique_ptr<QpackEncoderInsertionPolicy> insertion_policy,
+    Result* result) {
+  absl::optional<std::string> qif_data_storage =
+      quiche::ReadFileContents(qif_filename);
+  if (!qif_data_storage.has_value()) {
+    QUIC_LOG(ERROR) << "Error reading " << qif_filename;
+    return false;
+  }
+  absl::string_view qif_data(*qif_data_storage);
+
+  // Every evaluation represents a different connection.
+  error_detected_ = false;
+  pending_encoder_stream_data_.clear();
+  decoders_.clear();
+  *result = Result();
+
+  encoder_ = std::make_unique<QpackEncoder>(this);
+  encoder_->set_qpack_stream_sender_delegate(&encoder_stream_buffer_);
+  encoder_->set_insertion_policy(std::move(insertion_policy));
+  encoder_->SetMaximumBlockedStreams(maximum_blocked_streams_);
+  encoder_->SetMaximumDynamicTableCapacity(maximum_dynamic_table_capacity_);
+  encoder_->SetDynamicTableCapacity(maximum_dynamic_table_capacity_);
+
+  decoder_ = std::make_unique<QpackDecoder>(maximum_dynamic_table_capacity_,
+                                            maximum_blocked_streams_, this);
+  decoder_stream_forwarder_ = std::make_unique<DecoderStreamForwarder>(
+      encoder_->decoder_stream_receiver());
+  decoder_->set_qpack_stream_sender_delegate(decoder_stream_forwarder_.get());
+
+  // The Set Dynamic Table Capacity instruction is delivered right away.
+  std::string encoder_stream_data = encoder_stream_buffer_.Release();
+  result->encoder_stream_byte_count += encoder_stream_data.size();
+  decoder_->encoder_stream_receiver()->Decode(encoder_stream_data);
+
+  uint64_t header_list_index = 0;
+  while (!qif_data.empty()) {
+    spdy::Http2HeaderBlock header_list;
+    if (!QpackOfflineDecoder::ReadNextExpectedHeaderList(&qif_data,
+                                                         &header_list)) {
+      QUIC_LOG(ERROR) << "Error parsing header list in " << qif_filename;
+      return false;
+    }
+
+    for (const auto& header : header_list) {
+      result->uncompressed_byte_count +=
+          header.first.size() + header.second.size();
+    }
+
+    // Use a different client-initiated bidirectional stream for every header
+    // list.
+    const QuicStreamId stream_id = 4 * header_list_index;
+    std::string header_block = encoder_->EncodeHeaderList(
+        stream_id, header_list, /* encoder_stream_sent_byte_count = */ nullptr);
+    result->header_block_byte_count += header_block.size();
+
+    encoder_stream_data = encoder_stream_buffer_.Release();
+    result->encoder_stream_byte_count += encoder_stream_data.size();
+    if (!encoder_stream_data.empty()) {
+      pending_encoder_stream_data_.push_back(
+          {header_list_index + encoder_stream_delay_,
+           std::move(encoder_stream_data)});
+    }
+
+    DeliverEncoderStreamData(header_list_index);
+
+    auto headers_handler = std::make_unique<test::TestHeadersHandler>();
+    auto progressive_decoder =
+        decoder_->CreateProgressiveDecoder(stream_id, headers_handler.get());
+    progressive_decoder->Decode(header_block);
+    progressive_decoder->EndHeaderBlock();
+    if (!headers_handler->decoding_completed() &&
+        !headers_handler->decoding_error_detected()) {
+      ++result->blocked_header_block_count;
+    }
+    decoders_.push_back({std::move(headers_handler),
+                         std::move(progressive_decoder),
+                         std::move(header_list)});
+
+    if (error_detected_ || !VerifyDecodedHeaderLists()) {
+      return false;
+    }
+
+    ++header_list_index;
+  }
+
+  DeliverEncoderStreamData(std::numeric_limits<uint64_t>::max());
+  if (error_detected_ || !VerifyDecodedHeaderLists()) {
+    return false;
+  }
+  if (!decoders_.empty()) {
+    QUIC_LOG(ERROR) << "Decoding incomplete after delivering all encoder "
+                       "stream data.";
+    return false;
+  }
+
+  result->header_list_count = header_list_index;
+  return true;
+}
+
+void QpackOfflineEncoderEvaluator::OnDecoderStreamError(
+    QuicErrorCode error_code, absl::string_view error_message) {
+  QUIC_LOG(ERROR) << "Decoder stream error: "
+                  << QuicErrorCodeToString(error_code) << " " << error_message;
+  error_detected_ = true;
+}
+
+void QpackOfflineEncoderEvaluator::OnEncoderStreamError(
+    QuicErrorCode error_code, absl::string_view error_message) {
+  QUIC_LOG(ERROR) << "Encoder stream error: "
+                  << QuicErrorCodeToString(error_code) << " " << error_message;
+  error_detected_ = true;
+}
+
+void QpackOfflineEncoderEvaluator::DeliverEncoderStreamData(
+    uint64_t header_list_index) {
+  // Data is delivered in the order it was written.
+  while (!pending_encoder_stream_data_.empty() &&
+         pending_encoder_stream_data_.front().due_header_list_index <=
+             header_list_index) {
+    decoder_->encoder_stream_receiver()->Decode(
+        pending_encoder_stream_data_.front().data);
+    pending_encoder_stream_data_.pop_front();
+  }
+}
+
+bool QpackOfflineEncoderEvaluator::VerifyDecodedHeaderLists() {
+  // Blocked header blocks might be decoded out of order.
+  for (auto it = decoders_.begin(); it != decoders_.end();) {
+    if (it->headers_handler->decoding_error_detected()) {
+      QUIC_LOG(ERROR) << "Decoding error: "
+                      << it->headers_handler->error_message();
+      return false;
+    }
+
+    if (!it->headers_handler->decoding_completed()) {
+      ++it;
+      continue;
+    }
+
+    if (it->headers_handler->ReleaseHeaderList() != it->expected_header_list) {
+      QUIC_LOG(ERROR) << "Decoded header list does not match encoded one: "
+                      << it->expected_header_list.DebugString();
+      return false;
+    }
+    it = decoders_.erase(it);
+  }
+
+  return true;
+}
+
+}  // namespace quic
@@ -0,0 +1,132 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TEST_TOOLS_QPACK_QPACK_OFFLINE_ENCODER_EVALUATOR_H_
+#define QUICHE_QUIC_TEST_TOOLS_QPACK_QPACK_OFFLINE_ENCODER_EVALUATOR_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/qpack/qpack_decoder.h"
+#include "quic/core/qpack/qpack_encoder.h"
+#include "quic/core/qpack/qpack_encoder_insertion_policy.h"
+#include "quic/core/qpack/qpack_stream_sender_delegate.h"
+#include "quic/core/quic_error_codes.h"
+#include "quic/test_tools/qpack/qpack_decoder_test_utils.h"
+#include "spdy/core/spdy_header_block.h"
+
+namespace quic {
+
+// Replays header lists read from a file in the QIF format of the QPACK Offline
+// Interop corpus, see
+// https://github.com/quicwg/base-drafts/wiki/QPACK-Offline-Interop, through a
+// QpackEncoder and a QpackDecoder, in order to measure how well an insertion
+// policy compresses and how often it blocks streams.  Encoder stream data
+// written while encoding a header list reaches the decoder only after a
+// configurable number of later header blocks, simulating reordering between
+// streams.  Decoder stream data reaches the encoder immediately.
+class QpackOfflineEncoderEvaluator
+    : public QpackEncoder::DecoderStreamErrorDelegate,
+      public QpackDecoder::EncoderStreamErrorDelegate {
+ public:
+  struct Result {
+    uint64_t header_list_count = 0;
+    // Total length of names and values in all header lists.
+    uint64_t uncompressed_byte_count = 0;
+    uint64_t header_block_byte_count = 0;
+    uint64_t encoder_stream_byte_count = 0;
+    // Number of header blocks that could not be decoded upon arrival.
+    uint64_t blocked_header_block_count = 0;
+  };
+
+  QpackOfflineEncoderEvaluator(uint64_t maximum_dynamic_table_capacity,
+                               uint64_t maximum_blocked_streams,
+                               uint64_t encoder_stream_delay);
+  ~QpackOfflineEncoderEvaluator() override = default;
+
+  // Encode header lists read from |qif_filename| using |insertion_policy|,
+  // which may be null, decode them, and verify decoded header lists.  Returns
+  // true and fills in |*result| on success, false on any error.
+  bool Evaluate(absl::string_view qif_filename,
+                std::unique_ptr<QpackEncoderInsertionPolicy> insertion_policy,
+                Result* result);
+
+  // QpackEncoder::DecoderStreamErrorDelegate implementation:
+  void OnDecoderStreamError(QuicErrorCode error_code,
+                            absl::string_view error_message) override;
+
+  // QpackDecoder::EncoderStreamErrorDelegate implementation:
+  void OnEncoderStreamError(QuicErrorCode error_code,
+                            absl::string_view error_message) override;
+
+ private:
+  // Buffers encoder stream data until it is delivered to the decoder.
+  class EncoderStreamBuffer : public QpackStreamSenderDelegate {
+   public:
+    void WriteStreamData(absl::string_view data) override {
+      buffer_.append(data.data(), data.size());
+    }
+
+    std::string Release() { return std::move(buffer_); }
+
+   private:
+    std::string buffer_;
+  };
+
+  // Passes decoder stream data to the encoder.
+  class DecoderStreamForwarder : public QpackStreamSenderDelegate {
+   public:
+    explicit DecoderStreamForwarder(QpackStreamReceiver* receiver)
+        : receiver_(receiver) {}
+
+    void WriteStreamData(absl::string_view data) override {
+      receiver_->Decode(data);
+    }
+
+   private:
+    QpackStreamReceiver* const receiver_;
+  };
+
+  // Encoder stream data to be delivered to the decoder before decoding the
+  // header block with index |due_header_list_index|.
+  struct PendingEncoderStreamData {
+    uint64_t due_header_list_index;
+    std::string data;
+  };
+
+  // Header list being decoded.
+  struct Decoder {
+    std::unique_ptr<test::TestHeadersHandler> headers_handler;
+    std::unique_ptr<QpackProgressiveDecoder> progressive_decoder;
+    spdy::Http2HeaderBlock expected_header_list;
+  };
+
+  // Pass encoder stream data due before the header block with index
+  // |header_list_index| to the decoder.
+  void DeliverEncoderStreamData(uint64_t header_list_index);
+
+  // Verify and remove header lists that are completely decoded.  Returns false
+  // on decoding error or mismatch.
+  bool VerifyDecodedHeaderLists();
+
+  const uint64_t maximum_dynamic_table_capacity_;
+  const uint64_t maximum_blocked_streams_;
+  const uint64_t encoder_stream_delay_;
+
+  bool error_detected_;
+  std::unique_ptr<QpackEncoder> encoder_;
+  std::unique_ptr<QpackDecoder> decoder_;
+  EncoderStreamBuffer encoder_stream_buffer_;
+  std::unique_ptr<DecoderStreamForwarder> decoder_stream_forwarder_;
+  std::list<PendingEncoderStreamData> pending_encoder_stream_data_;
+  std::list<Decoder> decoders_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TEST_TOOLS_QPACK_QPACK_OFFLINE_ENCODER_EVALUATOR_H_
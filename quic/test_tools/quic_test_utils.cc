@@ -1405,6 +1405,7 @@ WriteResult TestPacketWriter::WritePacket(const char* buffer,
   if (packet_buffer_pool_index_.find(const_cast<char*>(buffer)) !=
       packet_buffer_pool_index_.end()) {
     FreePacketBuffer(buffer);
+    ++packets_written_in_place_;
   }
 
   QuicEncryptedPacket packet(buffer, buf_len);
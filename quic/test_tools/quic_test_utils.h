@@ -1887,6 +1887,12 @@ class TestPacketWriter : public QuicPacketWriter {
 
   uint32_t packets_write_attempts() const { return packets_write_attempts_; }
 
+  // Number of written packets which were serialized into a buffer returned by
+  // GetNextWriteLocation().
+  uint32_t packets_written_in_place() const {
+    return packets_written_in_place_;
+  }
+
   uint32_t flush_attempts() const { return flush_attempts_; }
 
   uint32_t connection_close_packets() const {
@@ -1943,6 +1949,7 @@ class TestPacketWriter : public QuicPacketWriter {
   uint32_t final_bytes_of_previous_packet_ = 0;
   bool use_tagging_decrypter_ = false;
   uint32_t packets_write_attempts_ = 0;
+  uint32_t packets_written_in_place_ = 0;
   uint32_t connection_close_packets_ = 0;
   MockClock* clock_ = nullptr;
   // If non-zero, the clock will pause during WritePacket for this amount of
@@ -62,7 +62,7 @@ void TestTicketCrypter::Decrypt(
   if (run_async_) {
     pending_callbacks_.push_back({std::move(callback), decrypted_ticket});
   } else {
-    callback->Run(decrypted_ticket);
+    RunCallback(callback.get(), decrypted_ticket);
   }
 }
 
@@ -76,7 +76,16 @@ size_t TestTicketCrypter::NumPendingCallbacks() {
 
 void TestTicketCrypter::RunPendingCallback(size_t n) {
   const PendingCallback& callback = pending_callbacks_[n];
-  callback.callback->Run(callback.decrypted_ticket);
+  RunCallback(callback.callback.get(), callback.decrypted_ticket);
+}
+
+void TestTicketCrypter::RunCallback(ProofSource::DecryptCallback* callback,
+                                    std::vector<uint8_t> decrypted_ticket) {
+  if (disable_early_data_ && !decrypted_ticket.empty()) {
+    callback->RunWithoutEarlyData(std::move(decrypted_ticket));
+  } else {
+    callback->Run(std::move(decrypted_ticket));
+  }
 }
 
 }  // namespace test
@@ -31,6 +31,12 @@ class TestTicketCrypter : public ProofSource::TicketCrypter {
   // Allows configuring this TestTicketCrypter to fail decryption.
   void set_fail_decrypt(bool fail_decrypt) { fail_decrypt_ = fail_decrypt; }
 
+  // Allows configuring this TestTicketCrypter to decrypt tickets with
+  // RunWithoutEarlyData().
+  void set_disable_early_data(bool disable_early_data) {
+    disable_early_data_ = disable_early_data;
+  }
+
  private:
   // Performs the Decrypt operation synchronously.
   std::vector<uint8_t> Decrypt(absl::string_view in);
@@ -40,7 +46,12 @@ class TestTicketCrypter : public ProofSource::TicketCrypter {
     std::vector<uint8_t> decrypted_ticket;
   };
 
+  // Runs |callback| with |decrypted_ticket|.
+  void RunCallback(ProofSource::DecryptCallback* callback,
+                   std::vector<uint8_t> decrypted_ticket);
+
   bool fail_decrypt_ = false;
+  bool disable_early_data_ = false;
   bool run_async_ = false;
   std::vector<PendingCallback> pending_callbacks_;
   std::vector<uint8_t> ticket_prefix_;
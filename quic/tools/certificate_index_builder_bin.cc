@@ -0,0 +1,167 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Builds a certificate index, as served by MappedProofSource, from directories
+// of PEM files. Each <name>.crt file holds a certificate chain, leaf first, and
+// must come with the private key in <name>.key. A DER-encoded OCSP response in
+// <name>.ocsp and a serialized SCT list in <name>.sct are optional. Files are
+// added in the order of the directories and then by name, and the first chain
+// is the default one.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+#include "quic/core/crypto/certificate_index.h"
+#include "quic/core/crypto/certificate_view.h"
+#include "quic/platform/api/quic_flags.h"
+#include "common/platform/api/quiche_file_utils.h"
+
+using quic::CertificateIndexBuilder;
+using quic::CertificatePrivateKey;
+using quic::CertificateView;
+
+namespace {
+
+constexpr absl::string_view kCertificateExtension = ".crt";
+
+bool AddChain(const std::string& certificate_path,
+              CertificateIndexBuilder* builder) {
+  const std::string base = certificate_path.substr(
+      0, certificate_path.size() - kCertificateExtension.size());
+  absl::optional<std::string> certificate_pem =
+      quiche::ReadFileContents(certificate_path);
+  absl::optional<std::string> key_pem =
+      quiche::ReadFileContents(base + ".key");
+  if (!certificate_pem.has_value() || !key_pem.has_value()) {
+    std::cerr << "Unable to read " << certificate_path << " or its key\n";
+    return false;
+  }
+
+  std::stringstream certificate_stream(*certificate_pem);
+  std::vector<std::string> certs =
+      CertificateView::LoadPemFromStream(&certificate_stream);
+  std::stringstream key_stream(*key_pem);
+  std::unique_ptr<CertificatePrivateKey> key =
+      CertificatePrivateKey::LoadPemFromStream(&key_stream);
+  if (certs.empty() || key == nullptr) {
+    std::cerr << "Unable to parse " << certificate_path << " or its key\n";
+    return false;
+  }
+
+  const std::string ocsp_response =
+      quiche::ReadFileContents(base + ".ocsp").value_or("");
+  const std::string signed_certificate_timestamps =
+      quiche::ReadFileContents(base + ".sct").value_or("");
+  if (!builder->AddChain(certs, *key, ocsp_response,
+                         signed_certificate_timestamps)) {
+    std::cerr << "Invalid certificate chain in " << certificate_path << "\n";
+    return false;
+  }
+  return true;
+}
+
+// Writes |contents| to |path| atomically: MappedProofSource maps the index
+// MAP_SHARED, so rewriting a live index in place would let servers read a torn
+// index, or fault on a truncated one. The new index is written and synced to a
+// temporary file which is then renamed over |path|, so mappings of the old
+// file stay intact. The temporary file is created from scratch with mode 0600,
+// rather than reusing one left behind with looser permissions, since the index
+// holds private keys.
+bool WriteFileAtomically(const std::string& path, absl::string_view contents) {
+  const std::string temp_path = path + ".tmp";
+  if (unlink(temp_path.c_str()) != 0 && errno != ENOENT) {
+    std::cerr << "Unable to remove " << temp_path << ": " << strerror(errno)
+              << "\n";
+    return false;
+  }
+  int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                0600);
+  if (fd < 0) {
+    std::cerr << "Unable to create " << temp_path << ": " << strerror(errno)
+              << "\n";
+    return false;
+  }
+  while (!contents.empty()) {
+    const ssize_t written = write(fd, contents.data(), contents.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    contents.remove_prefix(written);
+  }
+  if (!contents.empty() || fsync(fd) != 0) {
+    std::cerr << "Unable to write " << temp_path << ": " << strerror(errno)
+              << "\n";
+    close(fd);
+    unlink(temp_path.c_str());
+    return false;
+  }
+  if (close(fd) != 0 || rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::cerr << "Unable to replace " << path << ": " << strerror(errno)
+              << "\n";
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const char* usage =
+      "Usage: certificate_index_builder <output_file> <pem_directory>...\n"
+      "The output file holds the private keys of the certificates and is "
+      "created with mode 0600.";
+  std::vector<std::string> args =
+      quic::QuicParseCommandLineFlags(usage, argc, argv);
+
+  if (args.size() < 2) {
+    std::cerr << usage << std::endl;
+    return 1;
+  }
+
+  CertificateIndexBuilder builder;
+  for (size_t i = 1; i < args.size(); ++i) {
+    std::vector<std::string> directories, files;
+    if (!quiche::EnumerateDirectory(args[i], directories, files)) {
+      std::cerr << "Unable to list " << args[i] << "\n";
+      return 2;
+    }
+    std::sort(files.begin(), files.end());
+    for (const std::string& file : files) {
+      if (!absl::EndsWith(file, kCertificateExtension)) {
+        continue;
+      }
+      if (!AddChain(quiche::JoinPath(args[i], file), &builder)) {
+        return 2;
+      }
+    }
+  }
+
+  const std::string index = builder.Serialize();
+  if (index.empty()) {
+    std::cerr << "No certificate chains found\n";
+    return 2;
+  }
+  if (!WriteFileAtomically(args[0], index)) {
+    return 3;
+  }
+  std::cout << "Wrote " << builder.num_chains() << " certificate chains to "
+            << args[0] << "\n";
+  return 0;
+}
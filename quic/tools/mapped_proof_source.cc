@@ -0,0 +1,189 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/mapped_proof_source.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/core/crypto/crypto_protocol.h"
+#include "quic/core/quic_data_writer.h"
+#include "quic/platform/api/quic_logging.h"
+#include "common/quiche_endian.h"
+
+namespace quic {
+
+// static
+std::unique_ptr<MappedProofSource> MappedProofSource::Create(
+    const std::string& path, size_t max_cached_chains) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    QUIC_LOG(ERROR) << "Failed to open " << path << ": " << strerror(errno);
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    QUIC_LOG(ERROR) << "Failed to stat " << path << ": " << strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  const size_t mapping_size = file_stat.st_size;
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    QUIC_LOG(ERROR) << "Failed to map " << path << ": " << strerror(errno);
+    return nullptr;
+  }
+
+  absl::optional<CertificateIndex> index = CertificateIndex::Parse(
+      absl::string_view(static_cast<const char*>(mapping), mapping_size));
+  if (!index.has_value()) {
+    QUIC_LOG(ERROR) << path << " is not a valid certificate index";
+    munmap(mapping, mapping_size);
+    return nullptr;
+  }
+  auto proof_source = absl::WrapUnique(new MappedProofSource(
+      mapping, mapping_size, *index, max_cached_chains));
+  bool cert_matched_sni;
+  if (proof_source->GetCertificate("", &cert_matched_sni) == nullptr) {
+    QUIC_LOG(ERROR) << path << " has an invalid default certificate";
+    return nullptr;
+  }
+  return proof_source;
+}
+
+MappedProofSource::MappedProofSource(const void* mapping,
+                                     size_t mapping_size,
+                                     CertificateIndex index,
+                                     size_t max_cached_chains)
+    : mapping_(mapping),
+      mapping_size_(mapping_size),
+      index_(index),
+      // The most recent chain must stay cached while it is in use.
+      cache_(std::max<size_t>(max_cached_chains, 1)) {}
+
+MappedProofSource::~MappedProofSource() {
+  munmap(const_cast<void*>(mapping_), mapping_size_);
+}
+
+void MappedProofSource::GetProof(
+    const QuicSocketAddress& /*server_address*/,
+    const QuicSocketAddress& /*client_address*/,
+    const std::string& hostname,
+    const std::string& server_config,
+    QuicTransportVersion /*transport_version*/,
+    absl::string_view chlo_hash,
+    std::unique_ptr<ProofSource::Callback> callback) {
+  QuicCryptoProof proof;
+
+  size_t payload_size = sizeof(kProofSignatureLabel) + sizeof(uint32_t) +
+                        chlo_hash.size() + server_config.size();
+  auto payload = std::make_unique<char[]>(payload_size);
+  QuicDataWriter payload_writer(payload_size, payload.get(),
+                                quiche::Endianness::HOST_BYTE_ORDER);
+  bool success = payload_writer.WriteBytes(kProofSignatureLabel,
+                                           sizeof(kProofSignatureLabel)) &&
+                 payload_writer.WriteUInt32(chlo_hash.size()) &&
+                 payload_writer.WriteStringPiece(chlo_hash) &&
+                 payload_writer.WriteStringPiece(server_config);
+  Certificate* certificate =
+      success ? GetCertificate(hostname, &proof.cert_matched_sni) : nullptr;
+  if (certificate == nullptr) {
+    callback->Run(/*ok=*/false, nullptr, proof, nullptr);
+    return;
+  }
+
+  proof.signature =
+      certificate->key->Sign(absl::string_view(payload.get(), payload_size),
+                             SSL_SIGN_RSA_PSS_RSAE_SHA256);
+  proof.leaf_cert_scts = certificate->signed_certificate_timestamps;
+  callback->Run(/*ok=*/!proof.signature.empty(), certificate->chain, proof,
+                nullptr);
+}
+
+QuicReferenceCountedPointer<ProofSource::Chain>
+MappedProofSource::GetCertChain(const QuicSocketAddress& /*server_address*/,
+                                const QuicSocketAddress& /*client_address*/,
+                                const std::string& hostname,
+                                bool* cert_matched_sni) {
+  Certificate* certificate = GetCertificate(hostname, cert_matched_sni);
+  if (certificate == nullptr) {
+    return nullptr;
+  }
+  return certificate->chain;
+}
+
+void MappedProofSource::ComputeTlsSignature(
+    const QuicSocketAddress& /*server_address*/,
+    const QuicSocketAddress& /*client_address*/,
+    const std::string& hostname,
+    uint16_t signature_algorithm,
+    absl::string_view in,
+    std::unique_ptr<ProofSource::SignatureCallback> callback) {
+  bool cert_matched_sni;
+  Certificate* certificate = GetCertificate(hostname, &cert_matched_sni);
+  std::string signature;
+  if (certificate != nullptr) {
+    signature = certificate->key->Sign(in, signature_algorithm);
+  }
+  callback->Run(/*ok=*/!signature.empty(), signature, nullptr);
+}
+
+absl::InlinedVector<uint16_t, 8>
+MappedProofSource::SupportedTlsSignatureAlgorithms() const {
+  // Let ComputeTlsSignature() report an error if a bad signature algorithm is
+  // requested.
+  return {};
+}
+
+ProofSource::TicketCrypter* MappedProofSource::GetTicketCrypter() {
+  return nullptr;
+}
+
+MappedProofSource::Certificate* MappedProofSource::GetCertificate(
+    const std::string& hostname, bool* cert_matched_sni) {
+  absl::optional<uint32_t> chain_id = index_.FindChain(hostname);
+  *cert_matched_sni = chain_id.has_value();
+  if (!chain_id.has_value()) {
+    chain_id = CertificateIndex::kDefaultChainId;
+  }
+
+  auto it = cache_.Lookup(*chain_id);
+  if (it != cache_.end()) {
+    return it->second.get();
+  }
+
+  absl::optional<CertificateIndex::ChainEntry> entry =
+      index_.GetChain(*chain_id);
+  if (!entry.has_value()) {
+    QUIC_LOG_FIRST_N(ERROR, 1) << "Malformed certificate chain " << *chain_id;
+    return nullptr;
+  }
+  auto certificate = std::make_unique<Certificate>();
+  certificate->key = CertificatePrivateKey::LoadFromDer(entry->private_key);
+  if (certificate->key == nullptr) {
+    QUIC_LOG_FIRST_N(ERROR, 1)
+        << "Malformed private key for certificate chain " << *chain_id;
+    return nullptr;
+  }
+  certificate->chain = QuicReferenceCountedPointer<Chain>(new Chain(
+      std::vector<std::string>(entry->certs.begin(), entry->certs.end())));
+  certificate->signed_certificate_timestamps =
+      std::string(entry->signed_certificate_timestamps);
+
+  Certificate* result = certificate.get();
+  cache_.Insert(*chain_id, std::move(certificate));
+  return result;
+}
+
+}  // namespace quic
@@ -0,0 +1,93 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_MAPPED_PROOF_SOURCE_H_
+#define QUICHE_QUIC_TOOLS_MAPPED_PROOF_SOURCE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/crypto/certificate_index.h"
+#include "quic/core/crypto/certificate_view.h"
+#include "quic/core/crypto/proof_source.h"
+#include "quic/core/quic_lru_cache.h"
+
+namespace quic {
+
+// MappedProofSource serves certificates from a CertificateIndex file, as
+// written by certificate_index_builder_bin, which is memory-mapped read-only.
+// Opening the index does not read the certificates, so startup time and
+// resident memory do not grow with the number of certificates; pages of the
+// index are only faulted in for the hostnames which are actually served.
+// Certificates are selected the same way as in ProofSourceX509, and the
+// |max_cached_chains| most recently used chains are kept parsed, along with
+// their private keys.
+//
+// The index file must not be modified while it is mapped. To update it, write
+// a new file and rename it over the old one, as certificate_index_builder_bin
+// does; running servers keep using the old index until they reopen it.
+class QUIC_NO_EXPORT MappedProofSource : public ProofSource {
+ public:
+  // Returns nullptr if |path| cannot be mapped or is not a valid index.
+  static std::unique_ptr<MappedProofSource> Create(const std::string& path,
+                                                   size_t max_cached_chains);
+
+  MappedProofSource(const MappedProofSource&) = delete;
+  MappedProofSource& operator=(const MappedProofSource&) = delete;
+  ~MappedProofSource() override;
+
+  // ProofSource implementation.
+  void GetProof(const QuicSocketAddress& server_address,
+                const QuicSocketAddress& client_address,
+                const std::string& hostname,
+                const std::string& server_config,
+                QuicTransportVersion transport_version,
+                absl::string_view chlo_hash,
+                std::unique_ptr<Callback> callback) override;
+  QuicReferenceCountedPointer<Chain> GetCertChain(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address, const std::string& hostname,
+      bool* cert_matched_sni) override;
+  void ComputeTlsSignature(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address, const std::string& hostname,
+      uint16_t signature_algorithm, absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override;
+  absl::InlinedVector<uint16_t, 8> SupportedTlsSignatureAlgorithms()
+      const override;
+  TicketCrypter* GetTicketCrypter() override;
+
+  size_t num_cached_chains() const { return cache_.Size(); }
+
+ private:
+  struct QUIC_NO_EXPORT Certificate {
+    QuicReferenceCountedPointer<Chain> chain;
+    std::unique_ptr<CertificatePrivateKey> key;
+    std::string signed_certificate_timestamps;
+  };
+
+  MappedProofSource(const void* mapping,
+                    size_t mapping_size,
+                    CertificateIndex index,
+                    size_t max_cached_chains);
+
+  // Returns the certificate for |hostname|, or the default one if none
+  // matches. Returns nullptr if the index entry is malformed. The result is
+  // only valid until the next call.
+  Certificate* GetCertificate(const std::string& hostname,
+                              bool* cert_matched_sni);
+
+  const void* const mapping_;
+  const size_t mapping_size_;
+  const CertificateIndex index_;
+  // Keyed by chain ID.
+  QuicLRUCache<uint32_t, Certificate> cache_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_MAPPED_PROOF_SOURCE_H_
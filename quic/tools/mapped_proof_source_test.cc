@@ -0,0 +1,148 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/mapped_proof_source.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/core/crypto/certificate_index.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/test_certificates.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class SignatureCallback : public ProofSource::SignatureCallback {
+ public:
+  explicit SignatureCallback(std::string* out) : out_(out) {}
+
+  void Run(bool ok,
+           std::string signature,
+           std::unique_ptr<ProofSource::Details> /*details*/) override {
+    *out_ = ok ? signature : "";
+  }
+
+ private:
+  std::string* out_;
+};
+
+class MappedProofSourceTest : public QuicTest {
+ public:
+  MappedProofSourceTest()
+      : path_(absl::StrCat(
+            ::testing::TempDir(), "/mapped_proof_source_test_", getpid(), "_",
+            ::testing::UnitTest::GetInstance()->current_test_info()->name())) {
+    std::unique_ptr<CertificatePrivateKey> test_key =
+        CertificatePrivateKey::LoadFromDer(kTestCertificatePrivateKey);
+    std::unique_ptr<CertificatePrivateKey> wildcard_key =
+        CertificatePrivateKey::LoadFromDer(kWildcardCertificatePrivateKey);
+    QUICHE_CHECK(test_key != nullptr);
+    QUICHE_CHECK(wildcard_key != nullptr);
+    CertificateIndexBuilder builder;
+    QUICHE_CHECK(builder.AddChain({std::string(kTestCertificate)}, *test_key,
+                                  "", "scts"));
+    QUICHE_CHECK(builder.AddChain({std::string(kWildcardCertificate)},
+                                  *wildcard_key, "", ""));
+    WriteIndex(builder.Serialize());
+  }
+
+  ~MappedProofSourceTest() override { unlink(path_.c_str()); }
+
+ protected:
+  void WriteIndex(const std::string& data) {
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    file << data;
+  }
+
+  const std::string path_;
+  const QuicSocketAddress server_address_;
+  const QuicSocketAddress client_address_;
+};
+
+TEST_F(MappedProofSourceTest, InvalidIndex) {
+  EXPECT_EQ(nullptr, MappedProofSource::Create(path_ + ".missing", 16));
+  WriteIndex("not an index");
+  EXPECT_EQ(nullptr, MappedProofSource::Create(path_, 16));
+}
+
+TEST_F(MappedProofSourceTest, CertificateSelection) {
+  std::unique_ptr<MappedProofSource> proof_source =
+      MappedProofSource::Create(path_, 16);
+  ASSERT_TRUE(proof_source != nullptr);
+
+  bool cert_matched_sni;
+  // Default certificate.
+  EXPECT_EQ(proof_source
+                ->GetCertChain(server_address_, client_address_, "unknown.test",
+                               &cert_matched_sni)
+                ->certs[0],
+            kTestCertificate);
+  EXPECT_FALSE(cert_matched_sni);
+  // mail.example.org is explicitly a SubjectAltName in kTestCertificate.
+  EXPECT_EQ(proof_source
+                ->GetCertChain(server_address_, client_address_,
+                               "mail.example.org", &cert_matched_sni)
+                ->certs[0],
+            kTestCertificate);
+  EXPECT_TRUE(cert_matched_sni);
+  // *.wildcard.test is in kWildcardCertificate.
+  EXPECT_EQ(proof_source
+                ->GetCertChain(server_address_, client_address_,
+                               "www.wildcard.test", &cert_matched_sni)
+                ->certs[0],
+            kWildcardCertificate);
+  EXPECT_TRUE(cert_matched_sni);
+  EXPECT_EQ(2u, proof_source->num_cached_chains());
+}
+
+TEST_F(MappedProofSourceTest, CacheEviction) {
+  std::unique_ptr<MappedProofSource> proof_source =
+      MappedProofSource::Create(path_, 1);
+  ASSERT_TRUE(proof_source != nullptr);
+
+  bool cert_matched_sni;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(proof_source
+                  ->GetCertChain(server_address_, client_address_,
+                                 "www.wildcard.test", &cert_matched_sni)
+                  ->certs[0],
+              kWildcardCertificate);
+    EXPECT_EQ(proof_source
+                  ->GetCertChain(server_address_, client_address_,
+                                 "mail.example.org", &cert_matched_sni)
+                  ->certs[0],
+              kTestCertificate);
+  }
+  EXPECT_EQ(1u, proof_source->num_cached_chains());
+}
+
+TEST_F(MappedProofSourceTest, TlsSignature) {
+  std::unique_ptr<MappedProofSource> proof_source =
+      MappedProofSource::Create(path_, 16);
+  ASSERT_TRUE(proof_source != nullptr);
+
+  std::string signature;
+  proof_source->ComputeTlsSignature(
+      server_address_, client_address_, "example.com",
+      SSL_SIGN_RSA_PSS_RSAE_SHA256, "Test data",
+      std::make_unique<SignatureCallback>(&signature));
+  ASSERT_FALSE(signature.empty());
+
+  std::unique_ptr<CertificateView> view =
+      CertificateView::ParseSingleCertificate(kTestCertificate);
+  ASSERT_TRUE(view != nullptr);
+  EXPECT_TRUE(view->VerifySignature("Test data", signature,
+                                    SSL_SIGN_RSA_PSS_RSAE_SHA256));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
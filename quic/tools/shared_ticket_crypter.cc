@@ -0,0 +1,389 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/shared_ticket_crypter.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "third_party/boringssl/src/include/openssl/aead.h"
+#include "third_party/boringssl/src/include/openssl/rand.h"
+#include "quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// The format of an encrypted ticket is the same as SimpleTicketCrypter's: 1
+// byte for the key epoch, followed by 16 bytes of IV, followed by the output
+// from the AES-GCM Seal operation. The IV doubles as the ticket nonce recorded
+// in the strike register.
+constexpr size_t kEpochSize = 1;
+constexpr size_t kIVSize = 16;
+constexpr size_t kAuthTagSize = 16;
+
+constexpr size_t kIVOffset = kEpochSize;
+constexpr size_t kMessageOffset = kIVOffset + kIVSize;
+
+constexpr uint64_t kKeyRingMagic = 0x5143544b52494e47;  // "QCTKRING"
+
+// Number of strike register entries looked at when inserting a nonce.
+constexpr size_t kMaxStrikeRegisterProbes = 16;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared memory requires lock-free atomics");
+
+// Holds an exclusive lock on a file for the duration of a scope.
+class ScopedFileLock {
+ public:
+  explicit ScopedFileLock(int fd) : fd_(fd) {
+    int rv;
+    do {
+      rv = flock(fd_, LOCK_EX);
+    } while (rv != 0 && errno == EINTR);
+    locked_ = rv == 0;
+    if (!locked_) {
+      QUIC_LOG(ERROR) << "Failed to lock ticket key file: " << strerror(errno);
+    }
+  }
+  ScopedFileLock(const ScopedFileLock&) = delete;
+  ScopedFileLock& operator=(const ScopedFileLock&) = delete;
+  ~ScopedFileLock() {
+    if (locked_) {
+      flock(fd_, LOCK_UN);
+    }
+  }
+
+  bool locked() const { return locked_; }
+
+ private:
+  const int fd_;
+  bool locked_ = false;
+};
+
+}  // namespace
+
+// Layout of the beginning of the shared file, followed by the strike register.
+// All fields are only modified with the file lock held. |sequence| is odd while
+// the keys are being modified, so that processes can read them without taking
+// the lock.
+struct SharedTicketCrypter::SharedKeyRing {
+  std::atomic<uint64_t> magic;
+  std::atomic<uint64_t> strike_register_size;
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> current_epoch;
+  // UNIX time in microseconds.
+  std::atomic<uint64_t> current_key_expiration;
+  // Indexed by epoch % kNumKeys.
+  std::atomic<uint64_t> keys[kNumKeys][kKeySize / sizeof(uint64_t)];
+};
+
+// static
+std::unique_ptr<SharedTicketCrypter> SharedTicketCrypter::Create(
+    const std::string& path,
+    const QuicClock* clock,
+    const Options& options) {
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    QUIC_LOG(ERROR) << "Failed to open " << path << ": " << strerror(errno);
+    return nullptr;
+  }
+  const size_t mapping_size =
+      sizeof(SharedKeyRing) +
+      options.strike_register_size * sizeof(std::atomic<uint64_t>);
+  // Growing the file is idempotent, so concurrent callers do not need the lock.
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      (static_cast<size_t>(file_stat.st_size) < mapping_size &&
+       ftruncate(fd, mapping_size) != 0)) {
+    QUIC_LOG(ERROR) << "Failed to size " << path << ": " << strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    QUIC_LOG(ERROR) << "Failed to map " << path << ": " << strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  // From here on the crypter owns |fd| and |mapping|.
+  auto crypter = absl::WrapUnique(
+      new SharedTicketCrypter(fd, mapping, mapping_size, clock, options));
+
+  ScopedFileLock lock(fd);
+  if (!lock.locked()) {
+    return nullptr;
+  }
+  SharedKeyRing* key_ring = crypter->key_ring_;
+  if (key_ring->magic.load(std::memory_order_acquire) != kKeyRingMagic) {
+    key_ring->strike_register_size.store(options.strike_register_size,
+                                         std::memory_order_relaxed);
+    // Fill both key slots, so that the previous epoch has a valid key too.
+    uint8_t epoch;
+    RAND_bytes(&epoch, 1);
+    crypter->GenerateNextKey(epoch);
+    crypter->GenerateNextKey(epoch + 1);
+    key_ring->magic.store(kKeyRingMagic, std::memory_order_release);
+  } else if (key_ring->strike_register_size.load(std::memory_order_relaxed) !=
+             options.strike_register_size) {
+    QUIC_LOG(ERROR) << path << " has a strike register of "
+                    << key_ring->strike_register_size.load() << " entries, "
+                    << options.strike_register_size << " expected";
+    return nullptr;
+  } else if (key_ring->sequence.load(std::memory_order_relaxed) % 2 != 0) {
+    // A process died while rotating keys. Nobody else holds the lock, so the
+    // key ring can be repaired by generating a fresh key.
+    QUIC_LOG(WARNING) << "Repairing interrupted key rotation in " << path;
+    key_ring->sequence.fetch_add(1, std::memory_order_relaxed);
+    crypter->GenerateNextKey(static_cast<uint8_t>(
+        key_ring->current_epoch.load(std::memory_order_relaxed)));
+  }
+  crypter->RefreshKeys();
+  return crypter;
+}
+
+SharedTicketCrypter::SharedTicketCrypter(int fd,
+                                         void* mapping,
+                                         size_t mapping_size,
+                                         const QuicClock* clock,
+                                         const Options& options)
+    : fd_(fd),
+      mapping_(mapping),
+      mapping_size_(mapping_size),
+      key_ring_(static_cast<SharedKeyRing*>(mapping)),
+      clock_(clock),
+      options_(options) {}
+
+SharedTicketCrypter::~SharedTicketCrypter() {
+  munmap(mapping_, mapping_size_);
+  close(fd_);
+}
+
+size_t SharedTicketCrypter::MaxOverhead() {
+  return kEpochSize + kIVSize + kAuthTagSize;
+}
+
+std::vector<uint8_t> SharedTicketCrypter::Encrypt(
+    absl::string_view in, absl::string_view encryption_key) {
+  QUICHE_DCHECK(encryption_key.empty());
+  MaybeRotateKeys();
+  if (!aead_ctxs_usable_[current_epoch_ % kNumKeys]) {
+    return std::vector<uint8_t>();
+  }
+  std::vector<uint8_t> out(in.size() + MaxOverhead());
+  out[0] = current_epoch_;
+  RAND_bytes(out.data() + kIVOffset, kIVSize);
+  size_t out_len;
+  const EVP_AEAD_CTX* ctx = aead_ctxs_[current_epoch_ % kNumKeys].get();
+  if (!EVP_AEAD_CTX_seal(ctx, out.data() + kMessageOffset, &out_len,
+                         out.size() - kMessageOffset, out.data() + kIVOffset,
+                         kIVSize, reinterpret_cast<const uint8_t*>(in.data()),
+                         in.size(), nullptr, 0)) {
+    return std::vector<uint8_t>();
+  }
+  out.resize(out_len + kMessageOffset);
+  return out;
+}
+
+std::vector<uint8_t> SharedTicketCrypter::Decrypt(absl::string_view in,
+                                                  bool* early_data_allowed) {
+  *early_data_allowed = true;
+  MaybeRotateKeys();
+  if (in.size() < kMessageOffset) {
+    return std::vector<uint8_t>();
+  }
+  const uint8_t* input = reinterpret_cast<const uint8_t*>(in.data());
+  const uint8_t epoch = input[0];
+  if ((epoch != current_epoch_ &&
+       epoch != static_cast<uint8_t>(current_epoch_ - 1)) ||
+      !aead_ctxs_usable_[epoch % kNumKeys]) {
+    return std::vector<uint8_t>();
+  }
+  std::vector<uint8_t> out(in.size() - kMessageOffset);
+  size_t out_len;
+  if (!EVP_AEAD_CTX_open(aead_ctxs_[epoch % kNumKeys].get(), out.data(),
+                         &out_len, out.size(), input + kIVOffset, kIVSize,
+                         input + kMessageOffset, in.size() - kMessageOffset,
+                         nullptr, 0)) {
+    return std::vector<uint8_t>();
+  }
+  // Only authenticated tickets make it to the strike register, so it cannot be
+  // filled with forged nonces.
+  if (options_.strike_register_size > 0) {
+    switch (InsertNonce(in.substr(kIVOffset, kIVSize))) {
+      case InsertNonceResult::kInserted:
+        break;
+      case InsertNonceResult::kReplay:
+        QUIC_DLOG(INFO) << "Disabling early data for replayed session ticket";
+        ++num_replays_detected_;
+        *early_data_allowed = false;
+        break;
+      case InsertNonceResult::kFull:
+        *early_data_allowed = false;
+        break;
+    }
+    if (!*early_data_allowed) {
+      ++num_early_data_disabled_;
+    }
+  }
+  out.resize(out_len);
+  return out;
+}
+
+void SharedTicketCrypter::Decrypt(
+    absl::string_view in,
+    std::unique_ptr<quic::ProofSource::DecryptCallback> callback) {
+  bool early_data_allowed;
+  std::vector<uint8_t> plaintext = Decrypt(in, &early_data_allowed);
+  if (!plaintext.empty() && !early_data_allowed) {
+    callback->RunWithoutEarlyData(std::move(plaintext));
+    return;
+  }
+  callback->Run(std::move(plaintext));
+}
+
+void SharedTicketCrypter::MaybeRotateKeys() {
+  RefreshKeys();
+  const QuicWallTime now = clock_->WallNow();
+  if (!now.IsAfter(current_key_expiration_)) {
+    return;
+  }
+  {
+    ScopedFileLock lock(fd_);
+    if (!lock.locked()) {
+      return;
+    }
+    // Another process may have rotated the keys while this one waited.
+    RefreshKeys();
+    if (now.IsAfter(current_key_expiration_)) {
+      GenerateNextKey(current_epoch_);
+    }
+  }
+  RefreshKeys();
+}
+
+void SharedTicketCrypter::RefreshKeys() {
+  uint64_t sequence = key_ring_->sequence.load(std::memory_order_acquire);
+  if (sequence == key_ring_sequence_) {
+    return;
+  }
+
+  uint64_t epoch;
+  uint64_t expiration;
+  uint64_t keys[kNumKeys][kKeySize / sizeof(uint64_t)];
+  while (true) {
+    if (sequence % 2 == 0) {
+      epoch = key_ring_->current_epoch.load(std::memory_order_relaxed);
+      expiration =
+          key_ring_->current_key_expiration.load(std::memory_order_relaxed);
+      for (size_t i = 0; i < kNumKeys; ++i) {
+        for (size_t j = 0; j < kKeySize / sizeof(uint64_t); ++j) {
+          keys[i][j] = key_ring_->keys[i][j].load(std::memory_order_relaxed);
+        }
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const uint64_t end_sequence =
+          key_ring_->sequence.load(std::memory_order_relaxed);
+      if (end_sequence == sequence) {
+        break;
+      }
+    }
+    // A rotation is in progress, which only takes a few instructions.
+    sequence = key_ring_->sequence.load(std::memory_order_acquire);
+  }
+
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    aead_ctxs_[i].Reset();
+    aead_ctxs_usable_[i] = EVP_AEAD_CTX_init(
+        aead_ctxs_[i].get(), EVP_aead_aes_128_gcm(),
+        reinterpret_cast<const uint8_t*>(keys[i]), kKeySize,
+        EVP_AEAD_DEFAULT_TAG_LENGTH, nullptr);
+    if (!aead_ctxs_usable_[i]) {
+      QUIC_LOG_FIRST_N(ERROR, 10)
+          << "Failed to initialize ticket key " << i
+          << "; tickets using it cannot be encrypted or decrypted";
+    }
+  }
+  current_epoch_ = static_cast<uint8_t>(epoch);
+  current_key_expiration_ = QuicWallTime::FromUNIXMicroseconds(expiration);
+  key_ring_sequence_ = sequence;
+}
+
+void SharedTicketCrypter::GenerateNextKey(uint8_t epoch) {
+  const uint8_t next_epoch = epoch + 1;
+  uint64_t key[kKeySize / sizeof(uint64_t)];
+  RAND_bytes(reinterpret_cast<uint8_t*>(key), kKeySize);
+  const uint64_t expiration =
+      clock_->WallNow().Add(options_.key_lifetime).ToUNIXMicroseconds();
+
+  const uint64_t sequence = key_ring_->sequence.load(std::memory_order_relaxed);
+  key_ring_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t j = 0; j < kKeySize / sizeof(uint64_t); ++j) {
+    key_ring_->keys[next_epoch % kNumKeys][j].store(key[j],
+                                                    std::memory_order_relaxed);
+  }
+  key_ring_->current_epoch.store(next_epoch, std::memory_order_relaxed);
+  key_ring_->current_key_expiration.store(expiration,
+                                          std::memory_order_relaxed);
+  key_ring_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+SharedTicketCrypter::InsertNonceResult SharedTicketCrypter::InsertNonce(
+    absl::string_view nonce) {
+  uint32_t hash;
+  QUICHE_DCHECK_GE(nonce.size(), sizeof(hash));
+  memcpy(&hash, nonce.data(), sizeof(hash));
+  // Zero marks an empty entry.
+  hash |= 1;
+  const QuicWallTime now = clock_->WallNow();
+  // Past the replay window, BoringSSL rejects early data of a replayed
+  // ClientHello by itself, so the entry can be reused.
+  const uint64_t entry_expiration =
+      now.Add(options_.replay_window).ToUNIXSeconds();
+  const uint64_t new_entry =
+      (static_cast<uint64_t>(hash) << 32) | (entry_expiration & 0xffffffff);
+
+  std::atomic<uint64_t>* entries = strike_register();
+  const size_t size = options_.strike_register_size;
+  for (size_t i = 0; i < std::min(kMaxStrikeRegisterProbes, size); ++i) {
+    std::atomic<uint64_t>& entry = entries[(hash + i) % size];
+    uint64_t existing = entry.load(std::memory_order_acquire);
+    while (true) {
+      if (existing >> 32 == hash &&
+          (existing & 0xffffffff) > now.ToUNIXSeconds()) {
+        return InsertNonceResult::kReplay;
+      }
+      if (existing != 0 && (existing & 0xffffffff) > now.ToUNIXSeconds()) {
+        // Live entry for another nonce.
+        break;
+      }
+      if (entry.compare_exchange_weak(existing, new_entry,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        return InsertNonceResult::kInserted;
+      }
+      // |existing| has been reloaded, possibly with the same nonce inserted
+      // by another process.
+    }
+  }
+  QUIC_LOG_FIRST_N(WARNING, 10)
+      << "Strike register is full, disabling early data";
+  return InsertNonceResult::kFull;
+}
+
+std::atomic<uint64_t>* SharedTicketCrypter::strike_register() const {
+  return reinterpret_cast<std::atomic<uint64_t>*>(key_ring_ + 1);
+}
+
+}  // namespace quic
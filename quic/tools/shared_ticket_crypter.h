@@ -0,0 +1,138 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_SHARED_TICKET_CRYPTER_H_
+#define QUICHE_QUIC_TOOLS_SHARED_TICKET_CRYPTER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "third_party/boringssl/src/include/openssl/aead.h"
+#include "quic/core/crypto/proof_source.h"
+#include "quic/core/quic_clock.h"
+#include "quic/core/quic_time.h"
+
+namespace quic {
+
+// SharedTicketCrypter implements ProofSource::TicketCrypter with ticket keys
+// stored in a file which is memory-mapped by every server process on the host,
+// so that a ticket issued by one process can be used to resume a session on
+// any other. Keys rotate every |key_lifetime|: the first process to notice that
+// the current key expired generates the next one under an exclusive file lock,
+// and the others pick it up from the mapping. Tickets encrypted with the
+// previous key can still be decrypted.
+//
+// If |strike_register_size| is non-zero, the file also holds a strike register
+// of ticket nonces shared by all processes, and only the first use of a ticket
+// may carry early data. A replayed ticket, which could be used to replay 0-RTT
+// data to another process, still resumes the session but without early data.
+// The same applies when the strike register has no room for the nonce, so a
+// full register only costs 0-RTT, not resumption.
+//
+// All processes sharing a file must use the same |strike_register_size|.
+class QUIC_NO_EXPORT SharedTicketCrypter
+    : public quic::ProofSource::TicketCrypter {
+ public:
+  struct QUIC_NO_EXPORT Options {
+    QuicTime::Delta key_lifetime = QuicTime::Delta::FromSeconds(60 * 60 * 24);
+    // Number of nonces the strike register can hold. Zero disables it.
+    size_t strike_register_size = 0;
+    // How long a nonce is kept in the strike register. BoringSSL rejects early
+    // data whose ticket age is off by more than 60 seconds either way, so a
+    // ClientHello replayed later than that cannot carry early data anyway.
+    QuicTime::Delta replay_window = QuicTime::Delta::FromSeconds(120);
+  };
+
+  // Maps the key ring stored at |path|, creating and initializing it if
+  // needed. Returns nullptr on failure.
+  static std::unique_ptr<SharedTicketCrypter> Create(const std::string& path,
+                                                     const QuicClock* clock,
+                                                     const Options& options);
+
+  SharedTicketCrypter(const SharedTicketCrypter&) = delete;
+  SharedTicketCrypter& operator=(const SharedTicketCrypter&) = delete;
+  ~SharedTicketCrypter() override;
+
+  // ProofSource::TicketCrypter implementation.
+  size_t MaxOverhead() override;
+  std::vector<uint8_t> Encrypt(absl::string_view in,
+                               absl::string_view encryption_key) override;
+  void Decrypt(
+      absl::string_view in,
+      std::unique_ptr<quic::ProofSource::DecryptCallback> callback) override;
+
+  // Number of tickets whose nonce had already been used.
+  uint64_t num_replays_detected() const { return num_replays_detected_; }
+
+  // Number of tickets accepted without early data because their nonce had
+  // already been used or did not fit in the strike register.
+  uint64_t num_early_data_disabled() const { return num_early_data_disabled_; }
+
+ private:
+  struct SharedKeyRing;
+
+  static constexpr size_t kKeySize = 16;
+  static constexpr size_t kNumKeys = 2;
+
+  SharedTicketCrypter(int fd,
+                      void* mapping,
+                      size_t mapping_size,
+                      const QuicClock* clock,
+                      const Options& options);
+
+  // Returns the decrypted ticket, or an empty vector on failure. Sets
+  // |early_data_allowed| to false if the ticket must not carry early data.
+  std::vector<uint8_t> Decrypt(absl::string_view in, bool* early_data_allowed);
+
+  // Rotates the shared keys if the current one expired, then makes sure the
+  // local AEAD contexts match the shared key ring.
+  void MaybeRotateKeys();
+  // Rebuilds the local AEAD contexts if another process changed the key ring.
+  void RefreshKeys();
+  // Generates the key for the epoch following |epoch|. Must be called with the
+  // file lock held.
+  void GenerateNextKey(uint8_t epoch);
+
+  enum class InsertNonceResult {
+    kInserted,
+    kReplay,
+    kFull,
+  };
+
+  // Records |nonce| in the strike register for |replay_window|.
+  InsertNonceResult InsertNonce(absl::string_view nonce);
+
+  // Each entry holds 32 bits of a nonce in its upper half, and the UNIX time
+  // in seconds after which the entry may be reused in its lower half. Zero
+  // marks an empty entry.
+  std::atomic<uint64_t>* strike_register() const;
+
+  const int fd_;
+  void* const mapping_;
+  const size_t mapping_size_;
+  SharedKeyRing* const key_ring_;
+  const QuicClock* clock_;
+  const Options options_;
+
+  // Sequence number of the key ring which |aead_ctxs_| were built from.
+  uint64_t key_ring_sequence_ = 0;
+  uint8_t current_epoch_ = 0;
+  QuicWallTime current_key_expiration_ = QuicWallTime::Zero();
+  // Contexts for the current and previous keys, indexed by epoch % kNumKeys.
+  bssl::ScopedEVP_AEAD_CTX aead_ctxs_[kNumKeys];
+  // Whether the context with the same index could be initialized.
+  bool aead_ctxs_usable_[kNumKeys] = {};
+
+  uint64_t num_replays_detected_ = 0;
+  uint64_t num_early_data_disabled_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_SHARED_TICKET_CRYPTER_H_
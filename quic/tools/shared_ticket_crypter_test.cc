@@ -0,0 +1,248 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/shared_ticket_crypter.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+constexpr QuicTime::Delta kOneDay = QuicTime::Delta::FromSeconds(60 * 60 * 24);
+
+class DecryptCallback : public quic::ProofSource::DecryptCallback {
+ public:
+  DecryptCallback(std::vector<uint8_t>* out, bool* early_data_allowed)
+      : out_(out), early_data_allowed_(early_data_allowed) {}
+
+  void Run(std::vector<uint8_t> plaintext) override {
+    *out_ = plaintext;
+    *early_data_allowed_ = true;
+  }
+
+  void RunWithoutEarlyData(std::vector<uint8_t> plaintext) override {
+    *out_ = plaintext;
+    *early_data_allowed_ = false;
+  }
+
+ private:
+  std::vector<uint8_t>* out_;
+  bool* early_data_allowed_;
+};
+
+absl::string_view StringPiece(const std::vector<uint8_t>& in) {
+  return absl::string_view(reinterpret_cast<const char*>(in.data()), in.size());
+}
+
+std::vector<uint8_t> Decrypt(SharedTicketCrypter* crypter,
+                             const std::vector<uint8_t>& ciphertext,
+                             bool* early_data_allowed) {
+  std::vector<uint8_t> out;
+  crypter->Decrypt(StringPiece(ciphertext),
+                   std::make_unique<DecryptCallback>(&out, early_data_allowed));
+  return out;
+}
+
+std::vector<uint8_t> Decrypt(SharedTicketCrypter* crypter,
+                             const std::vector<uint8_t>& ciphertext) {
+  bool early_data_allowed;
+  return Decrypt(crypter, ciphertext, &early_data_allowed);
+}
+
+// Each crypter maps the key file separately, as the server processes of a
+// fleet would.
+class SharedTicketCrypterTest : public QuicTest {
+ public:
+  SharedTicketCrypterTest()
+      : path_(absl::StrCat(
+            ::testing::TempDir(), "/shared_ticket_crypter_test_", getpid(), "_",
+            ::testing::UnitTest::GetInstance()->current_test_info()->name())) {
+    unlink(path_.c_str());
+    options_.key_lifetime = kOneDay;
+  }
+
+  ~SharedTicketCrypterTest() override { unlink(path_.c_str()); }
+
+ protected:
+  std::unique_ptr<SharedTicketCrypter> CreateCrypter() {
+    return SharedTicketCrypter::Create(path_, &mock_clock_, options_);
+  }
+
+  const std::string path_;
+  MockClock mock_clock_;
+  SharedTicketCrypter::Options options_;
+};
+
+TEST_F(SharedTicketCrypterTest, EncryptDecrypt) {
+  std::unique_ptr<SharedTicketCrypter> crypter = CreateCrypter();
+  ASSERT_TRUE(crypter != nullptr);
+  std::vector<uint8_t> plaintext = {1, 2, 3, 4, 5};
+  std::vector<uint8_t> ciphertext =
+      crypter->Encrypt(StringPiece(plaintext), {});
+  EXPECT_NE(plaintext, ciphertext);
+  EXPECT_EQ(plaintext, Decrypt(crypter.get(), ciphertext));
+}
+
+TEST_F(SharedTicketCrypterTest, ResumesAcrossProcesses) {
+  const int kNumProcesses = 4;
+  std::vector<std::unique_ptr<SharedTicketCrypter>> crypters;
+  for (int i = 0; i < kNumProcesses; ++i) {
+    crypters.push_back(CreateCrypter());
+    ASSERT_TRUE(crypters.back() != nullptr);
+  }
+
+  // Every ticket is resumed by a different process than the one issuing it.
+  int num_resumed = 0;
+  const int kNumTickets = 100;
+  for (int i = 0; i < kNumTickets; ++i) {
+    std::vector<uint8_t> plaintext = {static_cast<uint8_t>(i), 2, 3};
+    std::vector<uint8_t> ciphertext =
+        crypters[i % kNumProcesses]->Encrypt(StringPiece(plaintext), {});
+    if (Decrypt(crypters[(i + 1) % kNumProcesses].get(), ciphertext) ==
+        plaintext) {
+      ++num_resumed;
+    }
+  }
+  EXPECT_EQ(kNumTickets, num_resumed);
+}
+
+TEST_F(SharedTicketCrypterTest, KeyRotationIsShared) {
+  std::unique_ptr<SharedTicketCrypter> crypter1 = CreateCrypter();
+  std::unique_ptr<SharedTicketCrypter> crypter2 = CreateCrypter();
+  ASSERT_TRUE(crypter1 != nullptr && crypter2 != nullptr);
+  std::vector<uint8_t> plaintext = {1, 2, 3};
+  std::vector<uint8_t> old_ciphertext =
+      crypter1->Encrypt(StringPiece(plaintext), {});
+
+  mock_clock_.AdvanceTime(kOneDay * 2);
+  // crypter1 rotates the key, and crypter2 uses the new one.
+  std::vector<uint8_t> new_ciphertext1 =
+      crypter1->Encrypt(StringPiece(plaintext), {});
+  std::vector<uint8_t> new_ciphertext2 =
+      crypter2->Encrypt(StringPiece(plaintext), {});
+  EXPECT_NE(old_ciphertext[0], new_ciphertext1[0]);
+  EXPECT_EQ(new_ciphertext1[0], new_ciphertext2[0]);
+
+  // Tickets encrypted with the previous key still decrypt.
+  EXPECT_EQ(plaintext, Decrypt(crypter2.get(), old_ciphertext));
+  EXPECT_EQ(plaintext, Decrypt(crypter2.get(), new_ciphertext1));
+
+  // After another rotation, the first key is gone.
+  mock_clock_.AdvanceTime(kOneDay * 2);
+  EXPECT_TRUE(Decrypt(crypter1.get(), old_ciphertext).empty());
+  EXPECT_EQ(plaintext, Decrypt(crypter2.get(), new_ciphertext2));
+}
+
+TEST_F(SharedTicketCrypterTest, KeysSurviveProcessRestart) {
+  std::vector<uint8_t> plaintext = {1, 2, 3};
+  std::vector<uint8_t> ciphertext;
+  {
+    std::unique_ptr<SharedTicketCrypter> crypter = CreateCrypter();
+    ASSERT_TRUE(crypter != nullptr);
+    ciphertext = crypter->Encrypt(StringPiece(plaintext), {});
+  }
+  std::unique_ptr<SharedTicketCrypter> crypter = CreateCrypter();
+  ASSERT_TRUE(crypter != nullptr);
+  EXPECT_EQ(plaintext, Decrypt(crypter.get(), ciphertext));
+}
+
+TEST_F(SharedTicketCrypterTest, StrikeRegisterDisablesEarlyDataOnReplay) {
+  options_.strike_register_size = 1024;
+  std::unique_ptr<SharedTicketCrypter> crypter1 = CreateCrypter();
+  std::unique_ptr<SharedTicketCrypter> crypter2 = CreateCrypter();
+  ASSERT_TRUE(crypter1 != nullptr && crypter2 != nullptr);
+
+  std::vector<uint8_t> plaintext = {1, 2, 3};
+  std::vector<uint8_t> ciphertext =
+      crypter1->Encrypt(StringPiece(plaintext), {});
+  bool early_data_allowed = false;
+  EXPECT_EQ(plaintext,
+            Decrypt(crypter2.get(), ciphertext, &early_data_allowed));
+  EXPECT_TRUE(early_data_allowed);
+  // The same ticket still resumes in every process, but without early data.
+  EXPECT_EQ(plaintext,
+            Decrypt(crypter1.get(), ciphertext, &early_data_allowed));
+  EXPECT_FALSE(early_data_allowed);
+  early_data_allowed = true;
+  EXPECT_EQ(plaintext,
+            Decrypt(crypter2.get(), ciphertext, &early_data_allowed));
+  EXPECT_FALSE(early_data_allowed);
+  EXPECT_EQ(1u, crypter1->num_replays_detected());
+  EXPECT_EQ(1u, crypter2->num_replays_detected());
+
+  // Other tickets are not affected.
+  std::vector<uint8_t> ciphertext2 =
+      crypter1->Encrypt(StringPiece(plaintext), {});
+  EXPECT_EQ(plaintext,
+            Decrypt(crypter1.get(), ciphertext2, &early_data_allowed));
+  EXPECT_TRUE(early_data_allowed);
+}
+
+TEST_F(SharedTicketCrypterTest, StrikeRegisterEntriesExpireAfterReplayWindow) {
+  options_.strike_register_size = 1024;
+  std::unique_ptr<SharedTicketCrypter> crypter = CreateCrypter();
+  ASSERT_TRUE(crypter != nullptr);
+
+  std::vector<uint8_t> plaintext = {1, 2, 3};
+  std::vector<uint8_t> ciphertext =
+      crypter->Encrypt(StringPiece(plaintext), {});
+  bool early_data_allowed = false;
+  EXPECT_EQ(plaintext, Decrypt(crypter.get(), ciphertext, &early_data_allowed));
+  EXPECT_TRUE(early_data_allowed);
+
+  // Past the replay window, BoringSSL rejects the early data of a replayed
+  // ClientHello itself, so the entry is not kept.
+  mock_clock_.AdvanceTime(options_.replay_window +
+                          QuicTime::Delta::FromSeconds(1));
+  EXPECT_EQ(plaintext, Decrypt(crypter.get(), ciphertext, &early_data_allowed));
+  EXPECT_TRUE(early_data_allowed);
+  EXPECT_EQ(0u, crypter->num_replays_detected());
+}
+
+TEST_F(SharedTicketCrypterTest, FullStrikeRegisterKeepsResumption) {
+  options_.strike_register_size = 1;
+  std::unique_ptr<SharedTicketCrypter> crypter = CreateCrypter();
+  ASSERT_TRUE(crypter != nullptr);
+
+  std::vector<uint8_t> plaintext = {1, 2, 3};
+  std::vector<uint8_t> ciphertexts[2];
+  for (std::vector<uint8_t>& ciphertext : ciphertexts) {
+    do {
+      ciphertext = crypter->Encrypt(StringPiece(plaintext), {});
+      // Ticket nonces are random; make sure the two differ in the bits the
+      // strike register keeps.
+    } while (&ciphertext != &ciphertexts[0] &&
+             ciphertext[2] == ciphertexts[0][2]);
+  }
+  bool early_data_allowed = false;
+  EXPECT_EQ(plaintext,
+            Decrypt(crypter.get(), ciphertexts[0], &early_data_allowed));
+  EXPECT_TRUE(early_data_allowed);
+  // The only entry is taken, so the second ticket resumes without early data.
+  EXPECT_EQ(plaintext,
+            Decrypt(crypter.get(), ciphertexts[1], &early_data_allowed));
+  EXPECT_FALSE(early_data_allowed);
+  EXPECT_EQ(0u, crypter->num_replays_detected());
+  EXPECT_EQ(1u, crypter->num_early_data_disabled());
+}
+
+TEST_F(SharedTicketCrypterTest, StrikeRegisterSizeMismatch) {
+  options_.strike_register_size = 1024;
+  ASSERT_TRUE(CreateCrypter() != nullptr);
+  options_.strike_register_size = 2048;
+  EXPECT_TRUE(CreateCrypter() == nullptr);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,188 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/thread_pool_proof_source.h"
+
+#include <utility>
+
+#include "quic/platform/api/quic_logging.h"
+#include "quic/platform/api/quic_thread.h"
+
+namespace quic {
+
+class ThreadPoolProofSource::WorkerThread : public QuicThread {
+ public:
+  explicit WorkerThread(ThreadPoolProofSource* proof_source)
+      : QuicThread("ThreadPoolProofSource"), proof_source_(proof_source) {}
+
+  void Run() override { proof_source_->RunWorker(); }
+
+ private:
+  ThreadPoolProofSource* proof_source_;
+};
+
+// Stores the delegate's result in the task and hands it back to the proof
+// source.
+class ThreadPoolProofSource::TaskCallback : public SignatureCallback {
+ public:
+  TaskCallback(ThreadPoolProofSource* proof_source, std::unique_ptr<Task> task)
+      : proof_source_(proof_source), task_(std::move(task)) {}
+
+  ~TaskCallback() override {
+    if (task_ != nullptr) {
+      // The delegate dropped the request, report it as failed.
+      proof_source_->OnTaskDone(std::move(task_));
+    }
+  }
+
+  void Run(bool ok,
+           std::string signature,
+           std::unique_ptr<Details> details) override {
+    task_->ok = ok;
+    task_->signature = std::move(signature);
+    task_->details = std::move(details);
+    proof_source_->OnTaskDone(std::move(task_));
+  }
+
+ private:
+  ThreadPoolProofSource* proof_source_;
+  std::unique_ptr<Task> task_;
+};
+
+ThreadPoolProofSource::ThreadPoolProofSource(
+    std::unique_ptr<ProofSource> delegate,
+    size_t num_threads,
+    std::function<void()> notifier)
+    : delegate_(std::move(delegate)), notifier_(std::move(notifier)) {
+  QUICHE_DCHECK(delegate_ != nullptr);
+  QUICHE_DCHECK_GT(num_threads, 0u);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.push_back(std::make_unique<WorkerThread>(this));
+    threads_.back()->Start();
+  }
+}
+
+ThreadPoolProofSource::~ThreadPoolProofSource() {
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    stopping_ = true;
+  }
+  task_queued_.SignalAll();
+  for (const auto& thread : threads_) {
+    thread->Join();
+  }
+}
+
+void ThreadPoolProofSource::GetProof(const QuicSocketAddress& server_address,
+                                     const QuicSocketAddress& client_address,
+                                     const std::string& hostname,
+                                     const std::string& server_config,
+                                     QuicTransportVersion transport_version,
+                                     absl::string_view chlo_hash,
+                                     std::unique_ptr<Callback> callback) {
+  delegate_->GetProof(server_address, client_address, hostname, server_config,
+                      transport_version, chlo_hash, std::move(callback));
+}
+
+QuicReferenceCountedPointer<ProofSource::Chain>
+ThreadPoolProofSource::GetCertChain(const QuicSocketAddress& server_address,
+                                    const QuicSocketAddress& client_address,
+                                    const std::string& hostname,
+                                    bool* cert_matched_sni) {
+  return delegate_->GetCertChain(server_address, client_address, hostname,
+                                 cert_matched_sni);
+}
+
+void ThreadPoolProofSource::ComputeTlsSignature(
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address,
+    const std::string& hostname,
+    uint16_t signature_algorithm,
+    absl::string_view in,
+    std::unique_ptr<SignatureCallback> callback) {
+  auto task = std::make_unique<Task>();
+  task->server_address = server_address;
+  task->client_address = client_address;
+  task->hostname = hostname;
+  task->signature_algorithm = signature_algorithm;
+  task->in = std::string(in);
+  task->callback = std::move(callback);
+
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    queued_tasks_.push_back(std::move(task));
+    ++num_pending_tasks_;
+  }
+  task_queued_.Signal();
+}
+
+absl::InlinedVector<uint16_t, 8>
+ThreadPoolProofSource::SupportedTlsSignatureAlgorithms() const {
+  return delegate_->SupportedTlsSignatureAlgorithms();
+}
+
+ProofSource::TicketCrypter* ThreadPoolProofSource::GetTicketCrypter() {
+  return delegate_->GetTicketCrypter();
+}
+
+size_t ThreadPoolProofSource::RunCompletedCallbacks() {
+  std::vector<std::unique_ptr<Task>> completed_tasks;
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    completed_tasks.swap(completed_tasks_);
+    num_pending_tasks_ -= completed_tasks.size();
+  }
+  for (const auto& task : completed_tasks) {
+    // The callback may start another handshake step which calls
+    // ComputeTlsSignature() again; |mutex_| is not held here.
+    task->callback->Run(task->ok, std::move(task->signature),
+                        std::move(task->details));
+  }
+  return completed_tasks.size();
+}
+
+size_t ThreadPoolProofSource::NumPendingSignatures() const {
+  QuicReaderMutexLock lock(&mutex_);
+  return num_pending_tasks_;
+}
+
+void ThreadPoolProofSource::RunWorker() {
+  while (true) {
+    std::unique_ptr<Task> task;
+    {
+      QuicWriterMutexLock lock(&mutex_);
+      while (!stopping_ && queued_tasks_.empty()) {
+        task_queued_.Wait(&mutex_);
+      }
+      if (stopping_) {
+        return;
+      }
+      task = std::move(queued_tasks_.front());
+      queued_tasks_.pop_front();
+    }
+    // |task| is owned by the callback from here on, which may hand it back to
+    // the network thread before the delegate returns. Keep the inputs alive
+    // for the duration of the call.
+    const QuicSocketAddress server_address = task->server_address;
+    const QuicSocketAddress client_address = task->client_address;
+    const std::string hostname = std::move(task->hostname);
+    const uint16_t signature_algorithm = task->signature_algorithm;
+    const std::string in = std::move(task->in);
+    delegate_->ComputeTlsSignature(
+        server_address, client_address, hostname, signature_algorithm, in,
+        std::make_unique<TaskCallback>(this, std::move(task)));
+  }
+}
+
+void ThreadPoolProofSource::OnTaskDone(std::unique_ptr<Task> task) {
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    completed_tasks_.push_back(std::move(task));
+  }
+  if (notifier_) {
+    notifier_();
+  }
+}
+
+}  // namespace quic
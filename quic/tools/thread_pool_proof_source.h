@@ -0,0 +1,122 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_THREAD_POOL_PROOF_SOURCE_H_
+#define QUICHE_QUIC_TOOLS_THREAD_POOL_PROOF_SOURCE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "quic/core/crypto/proof_source.h"
+#include "quic/platform/api/quic_export.h"
+#include "quic/platform/api/quic_mutex.h"
+#include "quic/platform/api/quic_socket_address.h"
+#include "common/quiche_circular_deque.h"
+
+namespace quic {
+
+// ThreadPoolProofSource is a ProofSource decorator which computes TLS
+// signatures of its delegate on a pool of worker threads, so that expensive
+// private key operations do not block the thread processing packets.
+//
+// All other ProofSource methods are passed through to the delegate on the
+// calling thread.
+//
+// Signature callbacks are never run on a worker thread. Instead, completed
+// signatures are queued and |notifier| is called from the worker thread; the
+// owner of the connections must then call RunCompletedCallbacks() on its own
+// thread, e.g. via QuicDispatcher::ProcessCompletedSignatures() after passing
+// RunCompletedCallbacks() to QuicDispatcher::SetCompletedSignaturesRunner().
+class QUIC_EXPORT_PRIVATE ThreadPoolProofSource : public ProofSource {
+ public:
+  // |delegate| must support concurrent calls to ComputeTlsSignature() and
+  // must run their callbacks before this object is destroyed. |notifier| may
+  // be empty, in which case the owner has to poll RunCompletedCallbacks().
+  ThreadPoolProofSource(std::unique_ptr<ProofSource> delegate,
+                        size_t num_threads,
+                        std::function<void()> notifier);
+  ThreadPoolProofSource(const ThreadPoolProofSource&) = delete;
+  ThreadPoolProofSource& operator=(const ThreadPoolProofSource&) = delete;
+
+  // Stops the worker threads. Callbacks of signatures which have not been
+  // delivered yet are destroyed without being run.
+  ~ThreadPoolProofSource() override;
+
+  // ProofSource implementation.
+  void GetProof(const QuicSocketAddress& server_address,
+                const QuicSocketAddress& client_address,
+                const std::string& hostname,
+                const std::string& server_config,
+                QuicTransportVersion transport_version,
+                absl::string_view chlo_hash,
+                std::unique_ptr<Callback> callback) override;
+  QuicReferenceCountedPointer<Chain> GetCertChain(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address, const std::string& hostname,
+      bool* cert_matched_sni) override;
+  void ComputeTlsSignature(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address,
+      const std::string& hostname,
+      uint16_t signature_algorithm,
+      absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override;
+  absl::InlinedVector<uint16_t, 8> SupportedTlsSignatureAlgorithms()
+      const override;
+  TicketCrypter* GetTicketCrypter() override;
+
+  // Runs the callbacks of all signatures completed so far, in completion
+  // order. Must be called on the thread which calls ComputeTlsSignature().
+  // Returns the number of callbacks run.
+  size_t RunCompletedCallbacks();
+
+  // Returns the number of signatures whose callbacks have not been run yet.
+  size_t NumPendingSignatures() const;
+
+ private:
+  class WorkerThread;
+  class TaskCallback;
+
+  // A signature request, and its result once computed.
+  struct Task {
+    QuicSocketAddress server_address;
+    QuicSocketAddress client_address;
+    std::string hostname;
+    uint16_t signature_algorithm = 0;
+    std::string in;
+    std::unique_ptr<SignatureCallback> callback;
+
+    bool ok = false;
+    std::string signature;
+    std::unique_ptr<Details> details;
+  };
+
+  // Main loop of the worker threads.
+  void RunWorker();
+
+  // Called on a worker thread when |task| has been signed.
+  void OnTaskDone(std::unique_ptr<Task> task);
+
+  std::unique_ptr<ProofSource> delegate_;
+  std::function<void()> notifier_;
+  std::vector<std::unique_ptr<WorkerThread>> threads_;
+
+  mutable QuicMutex mutex_;
+  // Signaled when a task is queued or the workers have to stop.
+  QuicCondVar task_queued_;
+  quiche::QuicheCircularDeque<std::unique_ptr<Task>> queued_tasks_
+      QUIC_GUARDED_BY(mutex_);
+  std::vector<std::unique_ptr<Task>> completed_tasks_ QUIC_GUARDED_BY(mutex_);
+  // Number of tasks handed to ComputeTlsSignature() whose callbacks have not
+  // been run by RunCompletedCallbacks().
+  size_t num_pending_tasks_ QUIC_GUARDED_BY(mutex_) = 0;
+  bool stopping_ QUIC_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_THREAD_POOL_PROOF_SOURCE_H_
@@ -0,0 +1,127 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quic/tools/thread_pool_proof_source.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+#include "quic/core/crypto/certificate_view.h"
+#include "quic/core/crypto/proof_source_x509.h"
+#include "quic/platform/api/quic_mutex.h"
+#include "quic/platform/api/quic_test.h"
+#include "quic/test_tools/test_certificates.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const char kData[] = "Test data";
+
+class VerifyingCallback : public ProofSource::SignatureCallback {
+ public:
+  explicit VerifyingCallback(int* num_verified)
+      : num_verified_(num_verified) {}
+
+  void Run(bool ok,
+           std::string signature,
+           std::unique_ptr<ProofSource::Details> /*details*/) override {
+    ASSERT_TRUE(ok);
+    std::unique_ptr<CertificateView> view =
+        CertificateView::ParseSingleCertificate(kTestCertificate);
+    EXPECT_TRUE(view->VerifySignature(kData, signature,
+                                      SSL_SIGN_RSA_PSS_RSAE_SHA256));
+    ++*num_verified_;
+  }
+
+ private:
+  int* num_verified_;
+};
+
+std::unique_ptr<ProofSource> CreateDelegate() {
+  QuicReferenceCountedPointer<ProofSource::Chain> chain(new ProofSource::Chain(
+      std::vector<std::string>{std::string(kTestCertificate)}));
+  std::unique_ptr<CertificatePrivateKey> key =
+      CertificatePrivateKey::LoadFromDer(kTestCertificatePrivateKey);
+  QUICHE_CHECK(key != nullptr);
+  return ProofSourceX509::Create(chain, std::move(*key));
+}
+
+class ThreadPoolProofSourceTest : public QuicTest {};
+
+TEST_F(ThreadPoolProofSourceTest, CallbackRunOnOwnerThread) {
+  QuicNotification signed_notification;
+  ThreadPoolProofSource proof_source(CreateDelegate(), /*num_threads=*/1,
+                                     [&signed_notification] {
+                                       signed_notification.Notify();
+                                     });
+  int num_verified = 0;
+  proof_source.ComputeTlsSignature(
+      QuicSocketAddress(), QuicSocketAddress(), "example.com",
+      SSL_SIGN_RSA_PSS_RSAE_SHA256, kData,
+      std::make_unique<VerifyingCallback>(&num_verified));
+  signed_notification.WaitForNotification();
+
+  // The signature is ready but the callback only runs when asked to.
+  EXPECT_EQ(0, num_verified);
+  EXPECT_EQ(1u, proof_source.NumPendingSignatures());
+  EXPECT_EQ(1u, proof_source.RunCompletedCallbacks());
+  EXPECT_EQ(1, num_verified);
+  EXPECT_EQ(0u, proof_source.NumPendingSignatures());
+  EXPECT_EQ(0u, proof_source.RunCompletedCallbacks());
+}
+
+TEST_F(ThreadPoolProofSourceTest, ManySignaturesOnManyThreads) {
+  const int kNumSignatures = 64;
+  absl::BlockingCounter signed_counter(kNumSignatures);
+  ThreadPoolProofSource proof_source(
+      CreateDelegate(), /*num_threads=*/4,
+      [&signed_counter] { signed_counter.DecrementCount(); });
+  int num_verified = 0;
+  for (int i = 0; i < kNumSignatures; ++i) {
+    proof_source.ComputeTlsSignature(
+        QuicSocketAddress(), QuicSocketAddress(), "example.com",
+        SSL_SIGN_RSA_PSS_RSAE_SHA256, kData,
+        std::make_unique<VerifyingCallback>(&num_verified));
+  }
+  signed_counter.Wait();
+
+  EXPECT_EQ(static_cast<size_t>(kNumSignatures),
+            proof_source.RunCompletedCallbacks());
+  EXPECT_EQ(kNumSignatures, num_verified);
+  EXPECT_EQ(0u, proof_source.NumPendingSignatures());
+}
+
+TEST_F(ThreadPoolProofSourceTest, DestroyWithPendingSignatures) {
+  int num_verified = 0;
+  {
+    ThreadPoolProofSource proof_source(CreateDelegate(), /*num_threads=*/2,
+                                       /*notifier=*/nullptr);
+    for (int i = 0; i < 8; ++i) {
+      proof_source.ComputeTlsSignature(
+          QuicSocketAddress(), QuicSocketAddress(), "example.com",
+          SSL_SIGN_RSA_PSS_RSAE_SHA256, kData,
+          std::make_unique<VerifyingCallback>(&num_verified));
+    }
+  }
+  EXPECT_EQ(0, num_verified);
+}
+
+TEST_F(ThreadPoolProofSourceTest, PassesThroughCertChain) {
+  ThreadPoolProofSource proof_source(CreateDelegate(), /*num_threads=*/1,
+                                     /*notifier=*/nullptr);
+  bool cert_matched_sni = false;
+  QuicReferenceCountedPointer<ProofSource::Chain> chain =
+      proof_source.GetCertChain(QuicSocketAddress(), QuicSocketAddress(),
+                                "www.example.org", &cert_matched_sni);
+  ASSERT_TRUE(chain != nullptr);
+  ASSERT_EQ(1u, chain->certs.size());
+  EXPECT_EQ(kTestCertificate, chain->certs[0]);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -106,7 +106,7 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderAdapter {
 
     // Override the HpackDecoderListener methods:
     void OnHeaderListStart() override;
-    void OnHeader(const std::string& name, const std::string& value) override;
+    void OnHeader(absl::string_view name, absl::string_view value) override;
     void OnHeaderListEnd() override;
     void OnHeaderErrorDetected(absl::string_view error_message) override;
 
@@ -183,14 +183,14 @@ void HpackEncoder::EmitLiteral(const Representation& representation) {
 }
 
 void HpackEncoder::EmitString(absl::string_view str) {
-  size_t encoded_size =
-      enable_compression_ ? http2::HuffmanSize(str) : str.size();
-  if (encoded_size < str.size()) {
+  huffman_buffer_.clear();
+  if (enable_compression_ &&
+      http2::HuffmanEncodeIfShorter(str, &huffman_buffer_)) {
     QUICHE_DVLOG(2) << "Emitted Huffman-encoded string of length "
-                    << encoded_size;
+                    << huffman_buffer_.size();
     output_stream_.AppendPrefix(kStringLiteralHuffmanEncoded);
-    output_stream_.AppendUint32(encoded_size);
-    http2::HuffmanEncodeFast(str, encoded_size, output_stream_.MutableString());
+    output_stream_.AppendUint32(huffman_buffer_.size());
+    output_stream_.AppendBytes(huffman_buffer_);
   } else {
     QUICHE_DVLOG(2) << "Emitted literal string of length " << str.size();
     output_stream_.AppendPrefix(kStringLiteralIdentityEncoded);
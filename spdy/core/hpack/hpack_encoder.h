@@ -133,6 +133,8 @@ class QUICHE_EXPORT_PRIVATE HpackEncoder {
 
   HpackHeaderTable header_table_;
   HpackOutputStream output_stream_;
+  // Scratch space for Huffman encoding a string before its length is emitted.
+  std::string huffman_buffer_;
 
   size_t min_table_size_setting_received_;
   HeaderListener listener_;
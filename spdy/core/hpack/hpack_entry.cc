@@ -8,8 +8,8 @@
 
 namespace spdy {
 
-HpackEntry::HpackEntry(std::string name, std::string value)
-    : name_(std::move(name)), value_(std::move(value)) {}
+HpackEntry::HpackEntry(absl::string_view name, absl::string_view value)
+    : name_(name), value_(value) {}
 
 // static
 size_t HpackEntry::Size(absl::string_view name, absl::string_view value) {
@@ -0,0 +1,104 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "spdy/core/hpack/hpack_entry_ring_buffer.h"
+
+#include "common/platform/api/quiche_logging.h"
+
+namespace spdy {
+
+HpackEntryRingBuffer::HpackEntryRingBuffer()
+    : buffer_size_(0),
+      max_table_size_(0),
+      data_size_(0),
+      begin_(0),
+      end_(0),
+      wrapped_(false),
+      wrap_(0) {}
+
+HpackEntryRingBuffer::HpackEntryRingBuffer(HpackEntryRingBuffer&&) = default;
+
+HpackEntryRingBuffer& HpackEntryRingBuffer::operator=(HpackEntryRingBuffer&&) =
+    default;
+
+HpackEntryRingBuffer::~HpackEntryRingBuffer() = default;
+
+void HpackEntryRingBuffer::SetMaxTableSize(size_t max_table_size) {
+  // Growing the buffer would move the entries.
+  QUICHE_DCHECK(data_size_ == 0 || 2 * max_table_size <= buffer_size_);
+  max_table_size_ = max_table_size;
+}
+
+HpackEntry HpackEntryRingBuffer::Add(absl::string_view name,
+                                     absl::string_view value) {
+  const size_t data_size = name.size() + value.size();
+  QUICHE_DCHECK_LE(data_size_ + data_size, max_table_size_);
+
+  // |name| and |value| may be overwritten by the new entry if they belong to an
+  // evicted one.
+  if (IsInBuffer(name) || IsInBuffer(value)) {
+    scratch_.assign(name.data(), name.size());
+    scratch_.append(value.data(), value.size());
+    name = absl::string_view(scratch_.data(), name.size());
+    value = absl::string_view(scratch_.data() + name.size(), value.size());
+  }
+
+  if (buffer_size_ < 2 * max_table_size_) {
+    QUICHE_DCHECK_EQ(0u, data_size_);
+    QUICHE_DVLOG(2) << "Allocating " << 2 * max_table_size_
+                    << " bytes for dynamic table entries.";
+    buffer_size_ = 2 * max_table_size_;
+    buffer_.reset(new char[buffer_size_]);
+    begin_ = 0;
+    end_ = 0;
+    wrapped_ = false;
+  }
+
+  size_t offset = end_;
+  if (!wrapped_ && buffer_size_ - end_ < data_size) {
+    wrapped_ = true;
+    wrap_ = end_;
+    offset = 0;
+  }
+  // The free space is twice the maximum table size, minus the live entries,
+  // which take up at most the maximum table size minus |data_size|, and minus
+  // the bytes skipped at the end of the buffer when wrapping, which are fewer
+  // than the maximum table size.
+  QUICHE_DCHECK_LE(offset + data_size, wrapped_ ? begin_ : buffer_size_);
+
+  char* const data = buffer_.get() + offset;
+  name.copy(data, name.size());
+  value.copy(data + name.size(), value.size());
+  end_ = offset + data_size;
+  data_size_ += data_size;
+  return HpackEntry(absl::string_view(data, name.size()),
+                    absl::string_view(data + name.size(), value.size()));
+}
+
+void HpackEntryRingBuffer::RemoveOldest(const HpackEntry& entry) {
+  const size_t data_size = entry.name().size() + entry.value().size();
+  if (data_size == 0) {
+    return;
+  }
+  QUICHE_DCHECK_EQ(buffer_.get() + begin_, entry.name().data());
+  QUICHE_DCHECK_LE(data_size, data_size_);
+
+  data_size_ -= data_size;
+  begin_ += data_size;
+  if (data_size_ == 0) {
+    begin_ = 0;
+    end_ = 0;
+    wrapped_ = false;
+  } else if (wrapped_ && begin_ == wrap_) {
+    begin_ = 0;
+    wrapped_ = false;
+  }
+}
+
+bool HpackEntryRingBuffer::IsInBuffer(absl::string_view s) const {
+  return !s.empty() && s.data() >= buffer_.get() &&
+         s.data() < buffer_.get() + buffer_size_;
+}
+
+}  // namespace spdy
@@ -0,0 +1,85 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_SPDY_CORE_HPACK_HPACK_ENTRY_RING_BUFFER_H_
+#define QUICHE_SPDY_CORE_HPACK_HPACK_ENTRY_RING_BUFFER_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "common/platform/api/quiche_export.h"
+#include "spdy/core/hpack/hpack_entry.h"
+
+namespace spdy {
+
+// Storage for the names and values of the entries of a dynamic table, shared by
+// the HPACK encoder and the QPACK header tables.
+//
+// The names and values are copied into a single buffer of twice the maximum
+// table size, each name followed by its value, which is used as a ring: an
+// entry is written right after the newest one, or at the start of the buffer
+// if it does not fit before the end, and its bytes are released when it is
+// evicted.  Since the size of an entry (5.1) is larger than its name and value,
+// the free space left once the table evicted enough entries to make room for a
+// new one always holds its name and value.  Therefore inserting and evicting
+// entries does not allocate memory, and the name and value of an entry stay at
+// the same address until the entry is evicted.
+class QUICHE_EXPORT_PRIVATE HpackEntryRingBuffer {
+ public:
+  HpackEntryRingBuffer();
+  HpackEntryRingBuffer(const HpackEntryRingBuffer&) = delete;
+  HpackEntryRingBuffer& operator=(const HpackEntryRingBuffer&) = delete;
+  // Moving keeps the entries at the same address.
+  HpackEntryRingBuffer(HpackEntryRingBuffer&&);
+  HpackEntryRingBuffer& operator=(HpackEntryRingBuffer&&);
+  ~HpackEntryRingBuffer();
+
+  size_t max_table_size() const { return max_table_size_; }
+
+  // Sets the largest table size, as defined in 5.1, the buffer must hold.  The
+  // buffer is allocated by the next Add() if it is too small.  Must not be
+  // called with a larger size than before while the buffer holds entries.
+  void SetMaxTableSize(size_t max_table_size);
+
+  // Copies |name| and |value| into the buffer and returns an entry pointing at
+  // the copies.  The sizes of the entries in the buffer, including the new one,
+  // must add up to no more than max_table_size().  |name| and |value| may point
+  // into the buffer, even to an entry that has just been removed.
+  HpackEntry Add(absl::string_view name, absl::string_view value);
+
+  // Releases the name and value of |entry|, which must be the oldest entry in
+  // the buffer.
+  void RemoveOldest(const HpackEntry& entry);
+
+ private:
+  // Returns true if |s| points into |buffer_|.
+  bool IsInBuffer(absl::string_view s) const;
+
+  std::unique_ptr<char[]> buffer_;
+  size_t buffer_size_;
+  size_t max_table_size_;
+
+  // Number of bytes taken up by the names and values of the entries.
+  size_t data_size_;
+
+  // Offset of the name of the oldest entry.
+  size_t begin_;
+
+  // Offset right after the value of the newest entry.
+  size_t end_;
+
+  // True if newer entries were written at the start of the buffer after older
+  // entries that end at |wrap_|.
+  bool wrapped_;
+  size_t wrap_;
+
+  // Holds a name and value from |buffer_| while they are copied.
+  std::string scratch_;
+};
+
+}  // namespace spdy
+
+#endif  // QUICHE_SPDY_CORE_HPACK_HPACK_ENTRY_RING_BUFFER_H_
@@ -0,0 +1,96 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "spdy/core/hpack/hpack_entry_ring_buffer.h"
+
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "common/platform/api/quiche_test.h"
+
+namespace spdy {
+
+namespace test {
+
+namespace {
+
+constexpr size_t kMaxTableSize = 200;
+
+class HpackEntryRingBufferTest : public QuicheTest {
+ protected:
+  HpackEntryRingBufferTest() { buffer_.SetMaxTableSize(kMaxTableSize); }
+
+  // Evicts entries like a table would, then adds |name| and |value|.
+  void Add(absl::string_view name, absl::string_view value) {
+    // |name| and |value| may point to an entry that is about to be evicted.
+    expected_.emplace_back(std::string(name), std::string(value));
+    while (table_size_ + HpackEntry::Size(name, value) > kMaxTableSize) {
+      RemoveOldest();
+    }
+    entries_.push_back(buffer_.Add(name, value));
+    table_size_ += entries_.back().Size();
+    VerifyEntries();
+  }
+
+  void RemoveOldest() {
+    ASSERT_FALSE(entries_.empty());
+    table_size_ -= entries_.front().Size();
+    buffer_.RemoveOldest(entries_.front());
+    entries_.pop_front();
+    expected_.pop_front();
+  }
+
+  // Entries are never rewritten, so this also checks that they do not move.
+  void VerifyEntries() {
+    ASSERT_EQ(expected_.size(), entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      EXPECT_EQ(expected_[i].first, entries_[i].name());
+      EXPECT_EQ(expected_[i].second, entries_[i].value());
+    }
+  }
+
+  HpackEntryRingBuffer buffer_;
+  std::deque<HpackEntry> entries_;
+  std::deque<std::pair<std::string, std::string>> expected_;
+  size_t table_size_ = 0;
+};
+
+TEST_F(HpackEntryRingBufferTest, AddAndRemove) {
+  Add("foo", "bar");
+  Add("", "");
+  Add("baz", "");
+  RemoveOldest();
+  RemoveOldest();
+  RemoveOldest();
+  Add("name", "value");
+}
+
+// Adds entries of many different sizes, including ones as large as the table,
+// so that entries wrap around the end of the buffer at various offsets.
+TEST_F(HpackEntryRingBufferTest, ManySizes) {
+  const size_t max_data_size = kMaxTableSize - kHpackEntrySizeOverhead;
+  for (size_t i = 0; i < 1000; ++i) {
+    const size_t data_size = (i * 37) % (max_data_size + 1);
+    const size_t name_size = data_size / 3;
+    Add(std::string(name_size, 'a' + i % 26),
+        std::string(data_size - name_size, 'A' + i % 26));
+  }
+}
+
+// The name and value of a new entry may point to evicted entries, or to
+// entries that are still in the table.
+TEST_F(HpackEntryRingBufferTest, AddFromBuffer) {
+  for (size_t i = 0; i < 100; ++i) {
+    Add(std::string(i % 50, 'n'), std::to_string(i));
+    const HpackEntry oldest = entries_.front();
+    Add(oldest.name(), oldest.value());
+  }
+}
+
+}  // namespace
+
+}  // namespace test
+
+}  // namespace spdy
@@ -5,6 +5,7 @@
 #include "spdy/core/hpack/hpack_header_table.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "common/platform/api/quiche_logging.h"
 #include "spdy/core/hpack/hpack_constants.h"
@@ -126,15 +127,16 @@ void HpackHeaderTable::Evict(size_t count) {
     if (name_it->second == index) {
       dynamic_name_index_.erase(name_it);
     }
+    entry_buffer_.RemoveOldest(*entry);
     dynamic_entries_.pop_back();
   }
 }
 
 const HpackEntry* HpackHeaderTable::TryAddEntry(absl::string_view name,
                                                 absl::string_view value) {
-  // Since |dynamic_entries_| has iterator stability, |name| and |value| are
-  // valid even after evicting other entries and push_front() making room for
-  // the new one.
+  // Since |entry_buffer_| does not reuse the bytes of evicted entries until the
+  // new one is added, and copies |name| and |value| out of the way if needed,
+  // |name| and |value| are valid even after evicting other entries.
   Evict(EvictionCountForEntry(name, value));
 
   size_t entry_size = HpackEntry::Size(name, value);
@@ -145,44 +147,83 @@ const HpackEntry* HpackHeaderTable::TryAddEntry(absl::string_view name,
     return nullptr;
   }
 
+  // Holds the previous buffer, which |name| and |value| may point into, until
+  // the new entry is added.
+  HpackEntryRingBuffer previous_entry_buffer;
+  if (size_ + entry_size > entry_buffer_.max_table_size()) {
+    previous_entry_buffer = GrowEntryBuffer(size_ + entry_size);
+  }
+
   const size_t index = dynamic_table_insertions_;
-  dynamic_entries_.push_front(
-      HpackEntry(std::string(name), std::string(value)));
-  HpackEntry* new_entry = &dynamic_entries_.front();
-  auto index_result = dynamic_index_.insert(std::make_pair(
-      HpackLookupEntry{new_entry->name(), new_entry->value()}, index));
+  dynamic_entries_.push_front(entry_buffer_.Add(name, value));
+  AddToIndices(dynamic_entries_.front(), index);
+
+  size_ += entry_size;
+  ++dynamic_table_insertions_;
+
+  return &dynamic_entries_.front();
+}
+
+void HpackHeaderTable::AddToIndices(const HpackEntry& entry, size_t index) {
+  auto index_result = dynamic_index_.insert(
+      std::make_pair(HpackLookupEntry{entry.name(), entry.value()}, index));
   if (!index_result.second) {
     // An entry with the same name and value already exists in the dynamic
     // index. We should replace it with the newly added entry.
     QUICHE_DVLOG(1) << "Found existing entry at: " << index_result.first->second
-                    << " replacing with: " << new_entry->GetDebugString()
+                    << " replacing with: " << entry.GetDebugString()
                     << " at: " << index;
     QUICHE_DCHECK_GT(index, index_result.first->second);
     dynamic_index_.erase(index_result.first);
-    auto insert_result = dynamic_index_.insert(std::make_pair(
-        HpackLookupEntry{new_entry->name(), new_entry->value()}, index));
+    auto insert_result = dynamic_index_.insert(
+        std::make_pair(HpackLookupEntry{entry.name(), entry.value()}, index));
     QUICHE_CHECK(insert_result.second);
   }
 
   auto name_result =
-      dynamic_name_index_.insert(std::make_pair(new_entry->name(), index));
+      dynamic_name_index_.insert(std::make_pair(entry.name(), index));
   if (!name_result.second) {
     // An entry with the same name already exists in the dynamic index. We
     // should replace it with the newly added entry.
     QUICHE_DVLOG(1) << "Found existing entry at: " << name_result.first->second
-                    << " replacing with: " << new_entry->GetDebugString()
+                    << " replacing with: " << entry.GetDebugString()
                     << " at: " << index;
     QUICHE_DCHECK_GT(index, name_result.first->second);
     dynamic_name_index_.erase(name_result.first);
     auto insert_result =
-        dynamic_name_index_.insert(std::make_pair(new_entry->name(), index));
+        dynamic_name_index_.insert(std::make_pair(entry.name(), index));
     QUICHE_CHECK(insert_result.second);
   }
+}
 
-  size_ += entry_size;
-  ++dynamic_table_insertions_;
-
-  return &dynamic_entries_.front();
+HpackEntryRingBuffer HpackHeaderTable::GrowEntryBuffer(size_t table_size) {
+  QUICHE_DCHECK_LE(table_size, max_size_);
+  // Grow geometrically, so that entries are moved a constant number of times
+  // on average, but never beyond what the current table size limit requires.
+  table_size = std::min(
+      max_size_, std::max({table_size, 2 * entry_buffer_.max_table_size(),
+                           size_t{kDefaultHeaderTableSizeSetting}}));
+  QUICHE_DVLOG(1) << "Moving " << dynamic_entries_.size()
+                  << " entries to a buffer for a table of " << table_size
+                  << " bytes.";
+
+  // Every entry is at least kHpackEntrySizeOverhead bytes large, so until the
+  // buffer grows again, adding entries does not allocate memory.
+  dynamic_entries_.reserve(table_size / kHpackEntrySizeOverhead);
+
+  HpackEntryRingBuffer entry_buffer;
+  entry_buffer.SetMaxTableSize(table_size);
+  dynamic_index_.clear();
+  dynamic_name_index_.clear();
+  size_t index = dynamic_table_insertions_ - dynamic_entries_.size();
+  for (auto it = dynamic_entries_.rbegin(); it != dynamic_entries_.rend();
+       ++it) {
+    *it = entry_buffer.Add(it->name(), it->value());
+    AddToIndices(*it, index);
+    ++index;
+  }
+  std::swap(entry_buffer_, entry_buffer);
+  return entry_buffer;
 }
 
 }  // namespace spdy
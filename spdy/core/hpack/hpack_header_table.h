@@ -7,7 +7,6 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <memory>
 
 #include "absl/base/attributes.h"
@@ -16,7 +15,9 @@
 #include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
 #include "common/platform/api/quiche_export.h"
+#include "common/quiche_circular_deque.h"
 #include "spdy/core/hpack/hpack_entry.h"
+#include "spdy/core/hpack/hpack_entry_ring_buffer.h"
 
 // All section references below are to http://tools.ietf.org/html/rfc7541.
 
@@ -40,11 +41,10 @@ class QUICHE_EXPORT_PRIVATE HpackHeaderTable {
   // is initialized once and never changed after.
   using StaticEntryTable = std::vector<HpackEntry>;
 
-  // HpackHeaderTable takes advantage of the deque property that references
-  // remain valid, so long as insertions & deletions are at the head & tail.
-  // This precludes the use of base::circular_deque.
-  // TODO(b/182349990): Change to a more memory efficient container.
-  using DynamicEntryTable = std::deque<HpackEntry>;
+  // Entries point to names and values stored in |entry_buffer_|.  Capacity for
+  // as many entries as |entry_buffer_| can hold is reserved, so that entries
+  // only move when |entry_buffer_| grows.
+  using DynamicEntryTable = quiche::QuicheCircularDeque<HpackEntry>;
 
   using NameValueToEntryMap = absl::flat_hash_map<HpackLookupEntry, size_t>;
   using NameToEntryMap = absl::flat_hash_map<absl::string_view, size_t>;
@@ -91,8 +91,8 @@ class QUICHE_EXPORT_PRIVATE HpackHeaderTable {
                    DynamicEntryTable::iterator* end_out);
 
   // Adds an entry for the representation, evicting entries as needed. |name|
-  // and |value| must not point to an entry in |dynamic_entries_| which is about
-  // to be evicted, but they may point to an entry which is not.
+  // and |value| may point to an entry in |dynamic_entries_|, even one which is
+  // about to be evicted.
   // The added HpackEntry is returned, or NULL is returned if all entries were
   // evicted and the empty table is of insufficent size for the representation.
   const HpackEntry* TryAddEntry(absl::string_view name,
@@ -109,6 +109,15 @@ class QUICHE_EXPORT_PRIVATE HpackHeaderTable {
   // Evicts |count| oldest entries from the table.
   void Evict(size_t count);
 
+  // Adds |entry|, the newest entry, to |dynamic_index_| and
+  // |dynamic_name_index_| under insertion index |index|.
+  void AddToIndices(const HpackEntry& entry, size_t index);
+
+  // Moves the entries to a new |entry_buffer_| that can hold a table of at
+  // least |table_size|, which must not exceed |max_size_|, and rebuilds the
+  // indices that point to them.  Returns the previous buffer.
+  HpackEntryRingBuffer GrowEntryBuffer(size_t table_size);
+
   // |static_entries_|, |static_index_|, and |static_name_index_| are owned by
   // HpackStaticTable singleton.
 
@@ -116,6 +125,10 @@ class QUICHE_EXPORT_PRIVATE HpackHeaderTable {
   const StaticEntryTable& static_entries_;
   DynamicEntryTable dynamic_entries_;
 
+  // Stores the names and values of |dynamic_entries_|.  Grows as entries are
+  // added, up to what a table of |max_size_| requires.
+  HpackEntryRingBuffer entry_buffer_;
+
   // Tracks the index of the unique HpackEntry for a given header name and
   // value.  Keys consist of string_views that point to strings stored in
   // |static_entries_|.
@@ -128,12 +141,12 @@ class QUICHE_EXPORT_PRIVATE HpackHeaderTable {
 
   // Tracks the index of the most recently inserted HpackEntry for a given
   // header name and value.  Keys consist of string_views that point to strings
-  // stored in |dynamic_entries_|.
+  // stored in |entry_buffer_|.
   NameValueToEntryMap dynamic_index_;
 
   // Tracks the index of the most recently inserted HpackEntry for a given
   // header name.  Each key is a string_view that points to a name string stored
-  // in |dynamic_entries_|.
+  // in |entry_buffer_|.
   NameToEntryMap dynamic_name_index_;
 
   // Last acknowledged value for SETTINGS_HEADER_TABLE_SIZE.
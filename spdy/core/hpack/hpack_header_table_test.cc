@@ -6,10 +6,13 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "common/platform/api/quiche_test.h"
 #include "spdy/core/hpack/hpack_constants.h"
 #include "spdy/core/hpack/hpack_entry.h"
@@ -58,6 +61,9 @@ class HpackHeaderTablePeer {
     return table_->EvictionCountToReclaim(reclaim_size);
   }
   void Evict(size_t count) { return table_->Evict(count); }
+  size_t entry_buffer_max_table_size() {
+    return table_->entry_buffer_.max_table_size();
+  }
 
  private:
   HpackHeaderTable* table_;
@@ -69,27 +75,42 @@ namespace {
 
 class HpackHeaderTableTest : public QuicheTest {
  protected:
-  typedef std::vector<HpackEntry> HpackEntryVector;
+  // Unlike HpackEntry, owns its name and value.
+  class TestEntry {
+   public:
+    TestEntry(std::string name, std::string value)
+        : name_(std::move(name)), value_(std::move(value)) {}
+
+    absl::string_view name() const { return name_; }
+    absl::string_view value() const { return value_; }
+    size_t Size() const { return HpackEntry::Size(name_, value_); }
+
+   private:
+    std::string name_;
+    std::string value_;
+  };
+
+  typedef std::vector<TestEntry> TestEntryVector;
 
   HpackHeaderTableTest() : table_(), peer_(&table_) {}
 
   // Returns an entry whose Size() is equal to the given one.
-  static HpackEntry MakeEntryOfSize(uint32_t size) {
+  static TestEntry MakeEntryOfSize(uint32_t size) {
     EXPECT_GE(size, kHpackEntrySizeOverhead);
     std::string name((size - kHpackEntrySizeOverhead) / 2, 'n');
     std::string value(size - kHpackEntrySizeOverhead - name.size(), 'v');
-    HpackEntry entry(name, value);
+    TestEntry entry(std::move(name), std::move(value));
     EXPECT_EQ(size, entry.Size());
     return entry;
   }
 
   // Returns a vector of entries whose total size is equal to the given
   // one.
-  static HpackEntryVector MakeEntriesOfTotalSize(uint32_t total_size) {
+  static TestEntryVector MakeEntriesOfTotalSize(uint32_t total_size) {
     EXPECT_GE(total_size, kHpackEntrySizeOverhead);
     uint32_t entry_size = kHpackEntrySizeOverhead;
     uint32_t remaining_size = total_size;
-    HpackEntryVector entries;
+    TestEntryVector entries;
     while (remaining_size > 0) {
       EXPECT_LE(entry_size, remaining_size);
       entries.push_back(MakeEntryOfSize(entry_size));
@@ -101,7 +122,7 @@ class HpackHeaderTableTest : public QuicheTest {
 
   // Adds the given vector of entries to the given header table,
   // expecting no eviction to happen.
-  void AddEntriesExpectNoEviction(const HpackEntryVector& entries) {
+  void AddEntriesExpectNoEviction(const TestEntryVector& entries) {
     for (auto it = entries.begin(); it != entries.end(); ++it) {
       HpackHeaderTable::DynamicEntryTable::iterator begin, end;
 
@@ -310,7 +331,7 @@ TEST_F(HpackHeaderTableTest, TryAddEntryBasic) {
   EXPECT_EQ(0u, table_.size());
   EXPECT_EQ(table_.settings_size_bound(), table_.max_size());
 
-  HpackEntryVector entries = MakeEntriesOfTotalSize(table_.max_size());
+  TestEntryVector entries = MakeEntriesOfTotalSize(table_.max_size());
 
   // Most of the checks are in AddEntriesExpectNoEviction().
   AddEntriesExpectNoEviction(entries);
@@ -322,7 +343,7 @@ TEST_F(HpackHeaderTableTest, TryAddEntryBasic) {
 // size down to evict an entry one at a time. Make sure the eviction
 // happens as expected.
 TEST_F(HpackHeaderTableTest, SetMaxSize) {
-  HpackEntryVector entries =
+  TestEntryVector entries =
       MakeEntriesOfTotalSize(kDefaultHeaderTableSizeSetting / 2);
   AddEntriesExpectNoEviction(entries);
 
@@ -348,13 +369,13 @@ TEST_F(HpackHeaderTableTest, SetMaxSize) {
 // eviction happens as expected and the long entry is inserted into
 // the table.
 TEST_F(HpackHeaderTableTest, TryAddEntryEviction) {
-  HpackEntryVector entries = MakeEntriesOfTotalSize(table_.max_size());
+  TestEntryVector entries = MakeEntriesOfTotalSize(table_.max_size());
   AddEntriesExpectNoEviction(entries);
 
   // The first entry in the dynamic table.
   const HpackEntry* survivor_entry = &peer_.dynamic_entries().front();
 
-  HpackEntry long_entry =
+  TestEntry long_entry =
       MakeEntryOfSize(table_.max_size() - survivor_entry->Size());
 
   // All dynamic entries but the first are to be evicted.
@@ -372,10 +393,10 @@ TEST_F(HpackHeaderTableTest, TryAddEntryEviction) {
 // Fill a header table with entries, and then add an entry bigger than
 // the entire table. Make sure no entry remains in the table.
 TEST_F(HpackHeaderTableTest, TryAddTooLargeEntry) {
-  HpackEntryVector entries = MakeEntriesOfTotalSize(table_.max_size());
+  TestEntryVector entries = MakeEntriesOfTotalSize(table_.max_size());
   AddEntriesExpectNoEviction(entries);
 
-  const HpackEntry long_entry = MakeEntryOfSize(table_.max_size() + 1);
+  const TestEntry long_entry = MakeEntryOfSize(table_.max_size() + 1);
 
   // All entries are to be evicted.
   EXPECT_EQ(peer_.dynamic_entries().size(),
@@ -387,6 +408,73 @@ TEST_F(HpackHeaderTableTest, TryAddTooLargeEntry) {
   EXPECT_EQ(0u, peer_.dynamic_entries().size());
 }
 
+// Add many entries, each evicting older ones, so that the storage of the
+// entries is reused many times.  Entries named after the oldest entry, which the
+// insertion evicts, and ones with the name and value of the newest entry are
+// added as well.
+TEST_F(HpackHeaderTableTest, TryAddEntryManyTimes) {
+  for (size_t i = 0; i < 1000; ++i) {
+    const std::string name = absl::StrCat("name-", i % 7);
+    const std::string value(i % 300, 'a' + i % 26);
+    ASSERT_NE(nullptr, table_.TryAddEntry(name, value));
+    EXPECT_EQ(62u, table_.GetByNameAndValue(name, value));
+
+    const HpackEntry& oldest = peer_.dynamic_entries().back();
+    ASSERT_NE(nullptr, table_.TryAddEntry(oldest.name(), "oldest"));
+    const HpackEntry& newest = peer_.dynamic_entries().front();
+    ASSERT_NE(nullptr, table_.TryAddEntry(newest.name(), newest.value()));
+    EXPECT_EQ(62u, table_.GetByNameAndValue(peer_.dynamic_entries()[1].name(),
+                                            "oldest"));
+  }
+  EXPECT_LE(table_.size(), table_.max_size());
+}
+
+// Entries stay in the table, and can be looked up, when
+// SETTINGS_HEADER_TABLE_SIZE grows.
+TEST_F(HpackHeaderTableTest, SettingsHeaderTableSizeGrows) {
+  table_.TryAddEntry("key-1", "value-1");
+  table_.TryAddEntry("key-2", "value-2");
+  table_.TryAddEntry("key-1", "value-1");
+
+  table_.SetSettingsHeaderTableSize(2 * kDefaultHeaderTableSizeSetting);
+  EXPECT_EQ(3u, peer_.dynamic_entries().size());
+  EXPECT_EQ(62u, table_.GetByNameAndValue("key-1", "value-1"));
+  EXPECT_EQ(63u, table_.GetByNameAndValue("key-2", "value-2"));
+  EXPECT_EQ(62u, table_.GetByName("key-1"));
+
+  // Evicting the oldest entry leaves the index of its newer duplicate intact.
+  peer_.Evict(1);
+  EXPECT_EQ(62u, table_.GetByNameAndValue("key-1", "value-1"));
+
+  // The table can use the larger size.
+  AddEntriesExpectNoEviction(
+      {MakeEntryOfSize(table_.max_size() - table_.size())});
+  EXPECT_EQ(3u, peer_.dynamic_entries().size());
+  EXPECT_EQ(table_.max_size(), table_.size());
+}
+
+// Storage for entries is allocated as they are added, not for the largest
+// table SETTINGS_HEADER_TABLE_SIZE allows.
+TEST_F(HpackHeaderTableTest, LargeSettingsHeaderTableSize) {
+  table_.SetSettingsHeaderTableSize(std::numeric_limits<uint32_t>::max());
+  ASSERT_NE(nullptr, table_.TryAddEntry("key", "value"));
+  EXPECT_EQ(kDefaultHeaderTableSizeSetting,
+            peer_.entry_buffer_max_table_size());
+
+  // Entries named after the newest entry keep being added while the storage
+  // grows.
+  for (size_t i = 0; i < 100; ++i) {
+    const std::string value(1000, 'a' + i % 26);
+    const HpackEntry& newest = peer_.dynamic_entries().front();
+    ASSERT_NE(nullptr, table_.TryAddEntry(newest.name(), value));
+    EXPECT_EQ(62u, table_.GetByNameAndValue("key", value));
+  }
+  EXPECT_EQ(101u, peer_.dynamic_entries().size());
+  EXPECT_EQ(162u, table_.GetByNameAndValue("key", "value"));
+  EXPECT_LE(table_.size(), peer_.entry_buffer_max_table_size());
+  EXPECT_GT(4 * table_.size(), peer_.entry_buffer_max_table_size());
+}
+
 }  // namespace
 
 }  // namespace spdy
@@ -26,6 +26,7 @@ class QUICHE_EXPORT_PRIVATE HpackStaticTable {
 
   // Prepares HpackStaticTable by filling up static_entries_ and static_index_
   // from an array of struct HpackStaticEntry.  Must be called exactly once.
+  // The names and values in |static_entry_table| must outlive this object.
   void Initialize(const HpackStaticEntry* static_entry_table,
                   size_t static_entry_count);
 
@@ -45,8 +46,8 @@ class QUICHE_EXPORT_PRIVATE HpackStaticTable {
 
  private:
   HpackHeaderTable::StaticEntryTable static_entries_;
-  // The following two members have string_views that point to strings stored in
-  // |static_entries_|.
+  // The following two members have string_views that point to the same strings
+  // as |static_entries_|.
   HpackHeaderTable::NameValueToEntryMap static_index_;
   HpackHeaderTable::NameToEntryMap static_name_index_;
 };
@@ -201,9 +201,16 @@ Http2HeaderBlock& Http2HeaderBlock::operator=(Http2HeaderBlock&& other) {
 
 Http2HeaderBlock Http2HeaderBlock::Clone() const {
   Http2HeaderBlock copy;
+  // Avoid rehashing, and write all keys and consolidated values into a single
+  // block of storage.
+  copy.map_.reserve(size());
+  if (!empty()) {
+    copy.storage_.Reserve(TotalBytesUsed());
+  }
   for (const auto& p : *this) {
     copy.AppendHeader(p.first, p.second);
   }
+  copy.value_size_ = value_size_;
   return copy;
 }
 
@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "absl/base/attributes.h"
+#include "absl/container/inlined_vector.h"
 #include "common/platform/api/quiche_export.h"
 #include "common/platform/api/quiche_logging.h"
 #include "common/quiche_linked_hash_map.h"
@@ -84,7 +85,8 @@ class QUICHE_EXPORT_PRIVATE Http2HeaderBlock {
     absl::string_view ConsolidatedValue() const;
 
     mutable SpdyHeaderStorage* storage_;
-    mutable std::vector<absl::string_view> fragments_;
+    // Most values consist of a single fragment, which is stored inline.
+    mutable absl::InlinedVector<absl::string_view, 1> fragments_;
     // The first element is the key; the second is the consolidated value.
     mutable std::pair<absl::string_view, absl::string_view> pair_;
     size_t size_ = 0;
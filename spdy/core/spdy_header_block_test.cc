@@ -22,6 +22,13 @@ class ValueProxyPeer {
   }
 };
 
+class Http2HeaderBlockPeer {
+ public:
+  static size_t bytes_allocated(const Http2HeaderBlock& block) {
+    return block.bytes_allocated();
+  }
+};
+
 std::pair<absl::string_view, absl::string_view> Pair(absl::string_view k,
                                                      absl::string_view v) {
   return std::make_pair(k, v);
@@ -105,6 +112,23 @@ TEST(Http2HeaderBlockTest, CopyBlocks) {
   EXPECT_EQ(block1, block3);
 }
 
+// Clone() writes all keys and values into a single block of storage.
+TEST(Http2HeaderBlockTest, CloneIntoSingleBlock) {
+  Http2HeaderBlock block;
+  block["foo"] = std::string(3000, 'x');
+  block["bar"] = std::string(3000, 'y');
+  block.AppendValueOrAddHeader("bar", "z");
+
+  Http2HeaderBlock copy = block.Clone();
+  EXPECT_EQ(block, copy);
+  EXPECT_EQ(block.TotalBytesUsed(), copy.TotalBytesUsed());
+  EXPECT_EQ(copy.TotalBytesUsed(),
+            Http2HeaderBlockPeer::bytes_allocated(copy));
+
+  EXPECT_EQ(0u, Http2HeaderBlockPeer::bytes_allocated(
+                    Http2HeaderBlock().Clone()));
+}
+
 TEST(Http2HeaderBlockTest, Equality) {
   // Test equality and inequality operators.
   Http2HeaderBlock block1;
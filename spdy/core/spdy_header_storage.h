@@ -2,6 +2,7 @@
 #define QUICHE_SPDY_CORE_SPDY_HEADER_STORAGE_H_
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "common/platform/api/quiche_export.h"
 #include "spdy/core/spdy_simple_arena.h"
 
@@ -34,11 +35,15 @@ class QUICHE_EXPORT_PRIVATE SpdyHeaderStorage {
 
   void Clear() { arena_.Reset(); }
 
+  // Makes sure that the next |size| bytes written are stored in a single block
+  // of memory.
+  void Reserve(size_t size) { arena_.Reserve(size); }
+
   // Given a list of fragments and a separator, writes the fragments joined by
   // the separator to a contiguous region of memory. Returns a absl::string_view
   // pointing to the region of memory.
   absl::string_view WriteFragments(
-      const std::vector<absl::string_view>& fragments,
+      absl::Span<const absl::string_view> fragments,
       absl::string_view separator);
 
   size_t bytes_allocated() const { return arena_.status().bytes_allocated(); }
@@ -49,10 +54,9 @@ class QUICHE_EXPORT_PRIVATE SpdyHeaderStorage {
 
 // Writes |fragments| to |dst|, joined by |separator|. |dst| must be large
 // enough to hold the result. Returns the number of bytes written.
-QUICHE_EXPORT_PRIVATE size_t
-Join(char* dst,
-     const std::vector<absl::string_view>& fragments,
-     absl::string_view separator);
+QUICHE_EXPORT_PRIVATE size_t Join(char* dst,
+                                  absl::Span<const absl::string_view> fragments,
+                                  absl::string_view separator);
 
 }  // namespace spdy
 
@@ -49,6 +49,10 @@ class QUICHE_EXPORT_PRIVATE SpdySimpleArena {
 
   void Reset();
 
+  // Makes sure that the next |additional_space| bytes of allocations are
+  // served from a single block.
+  void Reserve(size_t additional_space);
+
   Status status() const { return status_; }
 
  private:
@@ -64,7 +68,6 @@ class QUICHE_EXPORT_PRIVATE SpdySimpleArena {
     Block& operator=(Block&& other);
   };
 
-  void Reserve(size_t additional_space);
   void AllocBlock(size_t size);
 
   size_t block_size_;